@@ -12,6 +12,7 @@
 #include <netinet/in.h>
 #include <poll.h>
 #include <pthread.h>
+#include <sched.h>
 #include "td_atomic.h"
 #include <inttypes.h>
 #include <stdarg.h>
@@ -21,6 +22,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
 #include <time.h>
@@ -34,6 +36,38 @@
 #define TD_REALTEK_RX_BUFFER_SIZE 2048
 #endif
 
+#ifndef TD_REALTEK_RX_BATCH_MAX
+#define TD_REALTEK_RX_BATCH_MAX 64U
+#endif
+
+#ifndef TD_REALTEK_RX_MMSG_DEFAULT_BATCH
+#define TD_REALTEK_RX_MMSG_DEFAULT_BATCH 32U
+#endif
+
+#ifndef TD_REALTEK_RX_MMSG_MAX_BATCH
+#define TD_REALTEK_RX_MMSG_MAX_BATCH 256U
+#endif
+
+#ifndef TD_REALTEK_RX_RING_BLOCK_SIZE
+#define TD_REALTEK_RX_RING_BLOCK_SIZE (1U << 16)
+#endif
+
+#ifndef TD_REALTEK_RX_RING_DEFAULT_SIZE
+#define TD_REALTEK_RX_RING_DEFAULT_SIZE (1U << 20)
+#endif
+
+#ifndef TD_REALTEK_RX_RING_MIN_BLOCKS
+#define TD_REALTEK_RX_RING_MIN_BLOCKS 4U
+#endif
+
+#ifndef TD_REALTEK_RX_MAX_WORKERS
+#define TD_REALTEK_RX_MAX_WORKERS 16U
+#endif
+
+#ifndef TD_REALTEK_RX_RING_BLOCK_TIMEOUT_MS
+#define TD_REALTEK_RX_RING_BLOCK_TIMEOUT_MS 10U
+#endif
+
 #ifndef TD_REALTEK_DEFAULT_TX_INTERVAL_MS
 #define TD_REALTEK_DEFAULT_TX_INTERVAL_MS 100U
 #endif
@@ -42,24 +76,49 @@
 #define TD_REALTEK_MAC_CACHE_TTL_MS 30000U
 #endif
 
-#ifndef TD_REALTEK_MAC_BUCKET_COUNT
-#define TD_REALTEK_MAC_BUCKET_COUNT 256U
+#ifndef TD_REALTEK_TX_TEMPLATE_SLOTS
+#define TD_REALTEK_TX_TEMPLATE_SLOTS 128U /* power of two */
+#endif
+
+#ifndef TD_REALTEK_TX_TEMPLATE_TTL_MS
+#define TD_REALTEK_TX_TEMPLATE_TTL_MS 30000U
 #endif
 
-struct mac_bucket_entry {
-    uint8_t mac[ETH_ALEN];
-    uint16_t vlan;
-    uint32_t ifindex;
-    struct mac_bucket_entry *next;
+#ifndef TD_REALTEK_TX_BATCH_MAX
+#define TD_REALTEK_TX_BATCH_MAX 32U
+#endif
+
+/* Index slot over a table's entries array: the full key hash filters probes
+ * before the entry itself is touched; pos is the entry offset + 1, 0 = empty. */
+struct mac_index_slot {
+    uint32_t hash;
+    uint32_t pos;
 };
 
-struct realtek_mac_cache {
-    pthread_rwlock_t map_lock;
-    struct mac_bucket_entry *buckets[TD_REALTEK_MAC_BUCKET_COUNT];
+/* One generation of the MAC cache. Immutable once published; the refresher
+ * only rewrites the table that is not current, and only after a grace period
+ * has let every reader of it finish. */
+struct realtek_mac_table {
+    uint64_t version;
+    struct timespec refreshed_at;
     SwUcMacEntry *entries;
+    uint32_t count;
+    struct mac_index_slot *index; /* open addressing, at most half full */
+    uint32_t index_mask;
+};
+
+/* Readers pin one of two epoch slots, load current and unpin when done; they
+ * never take a lock. The refresher snapshots into the spare table, publishes
+ * it with an atomic pointer store and then drains both epoch slots before the
+ * retired table may be rebuilt. */
+struct realtek_mac_cache {
+    struct realtek_mac_table tables[2];
+    struct realtek_mac_table *current; /* atomic; NULL until the first refresh */
+    unsigned int epoch;                /* atomic */
+    unsigned int readers[2];           /* atomic */
+    pthread_mutex_t refresh_lock;      /* serialises refreshes and table rebuilds */
     uint32_t capacity;
-    uint64_t version;
-    struct timespec last_refresh;
+    uint64_t version;                  /* last published version, under refresh_lock */
     uint32_t ttl_ms;
     pthread_mutex_t worker_lock;
     pthread_cond_t worker_cond;
@@ -69,13 +128,91 @@ struct realtek_mac_cache {
     bool refresh_requested;
     td_adapter_mac_locator_refresh_cb refresh_cb;
     void *refresh_ctx;
+    td_adapter_mac_locator_delta_cb delta_cb;
+    void *delta_ctx;
+    pthread_mutex_t notify_lock;        /* orders subscriber callbacks, guards deltas */
+    struct td_adapter_mac_delta *deltas;
+    uint32_t delta_capacity;
+};
+
+/* TPACKET_V3 receive ring; map == NULL means the recvmsg path is in use. */
+struct realtek_rx_ring {
+    uint8_t *map;
+    size_t map_len;
+    unsigned int block_size;
+    unsigned int block_count;
+    unsigned int next_block;
+};
+
+/* One RX socket (a PACKET_FANOUT member when fan-out is on) plus the thread draining it. */
+struct realtek_rx_worker {
+    struct td_adapter *adapter;
+    unsigned int index;
+    int fd;
+    int cpu; /* -1 when the thread is not pinned */
+    struct realtek_rx_ring ring;
+    pthread_t thread;
+    bool thread_started;
+};
+
+/* Per-wakeup delivery state owned by the RX thread; batch callback wins when both are set. */
+struct realtek_rx_delivery {
+    struct td_adapter_packet_subscription single;
+    struct td_adapter_packet_batch_subscription batch;
+    struct td_adapter_packet_view views[TD_REALTEK_RX_BATCH_MAX];
+    size_t count;
+};
+
+/* Preallocated recvmmsg() vectors: one RX buffer and one auxdata cmsg slot per frame. */
+struct realtek_rx_mmsg_buffers {
+    unsigned int count;
+    uint8_t *frames;
+    uint8_t *control;
+    struct iovec *iov;
+    struct mmsghdr *msgs;
 };
 
+#define TD_REALTEK_RX_CONTROL_SIZE CMSG_SPACE(sizeof(struct tpacket_auxdata))
+
 struct vlan_header {
     uint16_t tci;
     uint16_t encapsulated_proto;
 } __attribute__((packed));
 
+#define TD_REALTEK_ARP_FRAME_MAX (sizeof(struct ethhdr) + sizeof(struct vlan_header) + sizeof(struct ether_arp))
+
+/* Prebuilt ARP request for one (interface, VLAN). Headers, sender MAC and the
+ * interface IPv4 are filled in once; a probe copies the frame and patches the
+ * target plus any explicit sender. Override interfaces are re-resolved after
+ * TD_REALTEK_TX_TEMPLATE_TTL_MS, the default one follows the adapter fields. */
+struct tx_frame_template {
+    bool valid;
+    bool override;
+    int vlan_id; /* normalized, -1 untagged */
+    char iface[IFNAMSIZ];
+    int kernel_ifindex;
+    struct in_addr iface_ip;
+    struct timespec resolved_at;
+    size_t arp_offset;
+    size_t frame_len;
+    uint8_t frame[TD_REALTEK_ARP_FRAME_MAX];
+};
+
+/* One patched frame waiting for sendto/sendmmsg. The template it came from
+ * is named by cache index plus (iface, override, vlan_id) key, since a later
+ * request in the same batch may rebuild that cache slot for another key. */
+struct tx_batch_slot {
+    uint8_t frame[TD_REALTEK_ARP_FRAME_MAX];
+    size_t frame_len;
+    struct sockaddr_ll addr;
+    struct iovec iov;
+    char iface[IFNAMSIZ];
+    int vlan_id;
+    bool tmpl_override;
+    size_t tmpl_index;
+    size_t request_index;
+};
+
 struct td_adapter {
     struct td_adapter_config cfg;
     struct td_adapter_env env;
@@ -83,23 +220,29 @@ struct td_adapter {
     char tx_iface[IFNAMSIZ];
 
     atomic_bool running;
-    int rx_fd;
+    struct realtek_rx_worker rx_workers[TD_REALTEK_RX_MAX_WORKERS];
+    unsigned int rx_worker_count;
     int tx_fd;
     int rx_kernel_ifindex;
     int tx_kernel_ifindex;
-    pthread_t rx_thread;
-    bool rx_thread_started;
 
     struct td_adapter_packet_subscription packet_sub;
+    struct td_adapter_packet_batch_subscription packet_batch_sub;
     bool packet_subscribed;
+    struct td_adapter_rx_stats rx_stats; /* guarded by state_lock */
 
     pthread_mutex_t state_lock;
     pthread_mutex_t send_lock;
-    struct timespec last_send;
 
     uint8_t tx_mac[ETH_ALEN];
     struct in_addr tx_ipv4;
 
+    /* Transmit state below is guarded by send_lock. */
+    struct tx_frame_template tx_templates[TD_REALTEK_TX_TEMPLATE_SLOTS];
+    char tx_bound_iface[IFNAMSIZ]; /* last SO_BINDTODEVICE target, "" if unknown */
+    struct tx_batch_slot tx_slots[TD_REALTEK_TX_BATCH_MAX];
+    struct mmsghdr tx_msgs[TD_REALTEK_TX_BATCH_MAX];
+
     struct realtek_mac_cache mac_cache;
 };
 
@@ -139,8 +282,9 @@ static void mac_cache_init(struct realtek_mac_cache *cache) {
     }
     memset(cache, 0, sizeof(*cache));
     cache->ttl_ms = TD_REALTEK_MAC_CACHE_TTL_MS;
-    pthread_rwlock_init(&cache->map_lock, NULL);
+    pthread_mutex_init(&cache->refresh_lock, NULL);
     pthread_mutex_init(&cache->worker_lock, NULL);
+    pthread_mutex_init(&cache->notify_lock, NULL);
     pthread_condattr_t attr;
     pthread_condattr_init(&attr);
     pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
@@ -236,7 +380,99 @@ static int attach_arp_filter(int fd) {
     return 0;
 }
 
-static int configure_rx_socket(struct td_adapter *adapter) {
+static bool rx_ring_setup(struct realtek_rx_worker *worker) {
+    struct td_adapter *adapter = worker->adapter;
+    int fd = worker->fd;
+    int version = TPACKET_V3;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+        realtek_logf(adapter, TD_LOG_WARN, "setsockopt(PACKET_VERSION,V3) failed: %s", strerror(errno));
+        return false;
+    }
+
+    unsigned int block_size = TD_REALTEK_RX_RING_BLOCK_SIZE;
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size > 0 && block_size % (unsigned int)page_size != 0U) {
+        block_size = (block_size / (unsigned int)page_size + 1U) * (unsigned int)page_size;
+    }
+
+    unsigned int ring_bytes = adapter->cfg.rx_ring_size > 0 ? adapter->cfg.rx_ring_size
+                                                            : TD_REALTEK_RX_RING_DEFAULT_SIZE;
+    unsigned int block_count = ring_bytes / block_size;
+    if (block_count < TD_REALTEK_RX_RING_MIN_BLOCKS) {
+        block_count = TD_REALTEK_RX_RING_MIN_BLOCKS;
+    }
+
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = block_size;
+    req.tp_block_nr = block_count;
+    req.tp_frame_size = TD_REALTEK_RX_BUFFER_SIZE;
+    req.tp_frame_nr = (block_size / TD_REALTEK_RX_BUFFER_SIZE) * block_count;
+    req.tp_retire_blk_tov = TD_REALTEK_RX_RING_BLOCK_TIMEOUT_MS;
+
+    if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+        realtek_logf(adapter, TD_LOG_WARN, "setsockopt(PACKET_RX_RING) failed: %s", strerror(errno));
+        version = TPACKET_V1;
+        (void)setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version));
+        return false;
+    }
+
+    size_t map_len = (size_t)block_size * block_count;
+    void *map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        realtek_logf(adapter, TD_LOG_WARN, "mmap(PACKET_RX_RING) failed: %s", strerror(errno));
+        memset(&req, 0, sizeof(req));
+        (void)setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+        version = TPACKET_V1;
+        (void)setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version));
+        return false;
+    }
+
+    worker->ring.map = map;
+    worker->ring.map_len = map_len;
+    worker->ring.block_size = block_size;
+    worker->ring.block_count = block_count;
+    worker->ring.next_block = 0U;
+
+    realtek_logf(adapter, TD_LOG_INFO, "RX ring enabled on %s: blocks=%u block_size=%u",
+                 adapter->rx_iface,
+                 block_count,
+                 block_size);
+    return true;
+}
+
+static void close_rx_socket(struct realtek_rx_worker *worker) {
+    struct td_adapter *adapter = worker->adapter;
+    if (worker->ring.map) {
+        struct tpacket_stats_v3 stats;
+        socklen_t len = sizeof(stats);
+        memset(&stats, 0, sizeof(stats));
+        if (worker->fd >= 0 &&
+            getsockopt(worker->fd, SOL_PACKET, PACKET_STATISTICS, &stats, &len) == 0) {
+            realtek_logf(adapter, TD_LOG_INFO, "RX ring stats (worker %u): packets=%u drops=%u freeze=%u",
+                         worker->index,
+                         stats.tp_packets,
+                         stats.tp_drops,
+                         stats.tp_freeze_q_cnt);
+        }
+        munmap(worker->ring.map, worker->ring.map_len);
+        memset(&worker->ring, 0, sizeof(worker->ring));
+    }
+
+    if (worker->fd >= 0) {
+        close(worker->fd);
+        worker->fd = -1;
+    }
+}
+
+static void close_rx_sockets(struct td_adapter *adapter) {
+    for (unsigned int i = 0; i < adapter->rx_worker_count; ++i) {
+        close_rx_socket(&adapter->rx_workers[i]);
+    }
+    adapter->rx_worker_count = 0;
+}
+
+static int configure_rx_socket(struct td_adapter *adapter, struct realtek_rx_worker *worker) {
     int fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
     if (fd < 0) {
         realtek_logf(adapter, TD_LOG_ERROR, "socket(AF_PACKET) failed: %s", strerror(errno));
@@ -279,7 +515,17 @@ static int configure_rx_socket(struct td_adapter *adapter) {
         return -1;
     }
 
-    if (adapter->cfg.rx_ring_size > 0) {
+    worker->fd = fd;
+
+    bool ring_ready = false;
+    if (adapter->cfg.rx_mode == TD_ADAPTER_RX_MODE_MMAP) {
+        ring_ready = rx_ring_setup(worker);
+        if (!ring_ready) {
+            realtek_logf(adapter, TD_LOG_WARN, "RX ring unavailable on %s, falling back to recvmsg", adapter->rx_iface);
+        }
+    }
+
+    if (!ring_ready && adapter->cfg.rx_ring_size > 0) {
         int rcvbuf = (int)adapter->cfg.rx_ring_size;
         if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) < 0) {
             realtek_logf(adapter, TD_LOG_WARN, "setsockopt(SO_RCVBUF) failed: %s", strerror(errno));
@@ -289,6 +535,154 @@ static int configure_rx_socket(struct td_adapter *adapter) {
     return fd;
 }
 
+/* Parses a "0,2-3" style CPU list; returns false on malformed input. */
+static bool parse_cpu_list(const char *text, int *cpus, unsigned int max, unsigned int *count_out) {
+    unsigned int count = 0;
+    const char *cursor = text;
+
+    while (*cursor) {
+        char *end = NULL;
+        errno = 0;
+        unsigned long first = strtoul(cursor, &end, 10);
+        if (errno != 0 || end == cursor || first >= CPU_SETSIZE) {
+            return false;
+        }
+        unsigned long last = first;
+        cursor = end;
+        if (*cursor == '-') {
+            ++cursor;
+            errno = 0;
+            last = strtoul(cursor, &end, 10);
+            if (errno != 0 || end == cursor || last >= CPU_SETSIZE || last < first) {
+                return false;
+            }
+            cursor = end;
+        }
+        for (unsigned long cpu = first; cpu <= last && count < max; ++cpu) {
+            cpus[count++] = (int)cpu;
+        }
+        if (*cursor == ',') {
+            ++cursor;
+        } else if (*cursor != '\0') {
+            return false;
+        }
+    }
+
+    *count_out = count;
+    return count > 0;
+}
+
+#ifdef PACKET_FANOUT_CBPF
+/* Fan-out selector: the low four bytes of the ARP sender MAC, so every frame
+ * from one terminal lands on the same worker. The kernel takes the result
+ * modulo the group size; VLAN tags are already stripped into auxdata here. */
+static int attach_fanout_program(int fd) {
+    struct sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t)(SKF_NET_OFF + 10)},
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+
+    struct sock_fprog program = {
+        .len = (unsigned short)(sizeof(code) / sizeof(code[0])),
+        .filter = code,
+    };
+
+    return setsockopt(fd, SOL_PACKET, PACKET_FANOUT_DATA, &program, sizeof(program));
+}
+#endif
+
+static bool join_rx_fanout(struct realtek_rx_worker *worker, int *fanout_type) {
+    struct td_adapter *adapter = worker->adapter;
+    int group = (int)((unsigned int)getpid() & 0xFFFFU);
+
+#ifdef PACKET_FANOUT_CBPF
+    if (*fanout_type == PACKET_FANOUT_CBPF) {
+        int arg = group | (PACKET_FANOUT_CBPF << 16);
+        if (setsockopt(worker->fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)) == 0) {
+            if (worker->index > 0U || attach_fanout_program(worker->fd) == 0) {
+                return true;
+            }
+            realtek_logf(adapter, TD_LOG_WARN, "setsockopt(PACKET_FANOUT_DATA) failed: %s", strerror(errno));
+            return false;
+        }
+        if (worker->index > 0U) {
+            realtek_logf(adapter, TD_LOG_WARN, "setsockopt(PACKET_FANOUT) failed: %s", strerror(errno));
+            return false;
+        }
+        realtek_logf(adapter, TD_LOG_WARN, "PACKET_FANOUT_CBPF unavailable (%s), falling back to PACKET_FANOUT_HASH",
+                     strerror(errno));
+        *fanout_type = PACKET_FANOUT_HASH;
+    }
+#endif
+
+    int arg = group | (*fanout_type << 16);
+    if (setsockopt(worker->fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)) < 0) {
+        realtek_logf(adapter, TD_LOG_WARN, "setsockopt(PACKET_FANOUT) failed: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool configure_rx_sockets(struct td_adapter *adapter) {
+    unsigned int wanted = adapter->cfg.rx_fanout > 1U ? adapter->cfg.rx_fanout : 1U;
+    if (wanted > TD_REALTEK_RX_MAX_WORKERS) {
+        realtek_logf(adapter, TD_LOG_WARN, "rx fan-out %u exceeds limit, clamping to %u", wanted, TD_REALTEK_RX_MAX_WORKERS);
+        wanted = TD_REALTEK_RX_MAX_WORKERS;
+    }
+
+    int cpus[TD_REALTEK_RX_MAX_WORKERS];
+    unsigned int cpu_count = 0;
+    if (adapter->cfg.rx_cpu_list && adapter->cfg.rx_cpu_list[0] &&
+        !parse_cpu_list(adapter->cfg.rx_cpu_list, cpus, TD_REALTEK_RX_MAX_WORKERS, &cpu_count)) {
+        realtek_logf(adapter, TD_LOG_WARN, "ignoring invalid RX CPU list '%s'", adapter->cfg.rx_cpu_list);
+        cpu_count = 0;
+    }
+
+#ifdef PACKET_FANOUT_CBPF
+    int fanout_type = PACKET_FANOUT_CBPF;
+#else
+    int fanout_type = PACKET_FANOUT_HASH;
+#endif
+
+    adapter->rx_worker_count = 0;
+    for (unsigned int i = 0; i < wanted; ++i) {
+        struct realtek_rx_worker *worker = &adapter->rx_workers[i];
+        memset(worker, 0, sizeof(*worker));
+        worker->adapter = adapter;
+        worker->index = i;
+        worker->fd = -1;
+        worker->cpu = cpu_count > 0 ? cpus[i % cpu_count] : -1;
+
+        if (configure_rx_socket(adapter, worker) < 0) {
+            if (i == 0) {
+                return false;
+            }
+            realtek_logf(adapter, TD_LOG_WARN, "RX fan-out on %s limited to %u sockets", adapter->rx_iface, i);
+            break;
+        }
+        adapter->rx_worker_count = i + 1U;
+
+        if (wanted > 1U && !join_rx_fanout(worker, &fanout_type)) {
+            if (i == 0) {
+                realtek_logf(adapter, TD_LOG_WARN, "RX fan-out unavailable on %s, using a single socket", adapter->rx_iface);
+            } else {
+                close_rx_socket(worker);
+                adapter->rx_worker_count = i;
+                realtek_logf(adapter, TD_LOG_WARN, "RX fan-out on %s limited to %u sockets", adapter->rx_iface, i);
+            }
+            break;
+        }
+    }
+
+    if (adapter->rx_worker_count > 1U) {
+        realtek_logf(adapter, TD_LOG_INFO, "RX fan-out enabled on %s: sockets=%u mode=%s",
+                     adapter->rx_iface,
+                     adapter->rx_worker_count,
+                     fanout_type == PACKET_FANOUT_HASH ? "hash" : "sender-mac");
+    }
+    return true;
+}
+
 static int configure_tx_socket(struct td_adapter *adapter) {
     int fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ARP));
     if (fd < 0) {
@@ -394,9 +788,161 @@ static void bind_socket_to_iface(struct td_adapter *adapter, const char *iface)
         return;
     }
 
+    if (strcmp(adapter->tx_bound_iface, iface) == 0) {
+        return;
+    }
+
     size_t len = strlen(iface) + 1;
     if (setsockopt(adapter->tx_fd, SOL_SOCKET, SO_BINDTODEVICE, iface, len) < 0) {
+        adapter->tx_bound_iface[0] = '\0';
         realtek_logf(adapter, TD_LOG_WARN, "SO_BINDTODEVICE(%s) failed: %s", iface, strerror(errno));
+        return;
+    }
+    snprintf(adapter->tx_bound_iface, sizeof(adapter->tx_bound_iface), "%s", iface);
+}
+
+static size_t tx_template_slot(const char *iface, int vlan_id) {
+    uint32_t hash = 2166136261U;
+    for (const char *p = iface; *p; ++p) {
+        hash ^= (uint8_t)*p;
+        hash *= 16777619U;
+    }
+    hash ^= (uint32_t)vlan_id;
+    hash *= 16777619U;
+    return (size_t)(hash ^ (hash >> 16)) & (TD_REALTEK_TX_TEMPLATE_SLOTS - 1U);
+}
+
+/* Returns the template for (iface, vlan_id), building it on a miss or once an
+ * override interface's details are older than the TTL. A slot holds a single
+ * key, so a colliding key simply rebuilds it. Caller holds send_lock. */
+static struct tx_frame_template *tx_template_get_locked(struct td_adapter *adapter,
+                                                        const char *iface,
+                                                        bool override,
+                                                        int vlan_id,
+                                                        const struct timespec *now) {
+    struct tx_frame_template *tmpl = &adapter->tx_templates[tx_template_slot(iface, vlan_id)];
+    if (tmpl->valid && tmpl->override == override && tmpl->vlan_id == vlan_id &&
+        strcmp(tmpl->iface, iface) == 0 &&
+        (!override || timespec_diff_ms(&tmpl->resolved_at, now) < TD_REALTEK_TX_TEMPLATE_TTL_MS)) {
+        return tmpl;
+    }
+
+    int kernel_ifindex = adapter->tx_kernel_ifindex;
+    uint8_t iface_mac[ETH_ALEN];
+    struct in_addr iface_ip = adapter->tx_ipv4;
+    memcpy(iface_mac, adapter->tx_mac, ETH_ALEN);
+    if (override && !query_iface_details(iface, &kernel_ifindex, iface_mac, &iface_ip)) {
+        tmpl->valid = false;
+        return NULL;
+    }
+
+    memset(tmpl, 0, sizeof(*tmpl));
+    struct ethhdr *eth = (struct ethhdr *)tmpl->frame;
+    memcpy(eth->h_source, iface_mac, ETH_ALEN);
+
+    size_t offset = sizeof(struct ethhdr);
+    if (vlan_id > 0) {
+        eth->h_proto = htons(ETH_P_8021Q);
+        struct vlan_header *vlan = (struct vlan_header *)(tmpl->frame + sizeof(struct ethhdr));
+        vlan->tci = htons((uint16_t)(vlan_id & 0x0FFF));
+        vlan->encapsulated_proto = htons(ETH_P_ARP);
+        offset += sizeof(struct vlan_header);
+    } else {
+        eth->h_proto = htons(ETH_P_ARP);
+    }
+
+    struct ether_arp *arp = (struct ether_arp *)(tmpl->frame + offset);
+    arp->ea_hdr.ar_hrd = htons(ARPHRD_ETHER);
+    arp->ea_hdr.ar_pro = htons(ETH_P_IP);
+    arp->ea_hdr.ar_hln = ETH_ALEN;
+    arp->ea_hdr.ar_pln = 4;
+    arp->ea_hdr.ar_op = htons(ARPOP_REQUEST);
+    memcpy(arp->arp_sha, iface_mac, ETH_ALEN);
+    memcpy(arp->arp_spa, &iface_ip.s_addr, sizeof(arp->arp_spa));
+
+    snprintf(tmpl->iface, sizeof(tmpl->iface), "%s", iface);
+    tmpl->override = override;
+    tmpl->vlan_id = vlan_id;
+    tmpl->kernel_ifindex = kernel_ifindex;
+    tmpl->iface_ip = iface_ip;
+    tmpl->resolved_at = *now;
+    tmpl->arp_offset = offset;
+    tmpl->frame_len = offset + sizeof(struct ether_arp);
+    tmpl->valid = true;
+    return tmpl;
+}
+
+/* Copies the matching template into slot and patches in the request's target
+ * and sender. Caller holds send_lock. */
+static td_adapter_result_t tx_prepare_frame_locked(struct td_adapter *adapter,
+                                                   const struct td_adapter_arp_request *req,
+                                                   const struct timespec *now,
+                                                   struct tx_batch_slot *slot) {
+    bool override = req->tx_iface_valid && req->tx_iface[0];
+    const char *tx_iface = override ? req->tx_iface : adapter->tx_iface;
+    if (!tx_iface[0]) {
+        realtek_logf(adapter, TD_LOG_ERROR, "no transmit interface configured for ARP send");
+        return TD_ADAPTER_ERR_INVALID_ARG;
+    }
+
+    int vlan_id = normalize_vlan_id(req->vlan_id);
+    struct tx_frame_template *tmpl = tx_template_get_locked(adapter, tx_iface, override, vlan_id, now);
+    if (!tmpl) {
+        realtek_logf(adapter, TD_LOG_ERROR, "failed to resolve interface %s for ARP send", tx_iface);
+        return TD_ADAPTER_ERR_INVALID_ARG;
+    }
+
+    struct in_addr sender_ip = req->sender_ip;
+    if (sender_ip.s_addr == 0) {
+        sender_ip = tmpl->iface_ip;
+    }
+    if (sender_ip.s_addr == 0) {
+        realtek_logf(adapter, TD_LOG_WARN, "interface %s has no IPv4, skipping ARP send", tx_iface);
+        return TD_ADAPTER_ERR_NOT_READY;
+    }
+
+    uint8_t target_mac[ETH_ALEN];
+    if (all_zero_mac(req->target_mac)) {
+        memset(target_mac, 0xFF, ETH_ALEN);
+    } else {
+        memcpy(target_mac, req->target_mac, ETH_ALEN);
+    }
+
+    memcpy(slot->frame, tmpl->frame, tmpl->frame_len);
+    struct ethhdr *eth = (struct ethhdr *)slot->frame;
+    struct ether_arp *arp = (struct ether_arp *)(slot->frame + tmpl->arp_offset);
+    memcpy(eth->h_dest, target_mac, ETH_ALEN);
+    if (!all_zero_mac(req->sender_mac)) {
+        memcpy(eth->h_source, req->sender_mac, ETH_ALEN);
+        memcpy(arp->arp_sha, req->sender_mac, ETH_ALEN);
+    }
+    memcpy(arp->arp_spa, &sender_ip.s_addr, sizeof(arp->arp_spa));
+    memcpy(arp->arp_tha, target_mac, ETH_ALEN);
+    memcpy(arp->arp_tpa, &req->target_ip.s_addr, sizeof(arp->arp_tpa));
+    slot->frame_len = tmpl->frame_len;
+
+    memset(&slot->addr, 0, sizeof(slot->addr));
+    slot->addr.sll_family = AF_PACKET;
+    slot->addr.sll_protocol = htons(vlan_id > 0 ? ETH_P_8021Q : ETH_P_ARP);
+    slot->addr.sll_ifindex = tmpl->kernel_ifindex;
+    slot->addr.sll_halen = ETH_ALEN;
+    memcpy(slot->addr.sll_addr, target_mac, ETH_ALEN);
+
+    snprintf(slot->iface, sizeof(slot->iface), "%s", tmpl->iface);
+    slot->vlan_id = vlan_id;
+    slot->tmpl_override = override;
+    slot->tmpl_index = (size_t)(tmpl - adapter->tx_templates);
+    return TD_ADAPTER_OK;
+}
+
+/* Drops the template a failed frame was built from, but only while its cache
+ * slot still holds that key. Caller holds send_lock. */
+static void tx_template_invalidate_locked(struct td_adapter *adapter,
+                                          const struct tx_batch_slot *slot) {
+    struct tx_frame_template *tmpl = &adapter->tx_templates[slot->tmpl_index];
+    if (tmpl->valid && tmpl->override == slot->tmpl_override && tmpl->vlan_id == slot->vlan_id &&
+        strcmp(tmpl->iface, slot->iface) == 0) {
+        tmpl->valid = false;
     }
 }
 
@@ -408,21 +954,87 @@ static uint32_t mac_hash(const uint8_t mac[ETH_ALEN], uint16_t vlan) {
     }
     hash ^= (uint64_t)vlan & 0x0FFFU;
     hash *= 1099511628211ULL;
-    return (uint32_t)(hash % TD_REALTEK_MAC_BUCKET_COUNT);
+    return (uint32_t)(hash ^ (hash >> 32));
 }
 
-static void mac_cache_clear_buckets(struct realtek_mac_cache *cache) {
-    if (!cache) {
-        return;
+static bool mac_entry_matches(const SwUcMacEntry *entry, const uint8_t mac[ETH_ALEN], uint16_t vlan) {
+    return entry->vlan == vlan && memcmp(entry->mac, mac, ETH_ALEN) == 0;
+}
+
+/* Rebuilds the index over entries[0..count) in one pass. A key that appears
+ * twice in a snapshot resolves to its last occurrence. */
+static void mac_table_index(struct realtek_mac_table *table, uint32_t count) {
+    memset(table->index, 0, ((size_t)table->index_mask + 1U) * sizeof(*table->index));
+    for (uint32_t i = 0; i < count; ++i) {
+        const SwUcMacEntry *entry = &table->entries[i];
+        uint32_t hash = mac_hash(entry->mac, entry->vlan);
+        uint32_t slot = hash & table->index_mask;
+        while (table->index[slot].pos != 0U) {
+            const struct mac_index_slot *probe = &table->index[slot];
+            if (probe->hash == hash &&
+                mac_entry_matches(&table->entries[probe->pos - 1U], entry->mac, entry->vlan)) {
+                break;
+            }
+            slot = (slot + 1U) & table->index_mask;
+        }
+        table->index[slot].hash = hash;
+        table->index[slot].pos = i + 1U;
+    }
+    table->count = count;
+}
+
+static const SwUcMacEntry *mac_table_find(const struct realtek_mac_table *table,
+                                          const uint8_t mac[ETH_ALEN],
+                                          uint16_t vlan) {
+    uint32_t hash = mac_hash(mac, vlan);
+    uint32_t slot = hash & table->index_mask;
+    while (table->index[slot].pos != 0U) {
+        const struct mac_index_slot *probe = &table->index[slot];
+        if (probe->hash == hash) {
+            const SwUcMacEntry *entry = &table->entries[probe->pos - 1U];
+            if (mac_entry_matches(entry, mac, vlan)) {
+                return entry;
+            }
+        }
+        slot = (slot + 1U) & table->index_mask;
     }
-    for (size_t i = 0; i < TD_REALTEK_MAC_BUCKET_COUNT; ++i) {
-        struct mac_bucket_entry *node = cache->buckets[i];
-        while (node) {
-            struct mac_bucket_entry *next = node->next;
-            free(node);
-            node = next;
+    return NULL;
+}
+
+static void mac_table_release(struct realtek_mac_table *table) {
+    free(table->entries);
+    free(table->index);
+    table->entries = NULL;
+    table->index = NULL;
+    table->index_mask = 0U;
+    table->count = 0U;
+    table->version = 0ULL;
+}
+
+static unsigned int mac_cache_read_lock(struct realtek_mac_cache *cache) {
+    unsigned int slot = __atomic_load_n(&cache->epoch, __ATOMIC_SEQ_CST) & 1U;
+    __atomic_fetch_add(&cache->readers[slot], 1U, __ATOMIC_SEQ_CST);
+    return slot;
+}
+
+static void mac_cache_read_unlock(struct realtek_mac_cache *cache, unsigned int slot) {
+    __atomic_fetch_sub(&cache->readers[slot], 1U, __ATOMIC_RELEASE);
+}
+
+static const struct realtek_mac_table *mac_cache_current(struct realtek_mac_cache *cache) {
+    return __atomic_load_n(&cache->current, __ATOMIC_SEQ_CST);
+}
+
+/* Caller holds refresh_lock. Returns once no reader can still hold a table
+ * pointer loaded before the last publish: a reader pinned its slot before
+ * loading current, so flipping the epoch and draining each slot in turn
+ * covers readers on either side of the flip. */
+static void mac_cache_synchronize(struct realtek_mac_cache *cache) {
+    for (int phase = 0; phase < 2; ++phase) {
+        unsigned int slot = __atomic_fetch_xor(&cache->epoch, 1U, __ATOMIC_SEQ_CST) & 1U;
+        while (__atomic_load_n(&cache->readers[slot], __ATOMIC_ACQUIRE) != 0U) {
+            sched_yield();
         }
-        cache->buckets[i] = NULL;
     }
 }
 
@@ -434,23 +1046,27 @@ static void mac_cache_destroy(struct td_adapter *adapter) {
     struct realtek_mac_cache *cache = &adapter->mac_cache;
     mac_cache_stop_worker(adapter);
 
-    pthread_rwlock_wrlock(&cache->map_lock);
-    mac_cache_clear_buckets(cache);
-    SwUcMacEntry *entries = cache->entries;
-    cache->entries = NULL;
+    pthread_mutex_lock(&cache->refresh_lock);
+    __atomic_store_n(&cache->current, NULL, __ATOMIC_SEQ_CST);
+    mac_cache_synchronize(cache);
+    for (size_t i = 0; i < 2; ++i) {
+        mac_table_release(&cache->tables[i]);
+    }
+    free(cache->deltas);
+    cache->deltas = NULL;
+    cache->delta_capacity = 0;
     cache->capacity = 0;
     cache->version = 0ULL;
-    cache->last_refresh.tv_sec = 0;
-    cache->last_refresh.tv_nsec = 0;
-    pthread_rwlock_unlock(&cache->map_lock);
-
-    free(entries);
+    pthread_mutex_unlock(&cache->refresh_lock);
 
-    pthread_rwlock_destroy(&cache->map_lock);
+    pthread_mutex_destroy(&cache->refresh_lock);
     pthread_mutex_destroy(&cache->worker_lock);
+    pthread_mutex_destroy(&cache->notify_lock);
     pthread_cond_destroy(&cache->worker_cond);
     cache->refresh_cb = NULL;
     cache->refresh_ctx = NULL;
+    cache->delta_cb = NULL;
+    cache->delta_ctx = NULL;
 }
 
 static void mac_cache_request_refresh(struct td_adapter *adapter) {
@@ -464,17 +1080,19 @@ static void mac_cache_request_refresh(struct td_adapter *adapter) {
     pthread_mutex_unlock(&cache->worker_lock);
 }
 
-static bool mac_cache_should_refresh(struct realtek_mac_cache *cache, const struct timespec *now) {
+static bool mac_cache_should_refresh(const struct realtek_mac_cache *cache,
+                                     const struct realtek_mac_table *table,
+                                     const struct timespec *now) {
     if (!cache) {
         return false;
     }
-    if (cache->version == 0ULL) {
+    if (!table || table->version == 0ULL) {
         return true;
     }
     if (!now) {
         return false;
     }
-    uint64_t elapsed = timespec_diff_ms(&cache->last_refresh, now);
+    uint64_t elapsed = timespec_diff_ms(&table->refreshed_at, now);
     return elapsed >= cache->ttl_ms;
 }
 
@@ -486,7 +1104,7 @@ static bool mac_cache_ensure_capacity(struct td_adapter *adapter) {
     }
 
     struct realtek_mac_cache *cache = &adapter->mac_cache;
-    if (cache->capacity > 0 && cache->entries) {
+    if (cache->capacity > 0 && cache->tables[0].entries && cache->tables[1].entries) {
         return true;
     }
 
@@ -497,26 +1115,129 @@ static bool mac_cache_ensure_capacity(struct td_adapter *adapter) {
         return false;
     }
 
-    SwUcMacEntry *entries = calloc(capacity, sizeof(SwUcMacEntry));
-    if (!entries) {
-        realtek_logf(adapter, TD_LOG_ERROR, "failed to allocate MAC cache buffer for %u entries", capacity);
+    /* The index keeps at least two slots per entry so probe runs stay within
+     * a cache line or two. */
+    uint32_t index_size = 2U;
+    while (index_size < capacity * 2U && index_size <= UINT32_MAX / 2U) {
+        index_size <<= 1U;
+    }
+    if (capacity > index_size / 2U) {
+        realtek_logf(adapter, TD_LOG_ERROR, "MAC cache capacity %u too large to index", capacity);
         return false;
     }
 
-    cache->entries = entries;
+    /* Each table owns a snapshot buffer and an index so a refresh never
+     * writes into the arrays readers are looking at. */
+    /* A refresh that changes more than capacity keys falls back to a full
+     * resync, which is no more expensive for subscribers at that point. */
+    struct td_adapter_mac_delta *deltas = calloc(capacity, sizeof(*deltas));
+    if (!deltas) {
+        realtek_logf(adapter, TD_LOG_ERROR, "failed to allocate MAC delta buffer for %u entries", capacity);
+        return false;
+    }
+
+    struct realtek_mac_table fresh[2];
+    memset(fresh, 0, sizeof(fresh));
+    for (size_t i = 0; i < 2; ++i) {
+        fresh[i].entries = calloc(capacity, sizeof(SwUcMacEntry));
+        fresh[i].index = calloc(index_size, sizeof(struct mac_index_slot));
+        fresh[i].index_mask = index_size - 1U;
+        if (!fresh[i].entries || !fresh[i].index) {
+            mac_table_release(&fresh[0]);
+            mac_table_release(&fresh[1]);
+            free(deltas);
+            realtek_logf(adapter, TD_LOG_ERROR, "failed to allocate MAC cache buffer for %u entries", capacity);
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < 2; ++i) {
+        mac_table_release(&cache->tables[i]);
+        cache->tables[i] = fresh[i];
+    }
+    free(cache->deltas);
+    cache->deltas = deltas;
+    cache->delta_capacity = capacity;
     cache->capacity = capacity;
-    cache->version = 0ULL;
-    cache->last_refresh.tv_sec = 0;
-    cache->last_refresh.tv_nsec = 0;
     return true;
 }
 
-static bool mac_cache_refresh(struct td_adapter *adapter, bool force) {
-    if (!adapter) {
-        return false;
+/* Collects the port changes between two indexed snapshots into
+ * cache->deltas. Returns false when they do not fit. Caller holds
+ * notify_lock. */
+static bool mac_cache_diff(struct realtek_mac_cache *cache,
+                           const struct realtek_mac_table *prev,
+                           const struct realtek_mac_table *next,
+                           size_t *count_out) {
+    size_t count = 0;
+    for (uint32_t i = 0; i < next->count; ++i) {
+        const SwUcMacEntry *entry = &next->entries[i];
+        if (mac_table_find(next, entry->mac, entry->vlan) != entry) {
+            continue; /* shadowed by a later duplicate */
+        }
+        const SwUcMacEntry *before = mac_table_find(prev, entry->mac, entry->vlan);
+        uint32_t old_ifindex = before ? before->ifindex : 0U;
+        if (old_ifindex == entry->ifindex) {
+            continue;
+        }
+        if (count == cache->delta_capacity) {
+            return false;
+        }
+        struct td_adapter_mac_delta *delta = &cache->deltas[count++];
+        memcpy(delta->mac, entry->mac, ETH_ALEN);
+        delta->vlan_id = entry->vlan;
+        delta->old_ifindex = old_ifindex;
+        delta->new_ifindex = entry->ifindex;
     }
 
-    if (!mac_cache_ensure_capacity(adapter)) {
+    for (uint32_t i = 0; i < prev->count; ++i) {
+        const SwUcMacEntry *entry = &prev->entries[i];
+        if (entry->ifindex == 0U || mac_table_find(prev, entry->mac, entry->vlan) != entry ||
+            mac_table_find(next, entry->mac, entry->vlan)) {
+            continue;
+        }
+        if (count == cache->delta_capacity) {
+            return false;
+        }
+        struct td_adapter_mac_delta *delta = &cache->deltas[count++];
+        memcpy(delta->mac, entry->mac, ETH_ALEN);
+        delta->vlan_id = entry->vlan;
+        delta->old_ifindex = entry->ifindex;
+        delta->new_ifindex = 0U;
+    }
+
+    *count_out = count;
+    return true;
+}
+
+/* Reports a refresh outcome to the registered subscriber. Caller holds
+ * notify_lock so callbacks arrive in publish order and deltas stay intact. */
+static void mac_cache_notify(struct realtek_mac_cache *cache,
+                             uint64_t version,
+                             uint64_t base_version,
+                             size_t delta_count) {
+    pthread_mutex_lock(&cache->worker_lock);
+    td_adapter_mac_locator_refresh_cb refresh_cb = cache->refresh_cb;
+    void *refresh_ctx = cache->refresh_ctx;
+    td_adapter_mac_locator_delta_cb delta_cb = cache->delta_cb;
+    void *delta_ctx = cache->delta_ctx;
+    pthread_mutex_unlock(&cache->worker_lock);
+
+    if (delta_cb) {
+        struct td_adapter_mac_delta_batch batch = {
+            .version = version,
+            .base_version = base_version,
+            .deltas = delta_count ? cache->deltas : NULL,
+            .count = delta_count,
+        };
+        delta_cb(&batch, delta_ctx);
+    } else if (refresh_cb) {
+        refresh_cb(version, refresh_ctx);
+    }
+}
+
+static bool mac_cache_refresh(struct td_adapter *adapter, bool force) {
+    if (!adapter) {
         return false;
     }
 
@@ -524,25 +1245,31 @@ static bool mac_cache_refresh(struct td_adapter *adapter, bool force) {
     struct timespec start;
     clock_gettime(CLOCK_MONOTONIC, &start);
 
-    pthread_rwlock_wrlock(&cache->map_lock);
+    pthread_mutex_lock(&cache->refresh_lock);
+
+    if (!mac_cache_ensure_capacity(adapter)) {
+        pthread_mutex_unlock(&cache->refresh_lock);
+        return false;
+    }
 
-    if (!force && cache->version != 0ULL && !mac_cache_should_refresh(cache, &start)) {
-        pthread_rwlock_unlock(&cache->map_lock);
+    struct realtek_mac_table *current = __atomic_load_n(&cache->current, __ATOMIC_SEQ_CST);
+    if (!force && current && !mac_cache_should_refresh(cache, current, &start)) {
+        pthread_mutex_unlock(&cache->refresh_lock);
         return true;
     }
 
+    /* The spare table was retired by the previous refresh, which waited out
+     * its readers before returning, so it is ours to rewrite. */
+    struct realtek_mac_table *spare = (current == &cache->tables[0]) ? &cache->tables[1] : &cache->tables[0];
+
     uint32_t count = 0;
-    int rc = td_switch_mac_snapshot(cache->entries, &count);
+    int rc = td_switch_mac_snapshot(spare->entries, &count);
     if (rc != 0) {
-        pthread_rwlock_unlock(&cache->map_lock);
+        pthread_mutex_lock(&cache->notify_lock);
+        pthread_mutex_unlock(&cache->refresh_lock);
         realtek_logf(adapter, TD_LOG_WARN, "td_switch_mac_snapshot failed: %d", rc);
-        pthread_mutex_lock(&cache->worker_lock);
-        td_adapter_mac_locator_refresh_cb cb = cache->refresh_cb;
-        void *ctx = cache->refresh_ctx;
-        pthread_mutex_unlock(&cache->worker_lock);
-        if (cb) {
-            cb(0ULL, ctx);
-        }
+        mac_cache_notify(cache, 0ULL, 0ULL, 0U);
+        pthread_mutex_unlock(&cache->notify_lock);
         return false;
     }
 
@@ -552,41 +1279,35 @@ static bool mac_cache_refresh(struct td_adapter *adapter, bool force) {
         count = cache->capacity;
     }
 
-    mac_cache_clear_buckets(cache);
+    mac_table_index(spare, count);
+    uint32_t inserted = count;
 
-    uint32_t inserted = 0;
-    for (uint32_t i = 0; i < count; ++i) {
-        const SwUcMacEntry *entry = &cache->entries[i];
-        struct mac_bucket_entry *node = calloc(1, sizeof(*node));
-        if (!node) {
-            realtek_logf(adapter, TD_LOG_ERROR, "failed to allocate mac bucket entry");
-            continue;
-        }
-        memcpy(node->mac, entry->mac, ETH_ALEN);
-        node->vlan = entry->vlan;
-        node->ifindex = entry->ifindex;
-        uint32_t bucket = mac_hash(node->mac, node->vlan);
-        node->next = cache->buckets[bucket];
-        cache->buckets[bucket] = node;
-        inserted += 1U;
+    /* Taken before the diff and held through the callback: the next refresh
+     * may snapshot meanwhile but cannot overwrite deltas being delivered. */
+    pthread_mutex_lock(&cache->notify_lock);
+    uint64_t base_version = 0ULL;
+    size_t delta_count = 0;
+    if (current && mac_cache_diff(cache, current, spare, &delta_count)) {
+        base_version = current->version;
+    } else {
+        delta_count = 0;
     }
 
-    cache->version += 1ULL;
-
     struct timespec end;
     clock_gettime(CLOCK_MONOTONIC, &end);
-    cache->last_refresh = end;
+    spare->refreshed_at = end;
+    spare->version = cache->version + 1ULL;
+
+    /* Readers see the new version and the new table together. */
+    __atomic_store_n(&cache->current, spare, __ATOMIC_SEQ_CST);
+    cache->version = spare->version;
+    mac_cache_synchronize(cache);
 
     uint64_t elapsed_ms = timespec_diff_ms(&start, &end);
     uint64_t version = cache->version;
     bool truncated = inserted < snapshot_count;
 
-    pthread_rwlock_unlock(&cache->map_lock);
-
-    pthread_mutex_lock(&cache->worker_lock);
-    td_adapter_mac_locator_refresh_cb cb = cache->refresh_cb;
-    void *ctx = cache->refresh_ctx;
-    pthread_mutex_unlock(&cache->worker_lock);
+    pthread_mutex_unlock(&cache->refresh_lock);
 
     if (truncated) {
         realtek_logf(adapter, TD_LOG_WARN, "MAC cache truncated: inserted=%u snapshot=%u", inserted, snapshot_count);
@@ -597,9 +1318,8 @@ static bool mac_cache_refresh(struct td_adapter *adapter, bool force) {
                  inserted,
                  elapsed_ms);
 
-    if (cb) {
-        cb(version, ctx);
-    }
+    mac_cache_notify(cache, version, base_version, delta_count);
+    pthread_mutex_unlock(&cache->notify_lock);
 
     return true;
 }
@@ -616,10 +1336,9 @@ static void *mac_cache_worker_main(void *arg) {
         struct timespec now;
         clock_gettime(CLOCK_MONOTONIC, &now);
 
-        bool stale = false;
-        pthread_rwlock_rdlock(&cache->map_lock);
-        stale = mac_cache_should_refresh(cache, &now);
-        pthread_rwlock_unlock(&cache->map_lock);
+        unsigned int slot = mac_cache_read_lock(cache);
+        bool stale = mac_cache_should_refresh(cache, mac_cache_current(cache), &now);
+        mac_cache_read_unlock(cache, slot);
 
         bool should_refresh = cache->refresh_requested || stale;
         if (!should_refresh) {
@@ -639,15 +1358,206 @@ static void *mac_cache_worker_main(void *arg) {
     return NULL;
 }
 
-static void *rx_thread_main(void *arg) {
-    struct td_adapter *adapter = (struct td_adapter *)arg;
-    uint8_t buffer[TD_REALTEK_RX_BUFFER_SIZE];
+static bool rx_copy_subscription(struct td_adapter *adapter,
+                                 struct realtek_rx_delivery *delivery) {
+    memset(&delivery->single, 0, sizeof(delivery->single));
+    memset(&delivery->batch, 0, sizeof(delivery->batch));
+    delivery->count = 0;
+
+    pthread_mutex_lock(&adapter->state_lock);
+    if (adapter->packet_subscribed) {
+        delivery->single = adapter->packet_sub;
+        delivery->batch = adapter->packet_batch_sub;
+    }
+    pthread_mutex_unlock(&adapter->state_lock);
+    return delivery->single.callback || delivery->batch.callback;
+}
+
+static void rx_account_wakeup(struct td_adapter *adapter, uint32_t frames) {
+    if (frames == 0U) {
+        return;
+    }
+    pthread_mutex_lock(&adapter->state_lock);
+    adapter->rx_stats.wakeups += 1U;
+    adapter->rx_stats.frames += frames;
+    if (frames > adapter->rx_stats.max_frames_per_wakeup) {
+        adapter->rx_stats.max_frames_per_wakeup = frames;
+    }
+    pthread_mutex_unlock(&adapter->state_lock);
+}
+
+static int rx_auxdata_vlan(struct msghdr *msg) {
+    if (msg->msg_controllen < sizeof(struct cmsghdr)) {
+        return -1;
+    }
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_PACKET && cmsg->cmsg_type == PACKET_AUXDATA) {
+            const struct tpacket_auxdata *aux = (const struct tpacket_auxdata *)CMSG_DATA(cmsg);
+#ifdef TP_STATUS_VLAN_VALID
+            if (aux->tp_status & TP_STATUS_VLAN_VALID) {
+                return normalize_vlan_id((int)(aux->tp_vlan_tci & 0x0FFF));
+            }
+#else
+            if (aux->tp_vlan_tci != 0 || aux->tp_vlan_tpid != 0) {
+                return normalize_vlan_id((int)(aux->tp_vlan_tci & 0x0FFF));
+            }
+#endif
+        }
+    }
+    return -1;
+}
+
+static void rx_flush_batch(struct realtek_rx_delivery *delivery) {
+    if (delivery->count == 0) {
+        return;
+    }
+    delivery->batch.callback(delivery->views, delivery->count, delivery->batch.user_ctx);
+    delivery->count = 0;
+}
+
+static void rx_deliver_frame(struct realtek_rx_delivery *delivery,
+                             const uint8_t *frame,
+                             size_t frame_len,
+                             int vlan_id,
+                             const struct timespec *ts) {
+    if (frame_len < sizeof(struct ethhdr)) {
+        return;
+    }
+
+    struct ethhdr eth_local;
+    memcpy(&eth_local, frame, sizeof(eth_local));
+
+    uint16_t ether_type = ntohs(eth_local.h_proto);
+    size_t offset = sizeof(struct ethhdr);
+
+    if (ether_type == ETH_P_8021Q || ether_type == ETH_P_8021AD) {
+        if (frame_len < sizeof(struct ethhdr) + sizeof(struct vlan_header)) {
+            return;
+        }
+        struct vlan_header vlan_local;
+        memcpy(&vlan_local, frame + sizeof(struct ethhdr), sizeof(vlan_local));
+        vlan_id = normalize_vlan_id((int)(ntohs(vlan_local.tci) & 0x0FFF));
+        ether_type = ntohs(vlan_local.encapsulated_proto);
+        offset += sizeof(vlan_local);
+    }
+
+    vlan_id = normalize_vlan_id(vlan_id);
+
+    if (ether_type != ETH_P_ARP) {
+        return;
+    }
+
+    size_t payload_len = 0;
+    if (frame_len > offset) {
+        payload_len = frame_len - offset;
+    }
+
+    struct td_adapter_packet_view local_view;
+    struct td_adapter_packet_view *view = delivery->batch.callback ? &delivery->views[delivery->count] : &local_view;
+    memset(view, 0, sizeof(*view));
+    view->frame = frame;
+    view->frame_len = frame_len;
+    view->payload = frame + offset;
+    view->payload_len = payload_len;
+    view->ether_type = ether_type;
+    view->vlan_id = vlan_id;
+    view->ts = *ts;
+    view->ifindex = 0U;
+    memcpy(view->src_mac, eth_local.h_source, ETH_ALEN);
+    memcpy(view->dst_mac, eth_local.h_dest, ETH_ALEN);
+
+    if (!delivery->batch.callback) {
+        delivery->single.callback(view, delivery->single.user_ctx);
+        return;
+    }
+
+    delivery->count += 1;
+    if (delivery->count >= TD_REALTEK_RX_BATCH_MAX) {
+        rx_flush_batch(delivery);
+    }
+}
+
+/* Returns false when the RX loop should terminate. */
+static bool rx_wait_readable(struct realtek_rx_worker *worker) {
+    struct td_adapter *adapter = worker->adapter;
+    struct pollfd pfd = {
+        .fd = worker->fd,
+        .events = POLLIN,
+        .revents = 0,
+    };
+
+    int ready = poll(&pfd, 1, 1000);
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return true;
+        }
+        realtek_logf(adapter, TD_LOG_ERROR, "poll failed: %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+static void rx_ring_loop(struct realtek_rx_worker *worker) {
+    struct td_adapter *adapter = worker->adapter;
+    struct realtek_rx_ring *ring = &worker->ring;
+
+    while (atomic_load(&adapter->running)) {
+        struct tpacket_block_desc *block =
+            (struct tpacket_block_desc *)(ring->map + (size_t)ring->next_block * ring->block_size);
+
+        if (!(block->hdr.bh1.block_status & TP_STATUS_USER)) {
+            if (!rx_wait_readable(worker)) {
+                break;
+            }
+            continue;
+        }
+        __sync_synchronize();
+
+        struct realtek_rx_delivery delivery;
+        bool subscribed = rx_copy_subscription(adapter, &delivery);
+
+        uint32_t count = block->hdr.bh1.num_pkts;
+        const uint8_t *cursor = (const uint8_t *)block + block->hdr.bh1.offset_to_first_pkt;
+        for (uint32_t i = 0; i < count; ++i) {
+            const struct tpacket3_hdr *hdr = (const struct tpacket3_hdr *)cursor;
+            if (subscribed) {
+                int vlan_id = -1;
+#ifdef TP_STATUS_VLAN_VALID
+                if (hdr->tp_status & TP_STATUS_VLAN_VALID) {
+                    vlan_id = normalize_vlan_id((int)(hdr->hv1.tp_vlan_tci & 0x0FFF));
+                }
+#else
+                if (hdr->hv1.tp_vlan_tci != 0) {
+                    vlan_id = normalize_vlan_id((int)(hdr->hv1.tp_vlan_tci & 0x0FFF));
+                }
+#endif
+                struct timespec ts = {
+                    .tv_sec = (time_t)hdr->tp_sec,
+                    .tv_nsec = (long)hdr->tp_nsec,
+                };
+                rx_deliver_frame(&delivery, cursor + hdr->tp_mac, hdr->tp_snaplen, vlan_id, &ts);
+            }
+            cursor += hdr->tp_next_offset;
+        }
+        if (subscribed) {
+            rx_flush_batch(&delivery);
+        }
+        rx_account_wakeup(adapter, count);
+
+        __sync_synchronize();
+        block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+        ring->next_block = (ring->next_block + 1U) % ring->block_count;
+    }
+}
 
-    realtek_logf(adapter, TD_LOG_INFO, "RX thread started on %s", adapter->rx_iface);
+static void rx_recvmsg_loop(struct realtek_rx_worker *worker) {
+    struct td_adapter *adapter = worker->adapter;
+    uint8_t buffer[TD_REALTEK_RX_BUFFER_SIZE];
+    struct realtek_rx_delivery delivery;
 
     while (atomic_load(&adapter->running)) {
         struct pollfd pfd = {
-            .fd = adapter->rx_fd,
+            .fd = worker->fd,
             .events = POLLIN,
             .revents = 0,
         };
@@ -670,7 +1580,7 @@ static void *rx_thread_main(void *arg) {
         }
 
         struct sockaddr_ll addr;
-        uint8_t control[CMSG_SPACE(sizeof(struct tpacket_auxdata))];
+        uint8_t control[TD_REALTEK_RX_CONTROL_SIZE];
         struct iovec iov = {
             .iov_base = buffer,
             .iov_len = sizeof(buffer),
@@ -684,7 +1594,7 @@ static void *rx_thread_main(void *arg) {
         msg.msg_control = control;
         msg.msg_controllen = sizeof(control);
 
-        ssize_t received = recvmsg(adapter->rx_fd, &msg, 0);
+        ssize_t received = recvmsg(worker->fd, &msg, 0);
         if (received < 0) {
             if (errno == EINTR) {
                 continue;
@@ -696,104 +1606,199 @@ static void *rx_thread_main(void *arg) {
             continue;
         }
 
-        struct ethhdr eth_local;
-        memcpy(&eth_local, buffer, sizeof(eth_local));
+        rx_account_wakeup(adapter, 1U);
+        int vlan_id = rx_auxdata_vlan(&msg);
 
-        uint16_t ether_type = ntohs(eth_local.h_proto);
-        size_t offset = sizeof(struct ethhdr);
-        int vlan_id = -1;
+        if (!rx_copy_subscription(adapter, &delivery)) {
+            continue;
+        }
 
-        if (msg.msg_controllen >= sizeof(struct cmsghdr)) {
-            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-                if (cmsg->cmsg_level == SOL_PACKET && cmsg->cmsg_type == PACKET_AUXDATA) {
-                    const struct tpacket_auxdata *aux = (const struct tpacket_auxdata *)CMSG_DATA(cmsg);
-#ifdef TP_STATUS_VLAN_VALID
-                    if (aux->tp_status & TP_STATUS_VLAN_VALID) {
-                        vlan_id = normalize_vlan_id((int)(aux->tp_vlan_tci & 0x0FFF));
-                        break;
-                    }
-#else
-                    if (aux->tp_vlan_tci != 0 || aux->tp_vlan_tpid != 0) {
-                        vlan_id = normalize_vlan_id((int)(aux->tp_vlan_tci & 0x0FFF));
-                        break;
-                    }
-#endif
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        rx_deliver_frame(&delivery, buffer, (size_t)received, vlan_id, &ts);
+        rx_flush_batch(&delivery);
+    }
+}
+
+static void rx_mmsg_buffers_free(struct realtek_rx_mmsg_buffers *bufs) {
+    free(bufs->frames);
+    free(bufs->control);
+    free(bufs->iov);
+    free(bufs->msgs);
+    memset(bufs, 0, sizeof(*bufs));
+}
+
+static bool rx_mmsg_buffers_alloc(struct realtek_rx_mmsg_buffers *bufs, unsigned int count) {
+    memset(bufs, 0, sizeof(*bufs));
+    bufs->frames = malloc((size_t)count * TD_REALTEK_RX_BUFFER_SIZE);
+    bufs->control = malloc((size_t)count * TD_REALTEK_RX_CONTROL_SIZE);
+    bufs->iov = calloc(count, sizeof(*bufs->iov));
+    bufs->msgs = calloc(count, sizeof(*bufs->msgs));
+    if (!bufs->frames || !bufs->control || !bufs->iov || !bufs->msgs) {
+        rx_mmsg_buffers_free(bufs);
+        return false;
+    }
+
+    bufs->count = count;
+    for (unsigned int i = 0; i < count; ++i) {
+        bufs->iov[i].iov_base = bufs->frames + (size_t)i * TD_REALTEK_RX_BUFFER_SIZE;
+        bufs->iov[i].iov_len = TD_REALTEK_RX_BUFFER_SIZE;
+        bufs->msgs[i].msg_hdr.msg_iov = &bufs->iov[i];
+        bufs->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    return true;
+}
+
+static void rx_mmsg_buffers_rearm(struct realtek_rx_mmsg_buffers *bufs) {
+    for (unsigned int i = 0; i < bufs->count; ++i) {
+        struct msghdr *hdr = &bufs->msgs[i].msg_hdr;
+        hdr->msg_control = bufs->control + (size_t)i * TD_REALTEK_RX_CONTROL_SIZE;
+        hdr->msg_controllen = TD_REALTEK_RX_CONTROL_SIZE;
+        hdr->msg_flags = 0;
+        bufs->msgs[i].msg_len = 0;
+    }
+}
+
+static void rx_recvmsg_loop(struct realtek_rx_worker *worker);
+
+static void rx_recvmmsg_loop(struct realtek_rx_worker *worker) {
+    struct td_adapter *adapter = worker->adapter;
+    unsigned int batch = adapter->cfg.rx_batch_size > 0 ? adapter->cfg.rx_batch_size
+                                                       : TD_REALTEK_RX_MMSG_DEFAULT_BATCH;
+    if (batch > TD_REALTEK_RX_MMSG_MAX_BATCH) {
+        batch = TD_REALTEK_RX_MMSG_MAX_BATCH;
+    }
+
+    struct realtek_rx_mmsg_buffers bufs;
+    if (!rx_mmsg_buffers_alloc(&bufs, batch)) {
+        realtek_logf(adapter, TD_LOG_WARN, "failed to allocate %u recvmmsg buffers, falling back to recvmsg", batch);
+        rx_recvmsg_loop(worker);
+        return;
+    }
+
+    struct realtek_rx_delivery delivery;
+
+    while (atomic_load(&adapter->running)) {
+        if (!rx_wait_readable(worker)) {
+            break;
+        }
+
+        uint32_t drained = 0U;
+        while (atomic_load(&adapter->running)) {
+            rx_mmsg_buffers_rearm(&bufs);
+            int received = recvmmsg(worker->fd, bufs.msgs, bufs.count, MSG_DONTWAIT, NULL);
+            if (received < 0) {
+                if (errno == EINTR) {
+                    continue;
                 }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    realtek_logf(adapter, TD_LOG_ERROR, "recvmmsg failed: %s", strerror(errno));
+                }
+                break;
+            }
+            if (received == 0) {
+                break;
             }
-        }
 
-        if (ether_type == ETH_P_8021Q || ether_type == ETH_P_8021AD) {
-            if (received < (ssize_t)(sizeof(struct ethhdr) + sizeof(struct vlan_header))) {
+            drained += (uint32_t)received;
+            if (!rx_copy_subscription(adapter, &delivery)) {
                 continue;
             }
-            struct vlan_header vlan_local;
-            memcpy(&vlan_local, buffer + sizeof(struct ethhdr), sizeof(vlan_local));
-            vlan_id = normalize_vlan_id((int)(ntohs(vlan_local.tci) & 0x0FFF));
-            ether_type = ntohs(vlan_local.encapsulated_proto);
-            offset += sizeof(vlan_local);
-        }
 
-        vlan_id = normalize_vlan_id(vlan_id);
-
-        if (ether_type != ETH_P_ARP) {
-            continue;
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            for (int i = 0; i < received; ++i) {
+                struct mmsghdr *entry = &bufs.msgs[i];
+                int vlan_id = rx_auxdata_vlan(&entry->msg_hdr);
+                rx_deliver_frame(&delivery,
+                                 (const uint8_t *)bufs.iov[i].iov_base,
+                                 entry->msg_len,
+                                 vlan_id,
+                                 &ts);
+            }
+            rx_flush_batch(&delivery);
         }
 
-        size_t payload_len = 0;
-        if ((size_t)received > offset) {
-            payload_len = (size_t)received - offset;
-        }
+        rx_account_wakeup(adapter, drained);
+    }
 
-        struct td_adapter_packet_subscription sub;
-        bool subscribed = false;
-        pthread_mutex_lock(&adapter->state_lock);
-        if (adapter->packet_subscribed) {
-            sub = adapter->packet_sub;
-            subscribed = true;
-        }
-        pthread_mutex_unlock(&adapter->state_lock);
+    rx_mmsg_buffers_free(&bufs);
+}
 
-        if (!subscribed || !sub.callback) {
-            continue;
-        }
+static void rx_worker_pin(struct realtek_rx_worker *worker) {
+    if (worker->cpu < 0) {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(worker->cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        realtek_logf(worker->adapter, TD_LOG_WARN, "failed to pin RX worker %u to cpu %d: %s",
+                     worker->index,
+                     worker->cpu,
+                     strerror(rc));
+    }
+}
 
-        struct td_adapter_packet_view view;
-        memset(&view, 0, sizeof(view));
-        view.frame = buffer;
-        view.frame_len = (size_t)received;
-        view.payload = buffer + offset;
-        view.payload_len = payload_len;
-        view.ether_type = ether_type;
-        view.vlan_id = vlan_id;
-        clock_gettime(CLOCK_REALTIME, &view.ts);
-        view.ifindex = 0U;
-        memcpy(view.src_mac, eth_local.h_source, ETH_ALEN);
-        memcpy(view.dst_mac, eth_local.h_dest, ETH_ALEN);
+static void *rx_thread_main(void *arg) {
+    struct realtek_rx_worker *worker = (struct realtek_rx_worker *)arg;
+    struct td_adapter *adapter = worker->adapter;
+
+    rx_worker_pin(worker);
+    if (adapter->rx_worker_count > 1U) {
+        realtek_logf(adapter, TD_LOG_INFO, "RX thread started on %s (worker %u/%u cpu=%d)",
+                     adapter->rx_iface,
+                     worker->index,
+                     adapter->rx_worker_count,
+                     worker->cpu);
+    } else {
+        realtek_logf(adapter, TD_LOG_INFO, "RX thread started on %s", adapter->rx_iface);
+    }
 
-        sub.callback(&view, sub.user_ctx);
+    if (worker->ring.map) {
+        rx_ring_loop(worker);
+    } else if (adapter->cfg.rx_mode == TD_ADAPTER_RX_MODE_RECVMMSG) {
+        rx_recvmmsg_loop(worker);
+    } else {
+        rx_recvmsg_loop(worker);
     }
 
     realtek_logf(adapter, TD_LOG_INFO, "RX thread stopping on %s", adapter->rx_iface);
     return NULL;
 }
 
-static td_adapter_result_t ensure_rx_thread(struct td_adapter *adapter) {
+static td_adapter_result_t ensure_rx_threads(struct td_adapter *adapter) {
     if (!atomic_load(&adapter->running)) {
         return TD_ADAPTER_ERR_NOT_READY;
     }
-    if (adapter->rx_thread_started) {
-        return TD_ADAPTER_OK;
-    }
 
-    int rc = pthread_create(&adapter->rx_thread, NULL, rx_thread_main, adapter);
-    if (rc != 0) {
-        realtek_logf(adapter, TD_LOG_ERROR, "pthread_create failed: %s", strerror(rc));
-        return TD_ADAPTER_ERR_SYS;
+    for (unsigned int i = 0; i < adapter->rx_worker_count; ++i) {
+        struct realtek_rx_worker *worker = &adapter->rx_workers[i];
+        if (worker->thread_started) {
+            continue;
+        }
+        int rc = pthread_create(&worker->thread, NULL, rx_thread_main, worker);
+        if (rc != 0) {
+            realtek_logf(adapter, TD_LOG_ERROR, "pthread_create failed: %s", strerror(rc));
+            return TD_ADAPTER_ERR_SYS;
+        }
+        worker->thread_started = true;
     }
-    adapter->rx_thread_started = true;
     return TD_ADAPTER_OK;
 }
 
+static void join_rx_threads(struct td_adapter *adapter) {
+    for (unsigned int i = 0; i < adapter->rx_worker_count; ++i) {
+        struct realtek_rx_worker *worker = &adapter->rx_workers[i];
+        if (worker->thread_started) {
+            pthread_join(worker->thread, NULL);
+            worker->thread_started = false;
+        }
+    }
+}
+
 static td_adapter_result_t realtek_init(const struct td_adapter_config *cfg,
                                         const struct td_adapter_env *env,
                                         td_adapter_t **handle_out) {
@@ -828,15 +1833,12 @@ static td_adapter_result_t realtek_init(const struct td_adapter_config *cfg,
     }
 
     atomic_init(&adapter->running, false);
-    adapter->rx_fd = -1;
+    adapter->rx_worker_count = 0;
     adapter->tx_fd = -1;
     adapter->rx_kernel_ifindex = -1;
     adapter->tx_kernel_ifindex = -1;
     adapter->tx_ipv4.s_addr = 0;
     adapter->packet_subscribed = false;
-    adapter->rx_thread_started = false;
-    adapter->last_send.tv_sec = 0;
-    adapter->last_send.tv_nsec = 0;
 
     pthread_mutex_init(&adapter->state_lock, NULL);
     pthread_mutex_init(&adapter->send_lock, NULL);
@@ -870,15 +1872,8 @@ static void realtek_shutdown(td_adapter_t *handle) {
         atomic_store(&adapter->running, false);
     }
 
-    if (adapter->rx_thread_started) {
-        pthread_join(adapter->rx_thread, NULL);
-        adapter->rx_thread_started = false;
-    }
-
-    if (adapter->rx_fd >= 0) {
-        close(adapter->rx_fd);
-        adapter->rx_fd = -1;
-    }
+    join_rx_threads(adapter);
+    close_rx_sockets(adapter);
     if (adapter->tx_fd >= 0) {
         close(adapter->tx_fd);
         adapter->tx_fd = -1;
@@ -902,26 +1897,28 @@ static td_adapter_result_t realtek_start(td_adapter_t *handle) {
         return TD_ADAPTER_OK;
     }
 
-    adapter->rx_fd = configure_rx_socket(adapter);
-    if (adapter->rx_fd < 0) {
+    if (!configure_rx_sockets(adapter)) {
         return TD_ADAPTER_ERR_SYS;
     }
 
     adapter->tx_fd = configure_tx_socket(adapter);
     if (adapter->tx_fd < 0) {
-        close(adapter->rx_fd);
-        adapter->rx_fd = -1;
+        close_rx_sockets(adapter);
         return TD_ADAPTER_ERR_SYS;
     }
 
+    /* A new socket starts unbound and the default interface details may have
+     * changed, so templates built against the previous start are dropped. */
+    pthread_mutex_lock(&adapter->send_lock);
+    memset(adapter->tx_templates, 0, sizeof(adapter->tx_templates));
+    adapter->tx_bound_iface[0] = '\0';
+    pthread_mutex_unlock(&adapter->send_lock);
+
     atomic_store(&adapter->running, true);
 
     if (!mac_cache_start_worker(adapter)) {
         atomic_store(&adapter->running, false);
-        if (adapter->rx_fd >= 0) {
-            close(adapter->rx_fd);
-            adapter->rx_fd = -1;
-        }
+        close_rx_sockets(adapter);
         if (adapter->tx_fd >= 0) {
             close(adapter->tx_fd);
             adapter->tx_fd = -1;
@@ -935,11 +1932,12 @@ static td_adapter_result_t realtek_start(td_adapter_t *handle) {
     pthread_mutex_unlock(&adapter->state_lock);
 
     if (need_thread) {
-        td_adapter_result_t rc = ensure_rx_thread(adapter);
+        td_adapter_result_t rc = ensure_rx_threads(adapter);
         if (rc != TD_ADAPTER_OK) {
             atomic_store(&adapter->running, false);
-            close(adapter->rx_fd);
-            adapter->rx_fd = -1;
+            mac_cache_stop_worker(adapter);
+            join_rx_threads(adapter);
+            close_rx_sockets(adapter);
             close(adapter->tx_fd);
             adapter->tx_fd = -1;
             return rc;
@@ -964,15 +1962,8 @@ static void realtek_stop(td_adapter_t *handle) {
 
     mac_cache_stop_worker(adapter);
 
-    if (adapter->rx_thread_started) {
-        pthread_join(adapter->rx_thread, NULL);
-        adapter->rx_thread_started = false;
-    }
-
-    if (adapter->rx_fd >= 0) {
-        close(adapter->rx_fd);
-        adapter->rx_fd = -1;
-    }
+    join_rx_threads(adapter);
+    close_rx_sockets(adapter);
     if (adapter->tx_fd >= 0) {
         close(adapter->tx_fd);
         adapter->tx_fd = -1;
@@ -994,12 +1985,44 @@ static td_adapter_result_t realtek_register_packet_rx(td_adapter_t *handle,
     pthread_mutex_unlock(&adapter->state_lock);
 
     if (atomic_load(&adapter->running)) {
-        return ensure_rx_thread(adapter);
+        return ensure_rx_threads(adapter);
+    }
+
+    return TD_ADAPTER_OK;
+}
+
+static td_adapter_result_t realtek_register_packet_rx_batch(td_adapter_t *handle,
+                                                            const struct td_adapter_packet_batch_subscription *sub) {
+    if (!handle || !sub || !sub->callback) {
+        return TD_ADAPTER_ERR_INVALID_ARG;
+    }
+
+    struct td_adapter *adapter = handle;
+    pthread_mutex_lock(&adapter->state_lock);
+    adapter->packet_batch_sub = *sub;
+    adapter->packet_subscribed = true;
+    pthread_mutex_unlock(&adapter->state_lock);
+
+    if (atomic_load(&adapter->running)) {
+        return ensure_rx_threads(adapter);
     }
 
     return TD_ADAPTER_OK;
 }
 
+static void tx_log_sent(struct td_adapter *adapter,
+                        const struct td_adapter_arp_request *req,
+                        const char *tx_iface,
+                        int vlan_id) {
+    char ip_buf[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &req->target_ip, ip_buf, sizeof(ip_buf));
+    if (vlan_id > 0) {
+        realtek_logf(adapter, TD_LOG_DEBUG, "ARP probe sent to %s via %s vlan=%d", ip_buf, tx_iface, vlan_id);
+    } else {
+        realtek_logf(adapter, TD_LOG_DEBUG, "ARP probe sent to %s via %s", ip_buf, tx_iface);
+    }
+}
+
 static td_adapter_result_t realtek_send_arp(td_adapter_t *handle,
                                             const struct td_adapter_arp_request *req) {
     if (!handle || !req) {
@@ -1011,144 +2034,132 @@ static td_adapter_result_t realtek_send_arp(td_adapter_t *handle,
         return TD_ADAPTER_ERR_NOT_READY;
     }
 
+    /* Pacing lives in the caller's probe scheduler; send_lock only guards
+     * the shared socket, the frame templates and the batch slots. */
     pthread_mutex_lock(&adapter->send_lock);
 
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
 
-    if (adapter->cfg.tx_interval_ms > 0 && adapter->last_send.tv_sec != 0) {
-        long diff_ms = (now.tv_sec - adapter->last_send.tv_sec) * 1000L;
-        diff_ms += (now.tv_nsec - adapter->last_send.tv_nsec) / 1000000L;
-        if (diff_ms < (long)adapter->cfg.tx_interval_ms) {
-            long sleep_ms = (long)adapter->cfg.tx_interval_ms - diff_ms;
-            if (sleep_ms > 0) {
-                struct timespec req_sleep = {
-                    .tv_sec = sleep_ms / 1000,
-                    .tv_nsec = (sleep_ms % 1000) * 1000000L,
-                };
-                nanosleep(&req_sleep, NULL);
-                clock_gettime(CLOCK_MONOTONIC, &now);
-            }
-        }
+    struct tx_batch_slot *slot = &adapter->tx_slots[0];
+    td_adapter_result_t rc = tx_prepare_frame_locked(adapter, req, &now, slot);
+    if (rc != TD_ADAPTER_OK) {
+        pthread_mutex_unlock(&adapter->send_lock);
+        return rc;
     }
 
-    const char *tx_iface = adapter->tx_iface;
-    int tx_kernel_ifindex = adapter->tx_kernel_ifindex;
-    struct in_addr iface_ip = adapter->tx_ipv4;
-    uint8_t iface_mac[ETH_ALEN];
-    memcpy(iface_mac, adapter->tx_mac, ETH_ALEN);
+    bind_socket_to_iface(adapter, slot->iface);
 
-    if (req->tx_iface_valid && req->tx_iface[0]) {
-        tx_iface = req->tx_iface;
-        tx_kernel_ifindex = req->tx_kernel_ifindex;
-        if (!query_iface_details(tx_iface, &tx_kernel_ifindex, iface_mac, &iface_ip)) {
-            pthread_mutex_unlock(&adapter->send_lock);
-            realtek_logf(adapter, TD_LOG_ERROR, "failed to resolve interface %s for ARP send", tx_iface);
-            return TD_ADAPTER_ERR_INVALID_ARG;
-        }
-    } else if (!tx_iface || !tx_iface[0]) {
+    ssize_t sent = sendto(adapter->tx_fd, slot->frame, slot->frame_len, 0,
+                          (struct sockaddr *)&slot->addr, sizeof(slot->addr));
+    if (sent < 0) {
+        int err = errno;
+        tx_template_invalidate_locked(adapter, slot);
         pthread_mutex_unlock(&adapter->send_lock);
-        realtek_logf(adapter, TD_LOG_ERROR, "no transmit interface configured for ARP send");
-        return TD_ADAPTER_ERR_INVALID_ARG;
+        realtek_logf(adapter, TD_LOG_ERROR, "sendto failed: %s", strerror(err));
+        return TD_ADAPTER_ERR_SYS;
     }
 
-    if (tx_kernel_ifindex <= 0) {
-        if (!query_iface_details(tx_iface, &tx_kernel_ifindex, iface_mac, &iface_ip)) {
-            pthread_mutex_unlock(&adapter->send_lock);
-            realtek_logf(adapter, TD_LOG_ERROR, "failed to resolve interface %s for ARP send", tx_iface);
-            return TD_ADAPTER_ERR_INVALID_ARG;
-        }
-    }
+    char tx_iface[IFNAMSIZ];
+    int vlan_id = slot->vlan_id;
+    memcpy(tx_iface, slot->iface, sizeof(tx_iface));
+    pthread_mutex_unlock(&adapter->send_lock);
 
-    bind_socket_to_iface(adapter, tx_iface);
+    tx_log_sent(adapter, req, tx_iface, vlan_id);
+    return TD_ADAPTER_OK;
+}
 
-    uint8_t sender_mac[ETH_ALEN];
-    if (all_zero_mac(req->sender_mac)) {
-        memcpy(sender_mac, iface_mac, ETH_ALEN);
-    } else {
-        memcpy(sender_mac, req->sender_mac, ETH_ALEN);
+/* Hands tx_slots[0..count) to sendmmsg, resuming after each failed frame.
+ * All slots share one interface. Caller holds send_lock. */
+static void tx_flush_locked(struct td_adapter *adapter, size_t count, td_adapter_result_t *results) {
+    if (count == 0) {
+        return;
     }
 
-    struct in_addr sender_ip = req->sender_ip;
-    if (sender_ip.s_addr == 0) {
-        sender_ip = iface_ip;
-    }
+    bind_socket_to_iface(adapter, adapter->tx_slots[0].iface);
 
-    if (sender_ip.s_addr == 0) {
-        pthread_mutex_unlock(&adapter->send_lock);
-        realtek_logf(adapter, TD_LOG_WARN, "interface %s has no IPv4, skipping ARP send", tx_iface);
-        return TD_ADAPTER_ERR_NOT_READY;
+    for (size_t i = 0; i < count; ++i) {
+        struct tx_batch_slot *slot = &adapter->tx_slots[i];
+        slot->iov.iov_base = slot->frame;
+        slot->iov.iov_len = slot->frame_len;
+        memset(&adapter->tx_msgs[i], 0, sizeof(adapter->tx_msgs[i]));
+        adapter->tx_msgs[i].msg_hdr.msg_name = &slot->addr;
+        adapter->tx_msgs[i].msg_hdr.msg_namelen = sizeof(slot->addr);
+        adapter->tx_msgs[i].msg_hdr.msg_iov = &slot->iov;
+        adapter->tx_msgs[i].msg_hdr.msg_iovlen = 1;
     }
 
-    uint8_t target_mac[ETH_ALEN];
-    if (all_zero_mac(req->target_mac)) {
-        memset(target_mac, 0xFF, ETH_ALEN);
-    } else {
-        memcpy(target_mac, req->target_mac, ETH_ALEN);
+    size_t done = 0;
+    while (done < count) {
+        int sent = sendmmsg(adapter->tx_fd, &adapter->tx_msgs[done], (unsigned int)(count - done), 0);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            /* sendmmsg only fails outright on the first frame of the call. */
+            int err = sent < 0 ? errno : EIO;
+            struct tx_batch_slot *slot = &adapter->tx_slots[done];
+            tx_template_invalidate_locked(adapter, slot);
+            results[slot->request_index] = TD_ADAPTER_ERR_SYS;
+            realtek_logf(adapter, TD_LOG_ERROR, "sendmmsg failed on %s: %s", slot->iface, strerror(err));
+            done += 1;
+            continue;
+        }
+        done += (size_t)sent;
     }
+}
 
-    int effective_vlan = (req->vlan_id >= 1 && req->vlan_id <= 4094) ? req->vlan_id : -1;
-    bool vlan_tagging = effective_vlan > 0;
-
-    uint8_t frame[sizeof(struct ethhdr) + sizeof(struct vlan_header) + sizeof(struct ether_arp)];
-    memset(frame, 0, sizeof(frame));
-
-    struct ethhdr *eth = (struct ethhdr *)frame;
-    memcpy(eth->h_dest, target_mac, ETH_ALEN);
-    memcpy(eth->h_source, sender_mac, ETH_ALEN);
+static td_adapter_result_t realtek_send_arp_batch(td_adapter_t *handle,
+                                                  const struct td_adapter_arp_request *requests,
+                                                  td_adapter_result_t *results,
+                                                  size_t count) {
+    if (!handle || (count > 0 && (!requests || !results))) {
+        return TD_ADAPTER_ERR_INVALID_ARG;
+    }
 
-    size_t offset = sizeof(struct ethhdr);
-    if (vlan_tagging) {
-        eth->h_proto = htons(ETH_P_8021Q);
-        struct vlan_header *vlan = (struct vlan_header *)(frame + sizeof(struct ethhdr));
-        vlan->tci = htons((uint16_t)(effective_vlan & 0x0FFF));
-        vlan->encapsulated_proto = htons(ETH_P_ARP);
-        offset += sizeof(struct vlan_header);
-    } else {
-        eth->h_proto = htons(ETH_P_ARP);
+    struct td_adapter *adapter = handle;
+    if (adapter->tx_fd < 0 || adapter->tx_kernel_ifindex <= 0) {
+        return TD_ADAPTER_ERR_NOT_READY;
     }
 
-    struct ether_arp *arp = (struct ether_arp *)(frame + offset);
-    arp->ea_hdr.ar_hrd = htons(ARPHRD_ETHER);
-    arp->ea_hdr.ar_pro = htons(ETH_P_IP);
-    arp->ea_hdr.ar_hln = ETH_ALEN;
-    arp->ea_hdr.ar_pln = 4;
-    arp->ea_hdr.ar_op = htons(ARPOP_REQUEST);
-    memcpy(arp->arp_sha, sender_mac, ETH_ALEN);
-    memcpy(arp->arp_spa, &sender_ip.s_addr, sizeof(arp->arp_spa));
-    memcpy(arp->arp_tha, target_mac, ETH_ALEN);
-    memcpy(arp->arp_tpa, &req->target_ip.s_addr, sizeof(arp->arp_tpa));
+    pthread_mutex_lock(&adapter->send_lock);
 
-    struct sockaddr_ll addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sll_family = AF_PACKET;
-    addr.sll_protocol = htons(vlan_tagging ? ETH_P_8021Q : ETH_P_ARP);
-    addr.sll_ifindex = tx_kernel_ifindex;
-    addr.sll_halen = ETH_ALEN;
-    memcpy(addr.sll_addr, target_mac, ETH_ALEN);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
 
-    size_t frame_len = offset + sizeof(struct ether_arp);
+    /* Frames are staged per interface so a single SO_BINDTODEVICE covers
+     * each sendmmsg call; an interface change or a full stage flushes. */
+    size_t pending = 0;
+    for (size_t i = 0; i < count; ++i) {
+        struct tx_batch_slot *slot = &adapter->tx_slots[pending];
+        results[i] = tx_prepare_frame_locked(adapter, &requests[i], &now, slot);
+        if (results[i] != TD_ADAPTER_OK) {
+            continue;
+        }
+        slot->request_index = i;
 
-    ssize_t sent = sendto(adapter->tx_fd, frame, frame_len, 0,
-                          (struct sockaddr *)&addr, sizeof(addr));
-    if (sent < 0) {
-        int err = errno;
-        pthread_mutex_unlock(&adapter->send_lock);
-        realtek_logf(adapter, TD_LOG_ERROR, "sendto failed: %s", strerror(err));
-        return TD_ADAPTER_ERR_SYS;
+        if (pending > 0 && strcmp(slot->iface, adapter->tx_slots[0].iface) != 0) {
+            tx_flush_locked(adapter, pending, results);
+            adapter->tx_slots[0] = *slot;
+            pending = 0;
+        }
+        pending += 1;
+        if (pending == TD_REALTEK_TX_BATCH_MAX) {
+            tx_flush_locked(adapter, pending, results);
+            pending = 0;
+        }
     }
+    tx_flush_locked(adapter, pending, results);
 
-    adapter->last_send = now;
     pthread_mutex_unlock(&adapter->send_lock);
 
-    char ip_buf[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &req->target_ip, ip_buf, sizeof(ip_buf));
-    if (vlan_tagging) {
-        realtek_logf(adapter, TD_LOG_DEBUG, "ARP probe sent to %s via %s vlan=%d", ip_buf, tx_iface, effective_vlan);
-    } else {
-        realtek_logf(adapter, TD_LOG_DEBUG, "ARP probe sent to %s via %s", ip_buf, tx_iface);
+    size_t sent = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (results[i] == TD_ADAPTER_OK) {
+            sent += 1;
+        }
     }
-
+    realtek_logf(adapter, TD_LOG_DEBUG, "ARP probe batch sent %zu/%zu", sent, count);
     return TD_ADAPTER_OK;
 }
 
@@ -1187,6 +2198,19 @@ static td_adapter_result_t realtek_query_iface(td_adapter_t *handle,
     return TD_ADAPTER_OK;
 }
 
+static td_adapter_result_t realtek_get_rx_stats(td_adapter_t *handle,
+                                                struct td_adapter_rx_stats *stats_out) {
+    if (!handle || !stats_out) {
+        return TD_ADAPTER_ERR_INVALID_ARG;
+    }
+
+    struct td_adapter *adapter = handle;
+    pthread_mutex_lock(&adapter->state_lock);
+    *stats_out = adapter->rx_stats;
+    pthread_mutex_unlock(&adapter->state_lock);
+    return TD_ADAPTER_OK;
+}
+
 static td_adapter_result_t realtek_mac_locator_lookup(td_adapter_t *handle,
                                                       const uint8_t mac[ETH_ALEN],
                                                       uint16_t vlan_id,
@@ -1202,49 +2226,98 @@ static td_adapter_result_t realtek_mac_locator_lookup(td_adapter_t *handle,
     struct td_adapter *adapter = handle;
     struct realtek_mac_cache *cache = &adapter->mac_cache;
 
-    for (int attempt = 0; attempt < 2; ++attempt) {
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-
-        pthread_rwlock_rdlock(&cache->map_lock);
-        uint64_t version = cache->version;
-        bool need_refresh = (version == 0ULL) || mac_cache_should_refresh(cache, &now);
-        if (need_refresh) {
-            pthread_rwlock_unlock(&cache->map_lock);
-            if (attempt == 0) {
-                if (!mac_cache_refresh(adapter, true)) {
-                    return TD_ADAPTER_ERR_NOT_READY;
-                }
-                continue;
-            }
+    /* Only a cold cache refreshes inline; a stale one keeps answering from
+     * the published table while the worker rebuilds the next one. */
+    if (!mac_cache_current(cache)) {
+        if (!mac_cache_refresh(adapter, false)) {
             return TD_ADAPTER_ERR_NOT_READY;
         }
+    }
 
-        uint32_t bucket = mac_hash(mac, vlan_id);
-        for (struct mac_bucket_entry *node = cache->buckets[bucket]; node; node = node->next) {
-            if (node->vlan == vlan_id && memcmp(node->mac, mac, ETH_ALEN) == 0) {
-                if (ifindex_out) {
-                    *ifindex_out = node->ifindex;
-                }
-                if (version_out) {
-                    *version_out = version;
-                }
-                pthread_rwlock_unlock(&cache->map_lock);
-                return TD_ADAPTER_OK;
-            }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    unsigned int slot = mac_cache_read_lock(cache);
+    const struct realtek_mac_table *table = mac_cache_current(cache);
+    if (!table) {
+        mac_cache_read_unlock(cache, slot);
+        return TD_ADAPTER_ERR_NOT_READY;
+    }
+    bool stale = mac_cache_should_refresh(cache, table, &now);
+    uint64_t version = table->version;
+
+    td_adapter_result_t result = TD_ADAPTER_ERR_NOT_FOUND;
+    uint32_t ifindex = 0U;
+    const SwUcMacEntry *entry = mac_table_find(table, mac, vlan_id);
+    if (entry) {
+        ifindex = entry->ifindex;
+        result = TD_ADAPTER_OK;
+    }
+    mac_cache_read_unlock(cache, slot);
+
+    if (stale) {
+        mac_cache_request_refresh(adapter);
+    }
+    if (ifindex_out) {
+        *ifindex_out = ifindex;
+    }
+    if (version_out) {
+        *version_out = version;
+    }
+    return result;
+}
+
+static td_adapter_result_t realtek_mac_locator_lookup_batch(td_adapter_t *handle,
+                                                            struct td_adapter_mac_lookup *requests,
+                                                            size_t count) {
+    if (!handle || (!requests && count > 0)) {
+        return TD_ADAPTER_ERR_INVALID_ARG;
+    }
+
+    struct td_adapter *adapter = handle;
+    struct realtek_mac_cache *cache = &adapter->mac_cache;
+
+    if (!mac_cache_current(cache)) {
+        if (!mac_cache_refresh(adapter, false)) {
+            return TD_ADAPTER_ERR_NOT_READY;
         }
+    }
 
-        if (ifindex_out) {
-            *ifindex_out = 0U;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    /* Every element is answered from the same pinned generation. */
+    unsigned int slot = mac_cache_read_lock(cache);
+    const struct realtek_mac_table *table = mac_cache_current(cache);
+    if (!table) {
+        mac_cache_read_unlock(cache, slot);
+        return TD_ADAPTER_ERR_NOT_READY;
+    }
+    bool stale = mac_cache_should_refresh(cache, table, &now);
+    uint64_t version = table->version;
+
+    for (size_t i = 0; i < count; ++i) {
+        struct td_adapter_mac_lookup *request = &requests[i];
+        request->ifindex = 0U;
+        request->version = version;
+        if (request->vlan_id > 4094U) {
+            request->rc = TD_ADAPTER_ERR_INVALID_ARG;
+            continue;
         }
-        if (version_out) {
-            *version_out = version;
+        const SwUcMacEntry *entry = mac_table_find(table, request->mac, request->vlan_id);
+        if (entry) {
+            request->ifindex = entry->ifindex;
+            request->rc = TD_ADAPTER_OK;
+        } else {
+            request->rc = TD_ADAPTER_ERR_NOT_FOUND;
         }
-        pthread_rwlock_unlock(&cache->map_lock);
-        return TD_ADAPTER_ERR_NOT_FOUND;
     }
+    mac_cache_read_unlock(cache, slot);
 
-    return TD_ADAPTER_ERR_NOT_READY;
+    if (stale) {
+        mac_cache_request_refresh(adapter);
+    }
+    return TD_ADAPTER_OK;
 }
 
 static td_adapter_result_t realtek_mac_locator_lookup_by_vid(td_adapter_t *handle,
@@ -1312,7 +2385,7 @@ static td_adapter_result_t realtek_mac_locator_subscribe(td_adapter_t *handle,
     struct realtek_mac_cache *cache = &adapter->mac_cache;
 
     pthread_mutex_lock(&cache->worker_lock);
-    if (cache->refresh_cb) {
+    if (cache->refresh_cb || cache->delta_cb) {
         pthread_mutex_unlock(&cache->worker_lock);
         return TD_ADAPTER_ERR_ALREADY;
     }
@@ -1332,6 +2405,37 @@ static td_adapter_result_t realtek_mac_locator_subscribe(td_adapter_t *handle,
     return TD_ADAPTER_OK;
 }
 
+static td_adapter_result_t realtek_mac_locator_subscribe_delta(td_adapter_t *handle,
+                                                               td_adapter_mac_locator_delta_cb cb,
+                                                               void *ctx) {
+    if (!handle || !cb) {
+        return TD_ADAPTER_ERR_INVALID_ARG;
+    }
+
+    struct td_adapter *adapter = handle;
+    struct realtek_mac_cache *cache = &adapter->mac_cache;
+
+    pthread_mutex_lock(&cache->worker_lock);
+    if (cache->refresh_cb || cache->delta_cb) {
+        pthread_mutex_unlock(&cache->worker_lock);
+        return TD_ADAPTER_ERR_ALREADY;
+    }
+    cache->delta_cb = cb;
+    cache->delta_ctx = ctx;
+    pthread_mutex_unlock(&cache->worker_lock);
+
+    if (!mac_cache_start_worker(adapter)) {
+        pthread_mutex_lock(&cache->worker_lock);
+        cache->delta_cb = NULL;
+        cache->delta_ctx = NULL;
+        pthread_mutex_unlock(&cache->worker_lock);
+        return TD_ADAPTER_ERR_SYS;
+    }
+
+    mac_cache_request_refresh(adapter);
+    return TD_ADAPTER_OK;
+}
+
 static td_adapter_result_t realtek_mac_locator_get_version(td_adapter_t *handle,
                                                            uint64_t *version_out) {
     if (!handle || !version_out) {
@@ -1341,9 +2445,10 @@ static td_adapter_result_t realtek_mac_locator_get_version(td_adapter_t *handle,
     struct td_adapter *adapter = handle;
     struct realtek_mac_cache *cache = &adapter->mac_cache;
 
-    pthread_rwlock_rdlock(&cache->map_lock);
-    uint64_t version = cache->version;
-    pthread_rwlock_unlock(&cache->map_lock);
+    unsigned int slot = mac_cache_read_lock(cache);
+    const struct realtek_mac_table *table = mac_cache_current(cache);
+    uint64_t version = table ? table->version : 0ULL;
+    mac_cache_read_unlock(cache, slot);
 
     *version_out = version;
     if (version == 0ULL) {
@@ -1357,6 +2462,8 @@ static const struct td_adapter_mac_locator_ops g_realtek_mac_locator_ops = {
     .lookup_by_vid = realtek_mac_locator_lookup_by_vid,
     .subscribe = realtek_mac_locator_subscribe,
     .get_version = realtek_mac_locator_get_version,
+    .subscribe_delta = realtek_mac_locator_subscribe_delta,
+    .lookup_batch = realtek_mac_locator_lookup_batch,
 };
 
 static void realtek_log_write(td_adapter_t *handle,
@@ -1381,8 +2488,11 @@ static const struct td_adapter_ops g_realtek_ops = {
     .start = realtek_start,
     .stop = realtek_stop,
     .register_packet_rx = realtek_register_packet_rx,
+    .register_packet_rx_batch = realtek_register_packet_rx_batch,
     .send_arp = realtek_send_arp,
+    .send_arp_batch = realtek_send_arp_batch,
     .query_iface = realtek_query_iface,
+    .get_rx_stats = realtek_get_rx_stats,
     .log_write = realtek_log_write,
     .mac_locator_ops = &g_realtek_mac_locator_ops,
 };
@@ -24,11 +24,22 @@ int td_config_load_defaults(struct td_runtime_config *cfg) {
     snprintf(cfg->rx_iface, sizeof(cfg->rx_iface), "%s", TD_DEFAULT_RX_IFACE);
     snprintf(cfg->tx_iface, sizeof(cfg->tx_iface), "%s", TD_DEFAULT_TX_IFACE);
     cfg->tx_interval_ms = TD_DEFAULT_TX_INTERVAL_MS;
+    cfg->tx_burst = TD_DEFAULT_TX_BURST;
+    cfg->tx_queue_size = 0U;
+    cfg->rx_mode = TD_ADAPTER_RX_MODE_RECVMSG;
+    cfg->rx_ring_size = 0U;
+    cfg->rx_batch_size = 0U;
+    cfg->rx_fanout = 0U;
+    cfg->rx_cpu_list[0] = '\0';
     cfg->keepalive_interval_sec = TD_DEFAULT_KEEPALIVE_INTERVAL_SEC;
     cfg->keepalive_miss_threshold = TD_DEFAULT_KEEPALIVE_MISS_THRESHOLD;
     cfg->iface_invalid_holdoff_sec = TD_DEFAULT_IFACE_INVALID_HOLDOFF_SEC;
     cfg->max_terminals = TD_DEFAULT_MAX_TERMINALS;
     cfg->stats_log_interval_sec = TD_DEFAULT_STATS_LOG_INTERVAL_SEC;
+    cfg->event_ring_size = 0U;
+    cfg->event_overflow_policy = TERMINAL_EVENT_OVERFLOW_COALESCE;
+    cfg->event_window_ms = 0U;
+    cfg->event_journal_size = 0U;
     cfg->log_level = TD_LOG_INFO;
 
     return 0;
@@ -47,6 +58,10 @@ int td_config_to_manager_config(const struct td_runtime_config *runtime,
     out->scan_interval_ms = 0U;
     out->vlan_iface_format = NULL;
     out->max_terminals = runtime->max_terminals;
+    out->event_ring_size = runtime->event_ring_size;
+    out->event_overflow_policy = (terminal_event_overflow_policy_t)runtime->event_overflow_policy;
+    out->event_window_ms = runtime->event_window_ms;
+    out->event_journal_size = runtime->event_journal_size;
 
     if (runtime->ignored_vlan_count > TD_MAX_IGNORED_VLANS) {
         return -1;
@@ -0,0 +1,156 @@
+#define _GNU_SOURCE
+
+#include "td_object_pool.h"
+
+#include <errno.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Under AddressSanitizer free objects are poisoned, so a read through a
+ * stale pointer into the pool is reported like a heap use-after-free. */
+#if defined(__SANITIZE_ADDRESS__)
+#define TD_OBJECT_POOL_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define TD_OBJECT_POOL_ASAN 1
+#endif
+#endif
+
+#ifdef TD_OBJECT_POOL_ASAN
+#include <sanitizer/asan_interface.h>
+#define POOL_POISON(addr, size) ASAN_POISON_MEMORY_REGION((addr), (size))
+#define POOL_UNPOISON(addr, size) ASAN_UNPOISON_MEMORY_REGION((addr), (size))
+#else
+#define POOL_POISON(addr, size) ((void)(addr), (void)(size))
+#define POOL_UNPOISON(addr, size) ((void)(addr), (void)(size))
+#endif
+
+struct td_object_pool_slab {
+    struct td_object_pool_slab *next;
+    alignas(max_align_t) unsigned char objects[];
+};
+
+struct td_object_pool_free_node {
+    struct td_object_pool_free_node *next;
+};
+
+static size_t round_object_size(size_t size) {
+    if (size < sizeof(struct td_object_pool_free_node)) {
+        size = sizeof(struct td_object_pool_free_node);
+    }
+    size_t align = alignof(max_align_t);
+    return (size + align - 1U) / align * align;
+}
+
+int td_object_pool_init(struct td_object_pool *pool,
+                        size_t object_size,
+                        size_t objects_per_slab) {
+    if (!pool || object_size == 0 || objects_per_slab == 0) {
+        return -EINVAL;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        return -EAGAIN;
+    }
+    pool->object_size = round_object_size(object_size);
+    pool->objects_per_slab = objects_per_slab;
+    return 0;
+}
+
+void td_object_pool_destroy(struct td_object_pool *pool) {
+    if (!pool) {
+        return;
+    }
+
+    struct td_object_pool_slab *slab = pool->slabs;
+    while (slab) {
+        struct td_object_pool_slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pthread_mutex_destroy(&pool->lock);
+}
+
+/* Caller holds pool->lock. */
+static int pool_grow_locked(struct td_object_pool *pool) {
+    struct td_object_pool_slab *slab = malloc(sizeof(*slab) + pool->object_size * pool->objects_per_slab);
+    if (!slab) {
+        return -ENOMEM;
+    }
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_count += 1U;
+    pool->capacity += pool->objects_per_slab;
+
+    /* Thread the new objects in address order so early allocations stay
+     * adjacent in memory. */
+    for (size_t i = pool->objects_per_slab; i > 0; --i) {
+        struct td_object_pool_free_node *node =
+            (struct td_object_pool_free_node *)(void *)(slab->objects + (i - 1U) * pool->object_size);
+        node->next = pool->free_list;
+        pool->free_list = node;
+        POOL_POISON(node, pool->object_size);
+    }
+    return 0;
+}
+
+void *td_object_pool_alloc(struct td_object_pool *pool) {
+    if (!pool) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    if (!pool->free_list && pool_grow_locked(pool) != 0) {
+        pool->alloc_failures += 1U;
+        pthread_mutex_unlock(&pool->lock);
+        return NULL;
+    }
+
+    struct td_object_pool_free_node *node = pool->free_list;
+    POOL_UNPOISON(node, pool->object_size);
+    pool->free_list = node->next;
+    pool->in_use += 1U;
+    if (pool->in_use > pool->peak_in_use) {
+        pool->peak_in_use = pool->in_use;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    memset(node, 0, pool->object_size);
+    return node;
+}
+
+void td_object_pool_free(struct td_object_pool *pool, void *object) {
+    if (!pool || !object) {
+        return;
+    }
+
+    struct td_object_pool_free_node *node = (struct td_object_pool_free_node *)object;
+    pthread_mutex_lock(&pool->lock);
+    node->next = pool->free_list;
+    pool->free_list = node;
+    POOL_POISON(node, pool->object_size);
+    if (pool->in_use > 0) {
+        pool->in_use -= 1U;
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void td_object_pool_get_stats(struct td_object_pool *pool,
+                              struct td_object_pool_stats *out) {
+    if (!pool || !out) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    out->in_use = pool->in_use;
+    out->capacity = pool->capacity;
+    out->slabs = pool->slab_count;
+    out->peak_in_use = pool->peak_in_use;
+    out->alloc_failures = pool->alloc_failures;
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,354 @@
+#define _GNU_SOURCE
+
+#include "terminal_event_ring.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TERMINAL_COALESCER_INITIAL 32U
+
+static size_t round_up_pow2(size_t value) {
+    size_t out = 1U;
+    while (out < value) {
+        out <<= 1U;
+    }
+    return out;
+}
+
+int terminal_event_ring_init(struct terminal_event_ring *ring, size_t capacity) {
+    if (!ring || capacity < 2U || capacity > ((size_t)-1 >> 2)) {
+        return -EINVAL;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    capacity = round_up_pow2(capacity);
+    ring->cells = calloc(capacity, sizeof(*ring->cells));
+    if (!ring->cells) {
+        return -ENOMEM;
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+        ring->cells[i].seq = i;
+    }
+    ring->mask = capacity - 1U;
+    return 0;
+}
+
+void terminal_event_ring_destroy(struct terminal_event_ring *ring) {
+    if (!ring) {
+        return;
+    }
+    free(ring->cells);
+    ring->cells = NULL;
+    ring->mask = 0;
+}
+
+size_t terminal_event_ring_capacity(const struct terminal_event_ring *ring) {
+    if (!ring || !ring->cells) {
+        return 0;
+    }
+    return ring->mask + 1U;
+}
+
+static void ring_note_depth(struct terminal_event_ring *ring, size_t depth) {
+    size_t seen = __atomic_load_n(&ring->high_water, __ATOMIC_RELAXED);
+    while (depth > seen) {
+        if (__atomic_compare_exchange_n(&ring->high_water, &seen, depth, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+}
+
+bool terminal_event_ring_push(struct terminal_event_ring *ring,
+                              const terminal_event_record_t *record) {
+    if (!ring || !ring->cells || !record) {
+        return false;
+    }
+
+    struct terminal_event_cell *cell = NULL;
+    size_t pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        cell = &ring->cells[pos & ring->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->tail, &pos, pos + 1U, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->record = *record;
+    __atomic_store_n(&cell->seq, pos + 1U, __ATOMIC_RELEASE);
+
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    ring_note_depth(ring, pos + 1U - head);
+    return true;
+}
+
+bool terminal_event_ring_pop(struct terminal_event_ring *ring,
+                             terminal_event_record_t *out) {
+    if (!ring || !ring->cells) {
+        return false;
+    }
+
+    struct terminal_event_cell *cell = NULL;
+    size_t pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    for (;;) {
+        cell = &ring->cells[pos & ring->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1U);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->head, &pos, pos + 1U, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (out) {
+        *out = cell->record;
+    }
+    __atomic_store_n(&cell->seq, pos + ring->mask + 1U, __ATOMIC_RELEASE);
+    return true;
+}
+
+size_t terminal_event_ring_depth(struct terminal_event_ring *ring) {
+    if (!ring || !ring->cells) {
+        return 0;
+    }
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST);
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST);
+    size_t depth = tail - head;
+    /* head can overtake a stale tail read while a pop races the load. */
+    return depth > ring->mask + 1U ? 0U : depth;
+}
+
+size_t terminal_event_ring_high_water(struct terminal_event_ring *ring) {
+    if (!ring) {
+        return 0;
+    }
+    return __atomic_load_n(&ring->high_water, __ATOMIC_RELAXED);
+}
+
+static uint32_t coalescer_hash(const struct terminal_key *key) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < ETH_ALEN; ++i) {
+        hash ^= key->mac[i];
+        hash *= 16777619u;
+    }
+    const uint8_t *ip = (const uint8_t *)&key->ip.s_addr;
+    for (size_t i = 0; i < sizeof(key->ip.s_addr); ++i) {
+        hash ^= ip[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool coalescer_key_equal(const struct terminal_key *lhs, const struct terminal_key *rhs) {
+    return memcmp(lhs->mac, rhs->mac, ETH_ALEN) == 0 && lhs->ip.s_addr == rhs->ip.s_addr;
+}
+
+void terminal_event_coalescer_init(struct terminal_event_coalescer *coalescer) {
+    if (!coalescer) {
+        return;
+    }
+    memset(coalescer, 0, sizeof(*coalescer));
+}
+
+void terminal_event_coalescer_destroy(struct terminal_event_coalescer *coalescer) {
+    if (!coalescer) {
+        return;
+    }
+    free(coalescer->records);
+    free(coalescer->live);
+    free(coalescer->index);
+    memset(coalescer, 0, sizeof(*coalescer));
+}
+
+static void coalescer_index_insert(struct terminal_event_coalescer *coalescer, size_t pos) {
+    size_t mask = coalescer->index_capacity - 1U;
+    size_t slot = coalescer_hash(&coalescer->records[pos].key) & mask;
+    while (coalescer->index[slot] != 0U) {
+        slot = (slot + 1U) & mask;
+    }
+    coalescer->index[slot] = (uint32_t)(pos + 1U);
+}
+
+static int coalescer_grow(struct terminal_event_coalescer *coalescer) {
+    size_t capacity = coalescer->capacity ? coalescer->capacity * 2U : TERMINAL_COALESCER_INITIAL;
+    if (capacity > UINT32_MAX / 2U) {
+        return -ENOMEM;
+    }
+
+    terminal_event_record_t *records = realloc(coalescer->records, capacity * sizeof(*records));
+    if (!records) {
+        return -ENOMEM;
+    }
+    coalescer->records = records;
+
+    bool *live = realloc(coalescer->live, capacity * sizeof(*live));
+    if (!live) {
+        return -ENOMEM;
+    }
+    coalescer->live = live;
+
+    /* The index stays at most half full so probe chains remain short. */
+    uint32_t *index = calloc(capacity * 2U, sizeof(*index));
+    if (!index) {
+        return -ENOMEM;
+    }
+    free(coalescer->index);
+    coalescer->index = index;
+    coalescer->index_capacity = capacity * 2U;
+    coalescer->capacity = capacity;
+    for (size_t i = 0; i < coalescer->count; ++i) {
+        coalescer_index_insert(coalescer, i);
+    }
+    return 0;
+}
+
+static terminal_event_record_t *coalescer_find(struct terminal_event_coalescer *coalescer,
+                                               const struct terminal_key *key,
+                                               size_t *pos_out) {
+    if (coalescer->index_capacity == 0) {
+        return NULL;
+    }
+    size_t mask = coalescer->index_capacity - 1U;
+    size_t slot = coalescer_hash(key) & mask;
+    while (coalescer->index[slot] != 0U) {
+        size_t pos = coalescer->index[slot] - 1U;
+        if (coalescer_key_equal(&coalescer->records[pos].key, key)) {
+            *pos_out = pos;
+            return &coalescer->records[pos];
+        }
+        slot = (slot + 1U) & mask;
+    }
+    return NULL;
+}
+
+/* Folds next into the pending net effect at pos. A cancelled slot means the
+ * terminal is back where it was when the window opened, so whatever arrives
+ * next stands on its own. */
+static void coalescer_fold(struct terminal_event_coalescer *coalescer,
+                           size_t pos,
+                           const terminal_event_record_t *next) {
+    terminal_event_record_t *pending = &coalescer->records[pos];
+    if (!coalescer->live[pos]) {
+        *pending = *next;
+        coalescer->live[pos] = true;
+        return;
+    }
+
+    switch (pending->tag) {
+    case TERMINAL_EVENT_TAG_ADD:
+        if (next->tag == TERMINAL_EVENT_TAG_DEL) {
+            coalescer->live[pos] = false;
+        } else {
+            pending->ifindex = next->ifindex;
+        }
+        break;
+    case TERMINAL_EVENT_TAG_MOD:
+        if (next->tag == TERMINAL_EVENT_TAG_DEL) {
+            *pending = *next;
+        } else {
+            pending->ifindex = next->ifindex;
+            if (pending->ifindex == pending->prev_ifindex) {
+                coalescer->live[pos] = false;
+            }
+        }
+        break;
+    case TERMINAL_EVENT_TAG_DEL:
+    default:
+        if (next->tag == TERMINAL_EVENT_TAG_DEL) {
+            *pending = *next;
+        } else if (next->tag == TERMINAL_EVENT_TAG_ADD) {
+            if (next->ifindex == pending->ifindex) {
+                coalescer->live[pos] = false;
+            } else {
+                uint32_t prev_ifindex = pending->ifindex;
+                *pending = *next;
+                pending->tag = TERMINAL_EVENT_TAG_MOD;
+                pending->prev_ifindex = prev_ifindex;
+            }
+        } else {
+            *pending = *next;
+        }
+        break;
+    }
+    pending->seq = next->seq;
+}
+
+int terminal_event_coalescer_add(struct terminal_event_coalescer *coalescer,
+                                 const terminal_event_record_t *record,
+                                 bool *merged) {
+    if (!coalescer || !record) {
+        return -EINVAL;
+    }
+
+    size_t pos = 0;
+    if (coalescer_find(coalescer, &record->key, &pos)) {
+        coalescer_fold(coalescer, pos, record);
+        if (merged) {
+            *merged = true;
+        }
+        return 0;
+    }
+
+    if (coalescer->count == coalescer->capacity) {
+        int rc = coalescer_grow(coalescer);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    pos = coalescer->count++;
+    coalescer->records[pos] = *record;
+    coalescer->live[pos] = true;
+    coalescer_index_insert(coalescer, pos);
+    if (merged) {
+        *merged = false;
+    }
+    return 0;
+}
+
+size_t terminal_event_coalescer_compact(struct terminal_event_coalescer *coalescer) {
+    if (!coalescer) {
+        return 0;
+    }
+
+    size_t out = 0;
+    for (size_t i = 0; i < coalescer->count; ++i) {
+        if (!coalescer->live[i]) {
+            continue;
+        }
+        if (out != i) {
+            coalescer->records[out] = coalescer->records[i];
+        }
+        coalescer->live[out] = true;
+        ++out;
+    }
+    /* The index now points at stale positions; only reset may follow. */
+    coalescer->count = out;
+    return out;
+}
+
+void terminal_event_coalescer_reset(struct terminal_event_coalescer *coalescer) {
+    if (!coalescer) {
+        return;
+    }
+    coalescer->count = 0;
+    if (coalescer->index) {
+        memset(coalescer->index, 0, coalescer->index_capacity * sizeof(*coalescer->index));
+    }
+}
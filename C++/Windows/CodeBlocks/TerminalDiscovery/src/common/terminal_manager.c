@@ -15,12 +15,126 @@
 #include <time.h>
 
 #include "td_logging.h"
+#include "td_object_pool.h"
+#include "terminal_event_ring.h"
 #include "td_time_utils.h"
 
 #ifndef TERMINAL_BUCKET_COUNT
 #define TERMINAL_BUCKET_COUNT 256
 #endif
 
+#ifndef TERMINAL_SHARD_COUNT
+#define TERMINAL_SHARD_COUNT 16
+#endif
+
+#if (TERMINAL_BUCKET_COUNT % TERMINAL_SHARD_COUNT) != 0
+#error "TERMINAL_BUCKET_COUNT must be a multiple of TERMINAL_SHARD_COUNT"
+#endif
+
+#define TERMINAL_SHARD_BUCKETS (TERMINAL_BUCKET_COUNT / TERMINAL_SHARD_COUNT)
+
+#ifndef TERMINAL_TABLE_INITIAL_SLOTS
+#define TERMINAL_TABLE_INITIAL_SLOTS 16U
+#endif
+
+#ifndef TD_IFACE_INDEX_INITIAL_SLOTS
+#define TD_IFACE_INDEX_INITIAL_SLOTS 16U
+#endif
+
+#if (TD_IFACE_INDEX_INITIAL_SLOTS & (TD_IFACE_INDEX_INITIAL_SLOTS - 1U)) != 0
+#error "TD_IFACE_INDEX_INITIAL_SLOTS must be a power of two"
+#endif
+
+#ifndef TERMINAL_IFINDEX_INDEX_BUCKETS
+#define TERMINAL_IFINDEX_INDEX_BUCKETS 256U
+#endif
+
+#if (TERMINAL_IFINDEX_INDEX_BUCKETS & (TERMINAL_IFINDEX_INDEX_BUCKETS - 1U)) != 0
+#error "TERMINAL_IFINDEX_INDEX_BUCKETS must be a power of two"
+#endif
+
+#ifndef TERMINAL_POINT_INDEX_INITIAL_BUCKETS
+#define TERMINAL_POINT_INDEX_INITIAL_BUCKETS 16U
+#endif
+
+#if (TERMINAL_POINT_INDEX_INITIAL_BUCKETS & (TERMINAL_POINT_INDEX_INITIAL_BUCKETS - 1U)) != 0
+#error "TERMINAL_POINT_INDEX_INITIAL_BUCKETS must be a power of two"
+#endif
+
+/* Matches a point lookup copies out on the stack before spilling to heap. */
+#ifndef TERMINAL_LOOKUP_LOCAL_RECORDS
+#define TERMINAL_LOOKUP_LOCAL_RECORDS 8U
+#endif
+
+#ifndef TERMINAL_TABLE_MIGRATE_STEP
+#define TERMINAL_TABLE_MIGRATE_STEP 32U
+#endif
+
+/* MAC lookup batches up to this size are built on the stack; longer ones
+ * use the manager's lookup_batch scratch arrays. */
+#ifndef TERMINAL_MAC_LOOKUP_LOCAL_BATCH
+#define TERMINAL_MAC_LOOKUP_LOCAL_BATCH 16U
+#endif
+
+/* Packets on_packet_batch sorts by shard at a time, on the stack. */
+#ifndef TERMINAL_INGEST_BATCH_CHUNK
+#define TERMINAL_INGEST_BATCH_CHUNK 64U
+#endif
+
+/* Live RTM_DELLINKs remembered while a link dump is in flight; past this the
+ * dump is not trusted and mark_ready leaves the cache on the ioctl path. */
+#ifndef TERMINAL_LINK_RESYNC_DELETED_MAX
+#define TERMINAL_LINK_RESYNC_DELETED_MAX 64U
+#endif
+
+#if (TERMINAL_TABLE_INITIAL_SLOTS & (TERMINAL_TABLE_INITIAL_SLOTS - 1U)) != 0
+#error "TERMINAL_TABLE_INITIAL_SLOTS must be a power of two"
+#endif
+
+/* Hierarchical timer wheel with one-second ticks: level n slots span
+ * 64^n seconds, so four levels cover about 194 days. */
+#define TERMINAL_WHEEL_BITS 6U
+#define TERMINAL_WHEEL_SLOTS (1U << TERMINAL_WHEEL_BITS)
+#define TERMINAL_WHEEL_MASK ((uint64_t)TERMINAL_WHEEL_SLOTS - 1U)
+#define TERMINAL_WHEEL_LEVELS 4U
+#define TERMINAL_WHEEL_SPAN (1ULL << (TERMINAL_WHEEL_BITS * TERMINAL_WHEEL_LEVELS))
+
+#ifndef TERMINAL_POOL_SLAB_OBJECTS
+#define TERMINAL_POOL_SLAB_OBJECTS 64U
+#endif
+
+#ifndef TERMINAL_EVENT_RING_DEFAULT_SIZE
+#define TERMINAL_EVENT_RING_DEFAULT_SIZE 1024U
+#endif
+
+#ifndef TERMINAL_EVENT_JOURNAL_DEFAULT_SIZE
+#define TERMINAL_EVENT_JOURNAL_DEFAULT_SIZE 4096U
+#endif
+
+/* Longest a producer waits, after dropping every manager lock, for the
+ * dispatcher to drain a ring the backpressure policy found full. A wait that
+ * runs out latches the stall, and producers stop waiting until the
+ * dispatcher has caught up. */
+#ifndef TERMINAL_EVENT_BACKPRESSURE_MAX_MS
+#define TERMINAL_EVENT_BACKPRESSURE_MAX_MS 50U
+#endif
+
+/* The dispatcher re-polls the ring at this period even without a wakeup. */
+#ifndef TERMINAL_EVENT_DISPATCH_IDLE_MS
+#define TERMINAL_EVENT_DISPATCH_IDLE_MS 100U
+#endif
+
+/* event_backpressure: the ring filled under the backpressure policy and
+ * producers should wait (outside every manager lock) for the dispatcher, or
+ * such a wait already timed out and producers only spill until it drains. */
+#define TERMINAL_BACKPRESSURE_NONE 0
+#define TERMINAL_BACKPRESSURE_SATURATED 1
+#define TERMINAL_BACKPRESSURE_STALLED 2
+
+/* A shard table grows once it would be more than 7/8 full. */
+#define TERMINAL_TABLE_LOAD_NUM 7U
+#define TERMINAL_TABLE_LOAD_DEN 8U
+
 #ifndef TERMINAL_SCAN_INTERVAL_DEFAULT_MS
 #define TERMINAL_SCAN_INTERVAL_DEFAULT_MS 1000U
 #endif
@@ -45,17 +159,6 @@
 #define TERMINAL_DEFAULT_MAX_TERMINALS 1000U
 #endif
 
-struct terminal_event_node {
-    terminal_event_record_t record;
-    struct terminal_event_node *next;
-};
-
-struct terminal_event_queue {
-    struct terminal_event_node *head;
-    struct terminal_event_node *tail;
-    size_t size;
-};
-
 struct probe_task {
     terminal_probe_request_t request;
     struct probe_task *next;
@@ -63,11 +166,13 @@ struct probe_task {
 
 struct mac_lookup_task {
     struct terminal_key key;
+    uint64_t hash; /* hash_key(&key), picks the shard results apply under */
     int vlan_id;
     bool verify;
     struct mac_lookup_task *next;
 };
 
+/* Kept longest prefix first, so the first match is the longest match. */
 struct iface_prefix_entry {
     struct in_addr network;
     struct in_addr address;
@@ -75,16 +180,13 @@ struct iface_prefix_entry {
     struct iface_prefix_entry *next;
 };
 
-struct iface_binding_entry {
-    struct terminal_entry *terminal;
-    struct iface_binding_entry *next;
-};
-
 struct iface_record {
     int kernel_ifindex;
+    uint64_t generation; /* changes whenever prefixes or the VLAN link behind it do */
     struct iface_prefix_entry *prefixes;
-    struct iface_binding_entry *bindings;
+    struct terminal_entry *bindings; /* linked through binding_next/binding_pprev */
     struct iface_record *next;
+    struct iface_record **pprev;
 };
 
 #ifndef TD_PENDING_VLAN_CAPACITY
@@ -99,13 +201,27 @@ struct iface_record {
 #define TD_MAX_VLAN_ID 4094
 #endif
 
-struct pending_vlan_entry {
-    struct terminal_entry *terminal;
-    struct pending_vlan_entry *next;
+struct pending_vlan_bucket {
+    struct terminal_entry *head; /* linked through pending_next/pending_pprev */
+};
+
+/* Ring of the newest events in sequence order; count reaches capacity and
+ * then each append overwrites the oldest record. */
+struct terminal_event_journal {
+    terminal_event_record_t *records;
+    size_t capacity;
+    size_t head; /* next slot written */
+    size_t count;
 };
 
-struct pending_vlan_bucket {
-    struct pending_vlan_entry *head;
+/* Immutable copy of the northbound view (key + ifindex per terminal). Once
+ * published it is never written again; refs counts the published slot plus
+ * every query still walking it. */
+struct terminal_view_snapshot {
+    uint64_t version;
+    size_t refs; /* guarded by view_lock */
+    size_t count;
+    terminal_event_record_t records[];
 };
 
 static pthread_mutex_t g_active_manager_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -114,6 +230,7 @@ static struct terminal_manager *g_active_manager = NULL;
 static void bind_active_manager(struct terminal_manager *mgr);
 static void unbind_active_manager(struct terminal_manager *mgr);
 static void mac_locator_on_refresh(uint64_t version, void *ctx);
+static void mac_locator_on_delta(const struct td_adapter_mac_delta_batch *batch, void *ctx);
 static void terminal_manager_run_address_sync(struct terminal_manager *mgr);
 static bool vlan_is_ignored(const struct terminal_manager *mgr, int vlan_id);
 static void format_ignored_vlan_array(const uint16_t *vlans,
@@ -128,6 +245,48 @@ struct terminal_manager *terminal_manager_get_active(void) {
     return mgr;
 }
 
+/* fingerprint is the upper half of the key hash and is never 0, so an empty
+ * slot has fingerprint 0. A slot with a fingerprint but no entry is a
+ * tombstone; those only exist in a table that is being drained. */
+struct terminal_slot {
+    uint32_t fingerprint;
+    struct terminal_entry *entry;
+};
+
+/* Robin Hood open-addressed table for one shard. Entries stay individually
+ * allocated so bindings and pending lists can keep pointing at them. Growth
+ * allocates a table twice the size and drains the previous one
+ * TERMINAL_TABLE_MIGRATE_STEP slots per operation; until it is empty,
+ * lookups fall back to old_slots, which only ever gains tombstones. */
+struct terminal_table {
+    struct terminal_slot *slots;
+    size_t capacity;            /* power of two; 0 until the first insert */
+    size_t size;                /* live entries across slots and old_slots */
+    struct terminal_slot *old_slots;
+    size_t old_capacity;
+    size_t migrate_pos;         /* old_slots below this index are drained */
+};
+
+/* Chained hash index over the entries by one part of their key (MAC or
+ * IPv4). Entries are linked through the terminal_index_link at link_offset.
+ * Buckets are grown by reserve before an insert would push the load factor
+ * past one, so chains stay short and linking never allocates. */
+struct terminal_point_index {
+    struct terminal_entry **buckets;
+    size_t capacity;    /* power of two; 0 until the first reserve */
+    size_t count;
+    size_t link_offset; /* offsetof(struct terminal_entry, <link>) */
+    uint64_t (*entry_hash)(const struct terminal_entry *entry);
+};
+
+/* Per-shard keepalive/holdoff deadlines. Entries are linked through
+ * timer_next/timer_pprev; now_sec is the last tick handed out, so every
+ * scheduled deadline is later than it. */
+struct terminal_timer_wheel {
+    uint64_t now_sec;
+    struct terminal_entry *slots[TERMINAL_WHEEL_LEVELS][TERMINAL_WHEEL_SLOTS];
+};
+
 struct terminal_manager {
     struct terminal_manager_config cfg;
     td_adapter_t *adapter;
@@ -136,8 +295,14 @@ struct terminal_manager {
     terminal_probe_fn probe_cb;
     void *probe_ctx;
 
+    /* Lock order: shard locks (ascending) before lock. Each shard lock guards
+     * the table holding the entries of its contiguous run of hash buckets;
+     * lock guards everything shared (iface records, pending VLANs, queues,
+     * events, stats, cfg). */
     pthread_mutex_t lock;
-    struct terminal_entry *table[TERMINAL_BUCKET_COUNT];
+    pthread_mutex_t shard_locks[TERMINAL_SHARD_COUNT];
+    struct terminal_table tables[TERMINAL_SHARD_COUNT];
+    struct terminal_timer_wheel timer_wheels[TERMINAL_SHARD_COUNT]; /* guarded by the shard lock */
 
     pthread_mutex_t worker_lock;
     pthread_cond_t worker_cond;
@@ -145,30 +310,113 @@ struct terminal_manager {
     bool worker_started;
     pthread_t worker_thread;
 
+    /* Event pipeline: producers push into event_ring while holding lock and
+     * the dispatcher thread drains it into the sink without any manager lock
+     * held, so a slow sink never stalls ingest. event_cb is what producers
+     * check (under lock); dispatch_cb is what the dispatcher calls (under
+     * dispatch_lock). */
     terminal_event_callback_fn event_cb;
     void *event_cb_ctx;
-    struct terminal_event_queue events;
+    struct terminal_event_ring event_ring;
+    pthread_mutex_t overflow_lock;
+    struct terminal_event_coalescer event_overflow;       /* COALESCE spill, guarded by overflow_lock */
+    struct terminal_event_coalescer event_overflow_spare; /* owned by the drainer */
+    bool event_overflow_active;                            /* atomic; producers spill while set */
+    size_t event_drops;                                    /* atomic */
+    size_t event_coalesced;                                /* atomic */
+    size_t event_backpressure_waits;                       /* atomic */
+    int event_backpressure;                                /* atomic; TERMINAL_BACKPRESSURE_* */
+
+    pthread_mutex_t drain_lock; /* serialises drains and owns dispatch_records/event_window */
+    terminal_event_record_t *dispatch_records;
+    size_t dispatch_capacity;
+    struct terminal_event_coalescer event_window; /* per-key net effect when cfg.event_window_ms > 0 */
+
+    pthread_mutex_t dispatch_lock;
+    pthread_cond_t dispatch_cond; /* wakes the dispatcher */
+    pthread_cond_t flush_cond;    /* flush_completed advanced */
+    terminal_event_callback_fn dispatch_cb;
+    void *dispatch_cb_ctx;
+    uint64_t flush_requested;
+    uint64_t flush_completed;
+    uint64_t events_dispatched;
+    uint64_t event_dispatch_failures;
+    uint64_t events_coalesced;
+    bool dispatch_stop;
+    bool dispatch_started;
+    bool dispatch_idle; /* atomic; dispatcher is parked on dispatch_cond */
+    pthread_t dispatch_thread;
+
+    /* Hot-path nodes come from per-manager pools instead of the heap. */
+    struct td_object_pool entry_pool;
+    struct td_object_pool lookup_task_pool;
+    struct td_object_pool probe_task_pool;
+
     size_t terminal_count;
     size_t max_terminals;
     struct terminal_manager_stats stats;
-    struct iface_record *iface_records;
+    struct iface_record *iface_records;        /* creation order, for walks */
+    struct iface_record **iface_records_tail;
+    struct iface_record **iface_index;         /* open-addressed by kernel ifindex */
+    size_t iface_index_capacity;               /* power of two; 0 until the first record */
+    size_t iface_record_count;
+    uint64_t iface_generation_seq; /* last value handed to an iface_record */
     struct pending_vlan_bucket pending_vlans[TD_PENDING_VLAN_CAPACITY];
+    /* Kernel ifindex of each VLAN's cfg.vlan_iface_format interface (0 = none),
+     * maintained from netlink link events. Only trusted once vlan_links_ready;
+     * until then lookups fall back to if_nametoindex/if_indextoname. */
+    int vlan_link_ifindex[TD_MAX_VLAN_ID + 1];
+    bool vlan_links_ready;
+    /* Between reset_link_cache and mark_ready: ifindexes removed by live
+     * events, whose (possibly older) dump replies must not re-add them. */
+    bool link_resync_active;
+    bool link_resync_overflow;
+    size_t link_resync_deleted_count;
+    int link_resync_deleted[TERMINAL_LINK_RESYNC_DELETED_MAX];
+    /* Mirror of cfg.ignored_vlans indexed by VLAN id, written under lock and
+     * read atomically so packet ingest can filter without taking it. */
+    bool vlan_ignored[TD_MAX_VLAN_ID + 1];
+    /* Secondary indexes over the table for query_filtered: entries chained
+     * by meta.ifindex bucket and by meta.vlan_id. */
+    struct terminal_entry *ifindex_index[TERMINAL_IFINDEX_INDEX_BUCKETS];
+    struct terminal_entry *vlan_index[TD_MAX_VLAN_ID + 1];
+    /* Point-lookup indexes by key.mac and key.ip, guarded by lock. */
+    struct terminal_point_index mac_index;
+    struct terminal_point_index ip_index;
     struct mac_lookup_task *mac_need_refresh_head;
     struct mac_lookup_task *mac_need_refresh_tail;
     struct mac_lookup_task *mac_pending_verify_head;
     struct mac_lookup_task *mac_pending_verify_tail;
-    uint64_t mac_locator_version;
+    /* Scratch for lookup_batch calls too long for the stack, grown on
+     * demand; lookup_batch_lock is taken before any shard lock. */
+    pthread_mutex_t lookup_batch_lock;
+    struct td_adapter_mac_lookup *lookup_batch_requests;
+    struct mac_lookup_task **lookup_batch_tasks;
+    size_t lookup_batch_capacity;
+    uint64_t mac_locator_version; /* written under lock; atomic for ingest */
     bool mac_locator_subscribed;
     bool destroying;
     terminal_address_sync_fn address_sync_cb;
     void *address_sync_ctx;
     bool address_sync_pending;
     bool address_sync_in_progress;
+
+    /* Every insert, removal and ifindex change queues exactly one event, and
+     * queue_event runs with the entry's shard lock and lock held. event_seq is
+     * the last sequence number handed out, so holding every shard lock gives a
+     * stable (table, event_seq) pair; that pair versions view_snapshot. The
+     * newest events are kept in event_journal for query_since. view_dirty is
+     * set with each event and cleared when a snapshot is rebuilt; queries that
+     * find it clear reuse view_snapshot without taking any shard lock. */
+    uint64_t event_seq;
+    struct terminal_event_journal event_journal; /* guarded by lock */
+    bool view_dirty; /* atomic */
+    pthread_mutex_t view_lock;
+    struct terminal_view_snapshot *view_snapshot;
 };
 
 static bool is_iface_available(const struct terminal_entry *entry);
 static void snapshot_from_entry(const struct terminal_entry *entry, terminal_snapshot_t *snapshot);
-static void event_queue_push(struct terminal_event_queue *queue, struct terminal_event_node *node);
 static void queue_event(struct terminal_manager *mgr,
                         terminal_event_tag_t tag,
                         const struct terminal_key *key,
@@ -181,10 +429,8 @@ static void queue_remove_event(struct terminal_manager *mgr,
 static void queue_modify_event_if_ifindex_changed(struct terminal_manager *mgr,
                                                   const terminal_snapshot_t *before,
                                                   const struct terminal_entry *entry);
-static void free_event_queue(struct terminal_event_queue *queue);
 static void terminal_manager_maybe_dispatch_events(struct terminal_manager *mgr);
 static void set_state(struct terminal_entry *entry, terminal_state_t new_state);
-static struct iface_record **find_iface_record_slot(struct terminal_manager *mgr, int kernel_ifindex);
 static struct iface_record *get_iface_record(struct terminal_manager *mgr, int kernel_ifindex);
 static bool iface_record_matches_ip(const struct iface_record *record, struct in_addr ip);
 static bool iface_record_select_ip(const struct iface_record *record,
@@ -198,7 +444,7 @@ static void iface_binding_detach(struct terminal_manager *mgr,
                                  struct terminal_entry *entry);
 static bool resolve_tx_interface(struct terminal_manager *mgr,
                                  struct terminal_entry *entry);
-static void iface_record_prune_if_empty(struct iface_record **slot_ref);
+static void iface_record_prune_if_empty(struct terminal_manager *mgr, struct iface_record *record);
 static struct in_addr prefix_network(struct in_addr address, uint8_t prefix_len);
 static bool ip_matches_prefix(struct in_addr ip,
                               struct in_addr network,
@@ -439,7 +685,7 @@ static void unbind_active_manager(struct terminal_manager *mgr) {
     pthread_mutex_unlock(&g_active_manager_mutex);
 }
 
-static size_t hash_key(const struct terminal_key *key) {
+static uint64_t hash_key(const struct terminal_key *key) {
     uint64_t hash = 1469598103934665603ULL;
     for (size_t i = 0; i < ETH_ALEN; ++i) {
         hash ^= key->mac[i];
@@ -450,20 +696,378 @@ static size_t hash_key(const struct terminal_key *key) {
         hash ^= ip_bytes[i];
         hash *= 1099511628211ULL;
     }
-    return (size_t)hash;
+    return hash;
+}
+
+static size_t bucket_for_key(const struct terminal_key *key) {
+    return (size_t)(hash_key(key) % TERMINAL_BUCKET_COUNT);
+}
+
+static size_t shard_for_hash(uint64_t hash) {
+    return (size_t)(hash % TERMINAL_BUCKET_COUNT) / TERMINAL_SHARD_BUCKETS;
+}
+
+static pthread_mutex_t *shard_lock_for_hash(struct terminal_manager *mgr, uint64_t hash) {
+    return &mgr->shard_locks[shard_for_hash(hash)];
+}
+
+static struct terminal_table *table_for_hash(struct terminal_manager *mgr, uint64_t hash) {
+    return &mgr->tables[shard_for_hash(hash)];
+}
+
+static void lock_all_shards(struct terminal_manager *mgr) {
+    for (size_t i = 0; i < TERMINAL_SHARD_COUNT; ++i) {
+        pthread_mutex_lock(&mgr->shard_locks[i]);
+    }
+}
+
+static void unlock_all_shards(struct terminal_manager *mgr) {
+    for (size_t i = TERMINAL_SHARD_COUNT; i > 0; --i) {
+        pthread_mutex_unlock(&mgr->shard_locks[i - 1U]);
+    }
+}
+
+/* The shard is picked from the low hash bits, so slot placement uses the
+ * independent upper half. */
+static uint32_t terminal_fingerprint(uint64_t hash) {
+    uint32_t fingerprint = (uint32_t)(hash >> 32);
+    return fingerprint ? fingerprint : 1U;
+}
+
+static size_t terminal_slot_distance(uint32_t fingerprint, size_t index, size_t mask) {
+    return (index - ((size_t)fingerprint & mask)) & mask;
+}
+
+static size_t terminal_slots_probe(const struct terminal_slot *slots,
+                                   size_t capacity,
+                                   uint32_t fingerprint,
+                                   const struct terminal_key *key) {
+    if (!slots) {
+        return SIZE_MAX;
+    }
+
+    size_t mask = capacity - 1U;
+    size_t index = (size_t)fingerprint & mask;
+    for (size_t dist = 0; dist < capacity; ++dist) {
+        const struct terminal_slot *slot = &slots[index];
+        if (slot->fingerprint == 0 ||
+            terminal_slot_distance(slot->fingerprint, index, mask) < dist) {
+            return SIZE_MAX;
+        }
+        if (slot->fingerprint == fingerprint && slot->entry &&
+            memcmp(slot->entry->key.mac, key->mac, ETH_ALEN) == 0 &&
+            slot->entry->key.ip.s_addr == key->ip.s_addr) {
+            return index;
+        }
+        index = (index + 1U) & mask;
+    }
+    return SIZE_MAX;
+}
+
+/* Caller guarantees a free slot. */
+static void terminal_slots_place(struct terminal_slot *slots,
+                                 size_t capacity,
+                                 uint32_t fingerprint,
+                                 struct terminal_entry *entry) {
+    size_t mask = capacity - 1U;
+    size_t index = (size_t)fingerprint & mask;
+    size_t dist = 0;
+    struct terminal_slot carry = {fingerprint, entry};
+
+    for (;;) {
+        struct terminal_slot *slot = &slots[index];
+        if (slot->fingerprint == 0) {
+            *slot = carry;
+            return;
+        }
+        size_t resident = terminal_slot_distance(slot->fingerprint, index, mask);
+        if (resident < dist) {
+            struct terminal_slot tmp = *slot;
+            *slot = carry;
+            carry = tmp;
+            dist = resident;
+        }
+        index = (index + 1U) & mask;
+        dist += 1U;
+    }
+}
+
+/* A moved entry leaves a tombstone (fingerprint kept, entry cleared) so
+ * old_slots never points at an entry that may since have been freed, while
+ * probes through it still reach entries further along. */
+static void terminal_table_migrate(struct terminal_table *table, size_t budget) {
+    if (!table->old_slots) {
+        return;
+    }
+
+    while (budget > 0 && table->migrate_pos < table->old_capacity) {
+        struct terminal_slot *slot = &table->old_slots[table->migrate_pos++];
+        if (slot->entry) {
+            terminal_slots_place(table->slots, table->capacity, slot->fingerprint, slot->entry);
+            slot->entry = NULL;
+        }
+        budget -= 1U;
+    }
+
+    if (table->migrate_pos >= table->old_capacity) {
+        free(table->old_slots);
+        table->old_slots = NULL;
+        table->old_capacity = 0;
+        table->migrate_pos = 0;
+    }
+}
+
+/* Full walks call this first so they only have to look at slots. */
+static void terminal_table_finish_migration(struct terminal_table *table) {
+    terminal_table_migrate(table, SIZE_MAX);
+}
+
+static struct terminal_entry *terminal_table_find(struct terminal_table *table,
+                                                  const struct terminal_key *key,
+                                                  uint64_t hash) {
+    terminal_table_migrate(table, TERMINAL_TABLE_MIGRATE_STEP);
+
+    uint32_t fingerprint = terminal_fingerprint(hash);
+    size_t index = terminal_slots_probe(table->slots, table->capacity, fingerprint, key);
+    if (index != SIZE_MAX) {
+        return table->slots[index].entry;
+    }
+    index = terminal_slots_probe(table->old_slots, table->old_capacity, fingerprint, key);
+    if (index != SIZE_MAX) {
+        return table->old_slots[index].entry;
+    }
+    return NULL;
+}
+
+/* Makes room for one more entry so the following insert cannot fail. */
+static int terminal_table_reserve(struct terminal_table *table) {
+    if ((table->size + 1U) * TERMINAL_TABLE_LOAD_DEN <= table->capacity * TERMINAL_TABLE_LOAD_NUM) {
+        return 0;
+    }
+
+    size_t capacity = table->capacity ? table->capacity * 2U : TERMINAL_TABLE_INITIAL_SLOTS;
+    struct terminal_slot *slots = calloc(capacity, sizeof(*slots));
+    if (!slots) {
+        return table->size + 1U < table->capacity ? 0 : -ENOMEM;
+    }
+
+    /* Only one table is ever being drained. */
+    terminal_table_finish_migration(table);
+    table->old_slots = table->slots;
+    table->old_capacity = table->capacity;
+    table->migrate_pos = 0;
+    table->slots = slots;
+    table->capacity = capacity;
+    if (!table->old_slots) {
+        table->old_capacity = 0;
+    }
+    return 0;
+}
+
+static void terminal_table_insert(struct terminal_table *table,
+                                  struct terminal_entry *entry,
+                                  uint64_t hash) {
+    terminal_slots_place(table->slots, table->capacity, terminal_fingerprint(hash), entry);
+    table->size += 1U;
+}
+
+/* Backward-shift delete from slots; the drained table only gets tombstones
+ * so its probe sequences stay intact. */
+static void terminal_table_remove(struct terminal_table *table,
+                                  const struct terminal_entry *entry,
+                                  uint64_t hash) {
+    uint32_t fingerprint = terminal_fingerprint(hash);
+    size_t index = terminal_slots_probe(table->slots, table->capacity, fingerprint, &entry->key);
+    if (index == SIZE_MAX) {
+        index = terminal_slots_probe(table->old_slots, table->old_capacity, fingerprint, &entry->key);
+        if (index == SIZE_MAX) {
+            return;
+        }
+        table->old_slots[index].entry = NULL;
+    } else {
+        size_t mask = table->capacity - 1U;
+        for (;;) {
+            size_t next = (index + 1U) & mask;
+            struct terminal_slot *slot = &table->slots[next];
+            if (slot->fingerprint == 0 || terminal_slot_distance(slot->fingerprint, next, mask) == 0) {
+                break;
+            }
+            table->slots[index] = *slot;
+            index = next;
+        }
+        table->slots[index].fingerprint = 0;
+        table->slots[index].entry = NULL;
+    }
+
+    if (table->size > 0) {
+        table->size -= 1U;
+    }
+}
+
+static void terminal_table_free(struct terminal_manager *mgr, struct terminal_table *table) {
+    terminal_table_finish_migration(table);
+    for (size_t i = 0; i < table->capacity; ++i) {
+        td_object_pool_free(&mgr->entry_pool, table->slots[i].entry);
+    }
+    free(table->slots);
+    memset(table, 0, sizeof(*table));
+}
+
+static void timer_unlink(struct terminal_entry *entry) {
+    if (!entry->timer_pprev) {
+        return;
+    }
+    *entry->timer_pprev = entry->timer_next;
+    if (entry->timer_next) {
+        entry->timer_next->timer_pprev = entry->timer_pprev;
+    }
+    entry->timer_next = NULL;
+    entry->timer_pprev = NULL;
+}
+
+static void timer_link(struct terminal_entry **head, struct terminal_entry *entry) {
+    entry->timer_next = *head;
+    if (*head) {
+        (*head)->timer_pprev = &entry->timer_next;
+    }
+    *head = entry;
+    entry->timer_pprev = head;
+}
+
+/* Caller guarantees timer_deadline >= wheel->now_sec. */
+static void timer_wheel_place(struct terminal_timer_wheel *wheel, struct terminal_entry *entry) {
+    uint64_t delta = entry->timer_deadline - wheel->now_sec;
+    if (delta >= TERMINAL_WHEEL_SPAN) {
+        /* Parked at the edge and re-evaluated when it fires. */
+        entry->timer_deadline = wheel->now_sec + TERMINAL_WHEEL_SPAN - 1U;
+        delta = TERMINAL_WHEEL_SPAN - 1U;
+    }
+
+    unsigned int level = 0;
+    while (level + 1U < TERMINAL_WHEEL_LEVELS &&
+           delta >= (1ULL << (TERMINAL_WHEEL_BITS * (level + 1U)))) {
+        level += 1U;
+    }
+    size_t slot = (size_t)((entry->timer_deadline >> (TERMINAL_WHEEL_BITS * level)) & TERMINAL_WHEEL_MASK);
+    timer_link(&wheel->slots[level][slot], entry);
+}
+
+static void timer_wheel_schedule(struct terminal_timer_wheel *wheel,
+                                 struct terminal_entry *entry,
+                                 uint64_t deadline) {
+    timer_unlink(entry);
+    entry->timer_deadline = deadline > wheel->now_sec ? deadline : wheel->now_sec + 1U;
+    timer_wheel_place(wheel, entry);
+}
+
+/* Advances the wheel to now_sec and moves every entry whose deadline has
+ * passed onto *due. Each tick costs one slot unless a level boundary is
+ * crossed, in which case the next level's slot is redistributed. */
+static void timer_wheel_advance(struct terminal_timer_wheel *wheel,
+                                uint64_t now_sec,
+                                struct terminal_entry **due) {
+    while (wheel->now_sec < now_sec) {
+        wheel->now_sec += 1U;
+        uint64_t tick = wheel->now_sec;
+
+        for (unsigned int level = 1; level < TERMINAL_WHEEL_LEVELS; ++level) {
+            if (((tick >> (TERMINAL_WHEEL_BITS * (level - 1U))) & TERMINAL_WHEEL_MASK) != 0) {
+                break;
+            }
+            size_t slot = (size_t)((tick >> (TERMINAL_WHEEL_BITS * level)) & TERMINAL_WHEEL_MASK);
+            struct terminal_entry *entry = wheel->slots[level][slot];
+            wheel->slots[level][slot] = NULL;
+            while (entry) {
+                struct terminal_entry *next = entry->timer_next;
+                entry->timer_pprev = NULL;
+                entry->timer_next = NULL;
+                timer_wheel_place(wheel, entry);
+                entry = next;
+            }
+        }
+
+        struct terminal_entry **slot = &wheel->slots[0][tick & TERMINAL_WHEEL_MASK];
+        while (*slot) {
+            struct terminal_entry *entry = *slot;
+            timer_unlink(entry);
+            timer_link(due, entry);
+        }
+    }
+}
+
+/* Earliest second at which terminal_manager_on_timer has work for entry:
+ * the next keepalive probe, the IFACE_INVALID holdoff expiry, or the next
+ * tick while an IFACE_INVALID entry is retrying MAC lookups. */
+static uint64_t timer_deadline_for_entry(const struct terminal_entry *entry,
+                                         unsigned int keepalive_interval_sec,
+                                         unsigned int holdoff_sec,
+                                         bool retry_lookups) {
+    uint64_t deadline = (uint64_t)entry->last_seen.tv_sec + keepalive_interval_sec;
+    if (entry->last_probe.tv_sec) {
+        uint64_t probe_due = (uint64_t)entry->last_probe.tv_sec + keepalive_interval_sec;
+        if (probe_due > deadline) {
+            deadline = probe_due;
+        }
+    }
+    if (entry->state == TERMINAL_STATE_IFACE_INVALID) {
+        if (retry_lookups) {
+            return 0;
+        }
+        uint64_t expiry = (uint64_t)entry->last_seen.tv_sec + holdoff_sec;
+        if (expiry < deadline) {
+            deadline = expiry;
+        }
+    }
+    return deadline;
+}
+
+/* Caller holds the entry's shard lock and mgr->lock. Deadlines only move
+ * forward lazily (the entry is re-evaluated when it fires), so this only
+ * pulls an entry in when its state change made it due earlier. */
+static void timer_pull_in(struct terminal_manager *mgr, struct terminal_entry *entry) {
+    struct terminal_timer_wheel *wheel = &mgr->timer_wheels[shard_for_hash(hash_key(&entry->key))];
+    uint64_t deadline = timer_deadline_for_entry(entry,
+                                                 mgr->cfg.keepalive_interval_sec,
+                                                 mgr->cfg.iface_invalid_holdoff_sec,
+                                                 mgr->mac_locator_ops != NULL);
+    if (!entry->timer_pprev || deadline < entry->timer_deadline) {
+        timer_wheel_schedule(wheel, entry, deadline);
+    }
+}
+
+/* Caller holds every shard lock and mgr->lock. */
+static void timer_reschedule_all(struct terminal_manager *mgr) {
+    for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+        struct terminal_table *table = &mgr->tables[shard];
+        terminal_table_finish_migration(table);
+        for (size_t i = 0; i < table->capacity; ++i) {
+            struct terminal_entry *entry = table->slots[i].entry;
+            if (!entry) {
+                continue;
+            }
+            timer_wheel_schedule(&mgr->timer_wheels[shard],
+                                 entry,
+                                 timer_deadline_for_entry(entry,
+                                                          mgr->cfg.keepalive_interval_sec,
+                                                          mgr->cfg.iface_invalid_holdoff_sec,
+                                                          mgr->mac_locator_ops != NULL));
+        }
+    }
 }
 
-static struct mac_lookup_task *mac_lookup_task_create(const struct terminal_key *key,
+static struct mac_lookup_task *mac_lookup_task_create(struct terminal_manager *mgr,
+                                                     const struct terminal_key *key,
                                                      int vlan_id,
                                                      bool verify) {
-    if (!key) {
+    if (!mgr || !key) {
         return NULL;
     }
-    struct mac_lookup_task *task = calloc(1, sizeof(*task));
+    struct mac_lookup_task *task = td_object_pool_alloc(&mgr->lookup_task_pool);
     if (!task) {
         return NULL;
     }
     task->key = *key;
+    task->hash = hash_key(key);
     task->vlan_id = vlan_id;
     task->verify = verify;
     task->next = NULL;
@@ -486,10 +1090,10 @@ static void mac_lookup_task_append_node(struct mac_lookup_task **head,
     }
 }
 
-static void mac_lookup_task_list_free(struct mac_lookup_task *head) {
+static void mac_lookup_task_list_free(struct terminal_manager *mgr, struct mac_lookup_task *head) {
     while (head) {
         struct mac_lookup_task *next = head->next;
-        free(head);
+        td_object_pool_free(&mgr->lookup_task_pool, head);
         head = next;
     }
 }
@@ -501,7 +1105,7 @@ static void enqueue_need_refresh(struct terminal_manager *mgr, struct terminal_e
     if (entry->mac_refresh_enqueued) {
         return;
     }
-    struct mac_lookup_task *task = mac_lookup_task_create(&entry->key, entry->meta.vlan_id, false);
+    struct mac_lookup_task *task = mac_lookup_task_create(mgr, &entry->key, entry->meta.vlan_id, false);
     if (!task) {
         td_log_writef(TD_LOG_WARN,
                       "terminal_manager",
@@ -553,59 +1157,96 @@ static void snapshot_from_entry(const struct terminal_entry *entry, terminal_sna
     snapshot->meta = entry->meta;
 }
 
-static void event_queue_push(struct terminal_event_queue *queue, struct terminal_event_node *node) {
-    if (!queue || !node) {
-        return;
+/* Caller holds mgr->lock. */
+static void event_spill(struct terminal_manager *mgr, const terminal_event_record_t *record) {
+    bool merged = false;
+    pthread_mutex_lock(&mgr->overflow_lock);
+    int rc = terminal_event_coalescer_add(&mgr->event_overflow, record, &merged);
+    if (rc == 0) {
+        __atomic_store_n(&mgr->event_overflow_active, true, __ATOMIC_SEQ_CST);
     }
-    node->next = NULL;
-    if (!queue->head) {
-        queue->head = node;
-        queue->tail = node;
-    } else {
-        queue->tail->next = node;
-        queue->tail = node;
+    pthread_mutex_unlock(&mgr->overflow_lock);
+
+    if (rc != 0) {
+        __atomic_fetch_add(&mgr->event_drops, 1U, __ATOMIC_RELAXED);
+    } else if (merged) {
+        __atomic_fetch_add(&mgr->event_coalesced, 1U, __ATOMIC_RELAXED);
     }
-    queue->size += 1;
 }
 
-static void free_event_queue(struct terminal_event_queue *queue) {
-    if (!queue) {
+static void event_dispatcher_kick(struct terminal_manager *mgr);
+
+/* Caller holds mgr->lock, which also serialises producers: once the overflow
+ * table is in use every record goes there until the dispatcher has drained
+ * the ring ahead of it, so per-key order is preserved across the two. */
+static void event_publish(struct terminal_manager *mgr, const terminal_event_record_t *record) {
+    if (__atomic_load_n(&mgr->event_overflow_active, __ATOMIC_SEQ_CST)) {
+        event_spill(mgr, record);
         return;
     }
-    struct terminal_event_node *node = queue->head;
-    while (node) {
-        struct terminal_event_node *next = node->next;
-        free(node);
-        node = next;
+
+    while (!terminal_event_ring_push(&mgr->event_ring, record)) {
+        switch (mgr->cfg.event_overflow_policy) {
+        case TERMINAL_EVENT_OVERFLOW_DROP_OLDEST:
+            if (terminal_event_ring_pop(&mgr->event_ring, NULL)) {
+                __atomic_fetch_add(&mgr->event_drops, 1U, __ATOMIC_RELAXED);
+            }
+            break;
+        case TERMINAL_EVENT_OVERFLOW_BACKPRESSURE: {
+            /* Never sleep here: the shard lock and lock are held. Spill the
+             * record and let the producer wait once it has unlocked. */
+            int expected = TERMINAL_BACKPRESSURE_NONE;
+            __atomic_compare_exchange_n(&mgr->event_backpressure,
+                                        &expected,
+                                        TERMINAL_BACKPRESSURE_SATURATED,
+                                        false,
+                                        __ATOMIC_SEQ_CST,
+                                        __ATOMIC_SEQ_CST);
+            event_dispatcher_kick(mgr);
+            event_spill(mgr, record);
+            return;
+        }
+        case TERMINAL_EVENT_OVERFLOW_COALESCE:
+        default:
+            event_spill(mgr, record);
+            return;
+        }
     }
-    queue->head = NULL;
-    queue->tail = NULL;
-    queue->size = 0;
 }
 
+static void event_journal_append(struct terminal_event_journal *journal,
+                                 const terminal_event_record_t *record) {
+    journal->records[journal->head] = *record;
+    journal->head = (journal->head + 1U) % journal->capacity;
+    if (journal->count < journal->capacity) {
+        journal->count += 1;
+    }
+}
+
+/* Caller holds the entry's shard lock and mgr->lock. Events are sequenced and
+ * journaled even without a sink so snapshot versions and query_since cursors
+ * stay meaningful; only the ring hand-off needs one. */
 static void queue_event(struct terminal_manager *mgr,
                         terminal_event_tag_t tag,
                         const struct terminal_key *key,
                         const struct terminal_metadata *meta,
                         uint32_t prev_ifindex) {
-    if (!mgr || !mgr->event_cb || !key) {
-        return;
-    }
-    struct terminal_event_node *node = calloc(1, sizeof(*node));
-    if (!node) {
-        td_log_writef(TD_LOG_WARN, "terminal_manager", "failed to allocate event node");
+    if (!mgr || !key) {
         return;
     }
-    memcpy(node->record.key.mac, key->mac, ETH_ALEN);
-    node->record.key.ip = key->ip;
-    if (meta) {
-        node->record.ifindex = meta->ifindex;
-    } else {
-        node->record.ifindex = 0U;
+    terminal_event_record_t record;
+    memset(&record, 0, sizeof(record));
+    memcpy(record.key.mac, key->mac, ETH_ALEN);
+    record.key.ip = key->ip;
+    record.ifindex = meta ? meta->ifindex : 0U;
+    record.prev_ifindex = prev_ifindex;
+    record.tag = tag;
+    record.seq = ++mgr->event_seq;
+    event_journal_append(&mgr->event_journal, &record);
+    __atomic_store_n(&mgr->view_dirty, true, __ATOMIC_RELEASE);
+    if (mgr->event_cb) {
+        event_publish(mgr, &record);
     }
-    node->record.prev_ifindex = prev_ifindex;
-    node->record.tag = tag;
-    event_queue_push(&mgr->events, node);
 }
 
 static void queue_add_event(struct terminal_manager *mgr,
@@ -627,7 +1268,7 @@ static void queue_remove_event(struct terminal_manager *mgr,
 static void queue_modify_event_if_ifindex_changed(struct terminal_manager *mgr,
                                                   const terminal_snapshot_t *before,
                                                   const struct terminal_entry *entry) {
-    if (!mgr || !before || !entry || !mgr->event_cb) {
+    if (!mgr || !before || !entry) {
         return;
     }
     uint32_t before_ifindex = before->meta.ifindex;
@@ -642,83 +1283,267 @@ static void queue_modify_event_if_ifindex_changed(struct terminal_manager *mgr,
                 before_ifindex);
 }
 
-static void terminal_manager_maybe_dispatch_events(struct terminal_manager *mgr) {
-    if (!mgr) {
-        return;
+static void event_deliver(struct terminal_manager *mgr,
+                          const terminal_event_record_t *records,
+                          size_t count) {
+    pthread_mutex_lock(&mgr->dispatch_lock);
+    terminal_event_callback_fn callback = mgr->dispatch_cb;
+    void *callback_ctx = mgr->dispatch_cb_ctx;
+    pthread_mutex_unlock(&mgr->dispatch_lock);
+
+    if (callback) {
+        callback(records, count, callback_ctx);
     }
 
-    struct terminal_event_node *head = NULL;
-    size_t count = 0;
+    pthread_mutex_lock(&mgr->dispatch_lock);
+    if (callback) {
+        mgr->events_dispatched += count;
+    } else {
+        mgr->event_dispatch_failures += 1;
+    }
+    pthread_mutex_unlock(&mgr->dispatch_lock);
+}
 
-    pthread_mutex_lock(&mgr->lock);
+/* Moves the overflow table to the spare slot for the drainer. */
+static struct terminal_event_coalescer *event_take_overflow(struct terminal_manager *mgr) {
+    pthread_mutex_lock(&mgr->overflow_lock);
+    struct terminal_event_coalescer spilled = mgr->event_overflow;
+    mgr->event_overflow = mgr->event_overflow_spare;
+    mgr->event_overflow_spare = spilled;
+    __atomic_store_n(&mgr->event_overflow_active, false, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&mgr->overflow_lock);
+    return &mgr->event_overflow_spare;
+}
 
-    if (!mgr->event_cb) {
-        if (mgr->events.size > 0) {
-            mgr->stats.event_dispatch_failures += 1;
-        }
-        free_event_queue(&mgr->events);
-        pthread_mutex_unlock(&mgr->lock);
-        return;
+/* Caller holds drain_lock. Delivers the window's net effect; folded is how
+ * many records went into it. */
+static void event_window_deliver(struct terminal_manager *mgr, size_t folded) {
+    struct terminal_event_coalescer *window = &mgr->event_window;
+    size_t remaining = terminal_event_coalescer_compact(window);
+    if (remaining > 0) {
+        event_deliver(mgr, window->records, remaining);
     }
+    terminal_event_coalescer_reset(window);
 
-    if (!mgr->events.head) {
-        pthread_mutex_unlock(&mgr->lock);
-        return;
+    if (folded > remaining) {
+        pthread_mutex_lock(&mgr->dispatch_lock);
+        mgr->events_coalesced += folded - remaining;
+        pthread_mutex_unlock(&mgr->dispatch_lock);
     }
+}
 
-    head = mgr->events.head;
-    count = mgr->events.size;
-    mgr->events.head = NULL;
-    mgr->events.tail = NULL;
-    mgr->events.size = 0;
-    terminal_event_callback_fn callback = mgr->event_cb;
-    void *callback_ctx = mgr->event_cb_ctx;
+static void event_window_fold(struct terminal_manager *mgr,
+                              const terminal_event_record_t *record,
+                              size_t *folded) {
+    if (terminal_event_coalescer_add(&mgr->event_window, record, NULL) == 0) {
+        *folded += 1U;
+        return;
+    }
+    /* Out of memory: keep ordering by flushing what we have first. */
+    event_window_deliver(mgr, *folded);
+    *folded = 0;
+    event_deliver(mgr, record, 1);
+}
 
-    pthread_mutex_unlock(&mgr->lock);
+/* Caller holds drain_lock. Folds the ring (and any overflow spill) into the
+ * window coalescer so each terminal key yields at most one record per pass. */
+static void event_drain_window_locked(struct terminal_manager *mgr) {
+    for (;;) {
+        size_t popped = 0;
+        size_t folded = 0;
+        terminal_event_record_t record;
+        while (popped < mgr->dispatch_capacity &&
+               terminal_event_ring_pop(&mgr->event_ring, &record)) {
+            event_window_fold(mgr, &record, &folded);
+            ++popped;
+        }
 
-    terminal_event_record_t *records = NULL;
-    if (count > 0) {
-        records = calloc(count, sizeof(*records));
-        if (!records) {
-            td_log_writef(TD_LOG_WARN, "terminal_manager", "failed to allocate event batch (%zu)", count);
+        if (popped < mgr->dispatch_capacity &&
+            __atomic_load_n(&mgr->event_overflow_active, __ATOMIC_SEQ_CST)) {
+            struct terminal_event_coalescer *spilled = event_take_overflow(mgr);
+            size_t count = terminal_event_coalescer_compact(spilled);
+            for (size_t i = 0; i < count; ++i) {
+                event_window_fold(mgr, &spilled->records[i], &folded);
+            }
+            terminal_event_coalescer_reset(spilled);
+            popped += count;
         }
-    }
 
-    size_t idx = 0;
-    struct terminal_event_node *node = head;
-    while (node) {
-        struct terminal_event_node *next = node->next;
-        if (records && idx < count) {
-            records[idx++] = node->record;
+        if (popped == 0) {
+            break;
         }
-        free(node);
-        node = next;
+        event_window_deliver(mgr, folded);
     }
+}
 
-    bool dispatched = false;
-    if (callback && records && count > 0) {
-        callback(records, count, callback_ctx);
-        dispatched = true;
+/* Caller holds drain_lock. Empties the ring batch by batch, then hands over
+ * whatever spilled into the overflow table while the ring was full. */
+static void event_drain_locked(struct terminal_manager *mgr) {
+    if (mgr->cfg.event_window_ms > 0U) {
+        event_drain_window_locked(mgr);
+        return;
     }
 
-    free(records);
+    for (;;) {
+        size_t count = 0;
+        while (count < mgr->dispatch_capacity &&
+               terminal_event_ring_pop(&mgr->event_ring, &mgr->dispatch_records[count])) {
+            ++count;
+        }
+        if (count > 0) {
+            event_deliver(mgr, mgr->dispatch_records, count);
+            continue;
+        }
 
-    if (count > 0) {
-        pthread_mutex_lock(&mgr->lock);
-        if (dispatched) {
-            mgr->stats.events_dispatched += count;
-        } else {
-            mgr->stats.event_dispatch_failures += 1;
+        if (!__atomic_load_n(&mgr->event_overflow_active, __ATOMIC_SEQ_CST)) {
+            break;
         }
-        pthread_mutex_unlock(&mgr->lock);
+
+        struct terminal_event_coalescer *spilled = event_take_overflow(mgr);
+        size_t remaining = terminal_event_coalescer_compact(spilled);
+        if (remaining > 0) {
+            event_deliver(mgr, spilled->records, remaining);
+        }
+        terminal_event_coalescer_reset(spilled);
     }
 }
 
-static uint32_t prefix_mask_host(uint8_t prefix_len) {
-    if (prefix_len == 0U) {
-        return 0U;
-    }
-    if (prefix_len >= 32U) {
+static bool event_pipeline_empty(struct terminal_manager *mgr) {
+    return terminal_event_ring_depth(&mgr->event_ring) == 0 &&
+           !__atomic_load_n(&mgr->event_overflow_active, __ATOMIC_SEQ_CST);
+}
+
+/* Producers only touch dispatch_lock when the dispatcher is parked. The
+ * fence pairs with the idle store in the dispatcher: either it sees the new
+ * record before parking or we see it parked and signal. */
+static void event_dispatcher_kick(struct terminal_manager *mgr) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&mgr->dispatch_idle, __ATOMIC_SEQ_CST)) {
+        return;
+    }
+    pthread_mutex_lock(&mgr->dispatch_lock);
+    pthread_cond_signal(&mgr->dispatch_cond);
+    pthread_mutex_unlock(&mgr->dispatch_lock);
+}
+
+/* Called after a drain: once the dispatcher has caught up, producers may
+ * wait for it again the next time the ring fills. */
+static void event_backpressure_release(struct terminal_manager *mgr) {
+    if (__atomic_load_n(&mgr->event_backpressure, __ATOMIC_SEQ_CST) != TERMINAL_BACKPRESSURE_NONE &&
+        event_pipeline_empty(mgr)) {
+        __atomic_store_n(&mgr->event_backpressure, TERMINAL_BACKPRESSURE_NONE, __ATOMIC_SEQ_CST);
+    }
+}
+
+/* The producer side of the backpressure policy, run with no manager or
+ * shard lock held. Waits a bounded time for the dispatcher to drain the
+ * pipeline; a timeout latches STALLED so a wedged sink costs one wait, not
+ * one per event. */
+static void event_backpressure_wait(struct terminal_manager *mgr) {
+    if (__atomic_load_n(&mgr->event_backpressure, __ATOMIC_SEQ_CST) != TERMINAL_BACKPRESSURE_SATURATED ||
+        pthread_equal(pthread_self(), mgr->dispatch_thread)) {
+        return;
+    }
+
+    __atomic_fetch_add(&mgr->event_backpressure_waits, 1U, __ATOMIC_RELAXED);
+    for (unsigned int waited_ms = 0U; waited_ms < TERMINAL_EVENT_BACKPRESSURE_MAX_MS; ++waited_ms) {
+        if (event_pipeline_empty(mgr) ||
+            __atomic_load_n(&mgr->event_backpressure, __ATOMIC_SEQ_CST) != TERMINAL_BACKPRESSURE_SATURATED) {
+            return;
+        }
+        event_dispatcher_kick(mgr);
+        struct timespec pause = {0, 1000000L};
+        nanosleep(&pause, NULL);
+    }
+
+    int expected = TERMINAL_BACKPRESSURE_SATURATED;
+    __atomic_compare_exchange_n(&mgr->event_backpressure,
+                                &expected,
+                                TERMINAL_BACKPRESSURE_STALLED,
+                                false,
+                                __ATOMIC_SEQ_CST,
+                                __ATOMIC_SEQ_CST);
+}
+
+/* Caller holds dispatch_lock. Lets churn accumulate for the dispatch window
+ * before draining; a flush request or shutdown cuts the wait short. Producers
+ * do not signal while the dispatcher is busy, so the wait is undisturbed. */
+static void event_window_wait_locked(struct terminal_manager *mgr, uint64_t generation) {
+    struct timespec now;
+    monotonic_now(&now);
+    struct timespec until = timespec_add_ms(&now, mgr->cfg.event_window_ms);
+    while (!mgr->dispatch_stop && mgr->flush_requested == generation) {
+        if (pthread_cond_timedwait(&mgr->dispatch_cond, &mgr->dispatch_lock, &until) == ETIMEDOUT) {
+            break;
+        }
+    }
+}
+
+static void *terminal_event_dispatcher(void *arg) {
+    struct terminal_manager *mgr = (struct terminal_manager *)arg;
+
+    pthread_mutex_lock(&mgr->dispatch_lock);
+    while (!mgr->dispatch_stop) {
+        uint64_t generation = mgr->flush_requested;
+        if (mgr->cfg.event_window_ms > 0U && !event_pipeline_empty(mgr)) {
+            event_window_wait_locked(mgr, generation);
+            if (mgr->dispatch_stop) {
+                break;
+            }
+            generation = mgr->flush_requested;
+        }
+        pthread_mutex_unlock(&mgr->dispatch_lock);
+
+        pthread_mutex_lock(&mgr->drain_lock);
+        event_drain_locked(mgr);
+        pthread_mutex_unlock(&mgr->drain_lock);
+        event_backpressure_release(mgr);
+
+        pthread_mutex_lock(&mgr->dispatch_lock);
+        if (mgr->flush_completed < generation) {
+            mgr->flush_completed = generation;
+            pthread_cond_broadcast(&mgr->flush_cond);
+        }
+        if (mgr->dispatch_stop || mgr->flush_requested != generation) {
+            continue;
+        }
+
+        __atomic_store_n(&mgr->dispatch_idle, true, __ATOMIC_SEQ_CST);
+        if (event_pipeline_empty(mgr)) {
+            struct timespec now;
+            monotonic_now(&now);
+            struct timespec wake = timespec_add_ms(&now, TERMINAL_EVENT_DISPATCH_IDLE_MS);
+            pthread_cond_timedwait(&mgr->dispatch_cond, &mgr->dispatch_lock, &wake);
+        }
+        __atomic_store_n(&mgr->dispatch_idle, false, __ATOMIC_SEQ_CST);
+    }
+    pthread_mutex_unlock(&mgr->dispatch_lock);
+    return NULL;
+}
+
+/* Called by producers after they drop the manager lock. Without a
+ * dispatcher thread the caller drains inline, as before the ring existed. */
+static void terminal_manager_maybe_dispatch_events(struct terminal_manager *mgr) {
+    if (!mgr) {
+        return;
+    }
+
+    if (!mgr->dispatch_started) {
+        pthread_mutex_lock(&mgr->drain_lock);
+        event_drain_locked(mgr);
+        pthread_mutex_unlock(&mgr->drain_lock);
+        event_backpressure_release(mgr);
+        return;
+    }
+    event_dispatcher_kick(mgr);
+    event_backpressure_wait(mgr);
+}
+
+static uint32_t prefix_mask_host(uint8_t prefix_len) {
+    if (prefix_len == 0U) {
+        return 0U;
+    }
+    if (prefix_len >= 32U) {
         return 0xFFFFFFFFU;
     }
     return 0xFFFFFFFFU << (32U - prefix_len);
@@ -747,20 +1572,115 @@ static bool ip_matches_prefix(struct in_addr ip,
     return (ip_host & mask_host) == network_host;
 }
 
-static struct iface_record **find_iface_record_slot(struct terminal_manager *mgr, int kernel_ifindex) {
-    struct iface_record **slot = &mgr->iface_records;
-    while (*slot) {
-        if ((*slot)->kernel_ifindex == kernel_ifindex) {
+static size_t iface_index_home(int kernel_ifindex, size_t mask) {
+    return (size_t)((uint32_t)kernel_ifindex * 2654435761U) & mask;
+}
+
+static size_t iface_index_find(const struct terminal_manager *mgr, int kernel_ifindex) {
+    if (mgr->iface_index_capacity == 0) {
+        return SIZE_MAX;
+    }
+    size_t mask = mgr->iface_index_capacity - 1U;
+    for (size_t index = iface_index_home(kernel_ifindex, mask);; index = (index + 1U) & mask) {
+        const struct iface_record *record = mgr->iface_index[index];
+        if (!record) {
+            return SIZE_MAX;
+        }
+        if (record->kernel_ifindex == kernel_ifindex) {
+            return index;
+        }
+    }
+}
+
+/* Caller guarantees a free slot. */
+static void iface_index_place(struct iface_record **slots, size_t capacity, struct iface_record *record) {
+    size_t mask = capacity - 1U;
+    size_t index = iface_index_home(record->kernel_ifindex, mask);
+    while (slots[index]) {
+        index = (index + 1U) & mask;
+    }
+    slots[index] = record;
+}
+
+/* Keeps the index at most half full; records are few, so growth rehashes
+ * in one go. */
+static int iface_index_reserve(struct terminal_manager *mgr) {
+    if ((mgr->iface_record_count + 1U) * 2U <= mgr->iface_index_capacity) {
+        return 0;
+    }
+
+    size_t capacity = mgr->iface_index_capacity ? mgr->iface_index_capacity * 2U : TD_IFACE_INDEX_INITIAL_SLOTS;
+    struct iface_record **slots = calloc(capacity, sizeof(*slots));
+    if (!slots) {
+        return -ENOMEM;
+    }
+    for (struct iface_record *record = mgr->iface_records; record; record = record->next) {
+        iface_index_place(slots, capacity, record);
+    }
+    free(mgr->iface_index);
+    mgr->iface_index = slots;
+    mgr->iface_index_capacity = capacity;
+    return 0;
+}
+
+/* Linear-probing delete: pull later members of the cluster back over the
+ * hole when their home slot allows it. */
+static void iface_index_remove(struct terminal_manager *mgr, const struct iface_record *record) {
+    size_t hole = iface_index_find(mgr, record->kernel_ifindex);
+    if (hole == SIZE_MAX) {
+        return;
+    }
+    size_t mask = mgr->iface_index_capacity - 1U;
+    size_t index = hole;
+    for (;;) {
+        index = (index + 1U) & mask;
+        struct iface_record *next = mgr->iface_index[index];
+        if (!next) {
             break;
         }
-        slot = &(*slot)->next;
+        size_t home = iface_index_home(next->kernel_ifindex, mask);
+        if (((index - home) & mask) >= ((index - hole) & mask)) {
+            mgr->iface_index[hole] = next;
+            hole = index;
+        }
     }
-    return slot;
+    mgr->iface_index[hole] = NULL;
 }
 
 static struct iface_record *get_iface_record(struct terminal_manager *mgr, int kernel_ifindex) {
-    struct iface_record **slot = find_iface_record_slot(mgr, kernel_ifindex);
-    return slot ? *slot : NULL;
+    size_t index = iface_index_find(mgr, kernel_ifindex);
+    return index == SIZE_MAX ? NULL : mgr->iface_index[index];
+}
+
+static struct iface_record *iface_record_create(struct terminal_manager *mgr, int kernel_ifindex) {
+    if (iface_index_reserve(mgr) != 0) {
+        return NULL;
+    }
+    struct iface_record *record = calloc(1, sizeof(*record));
+    if (!record) {
+        return NULL;
+    }
+    record->kernel_ifindex = kernel_ifindex;
+    record->pprev = mgr->iface_records_tail;
+    *mgr->iface_records_tail = record;
+    mgr->iface_records_tail = &record->next;
+    iface_index_place(mgr->iface_index, mgr->iface_index_capacity, record);
+    mgr->iface_record_count += 1U;
+    return record;
+}
+
+/* Generations come from one manager-wide counter so a record freed and
+ * recreated for the same ifindex never repeats a value an entry holds. */
+static void iface_record_touch(struct terminal_manager *mgr, struct iface_record *record) {
+    if (record) {
+        __atomic_store_n(&record->generation, ++mgr->iface_generation_seq, __ATOMIC_RELEASE);
+    }
+}
+
+static void iface_record_touch_all(struct terminal_manager *mgr) {
+    for (struct iface_record *record = mgr->iface_records; record; record = record->next) {
+        iface_record_touch(mgr, record);
+    }
 }
 
 static bool iface_record_matches_ip(const struct iface_record *record, struct in_addr ip) {
@@ -773,6 +1693,7 @@ static bool iface_record_select_ip(const struct iface_record *record,
     if (!record) {
         return false;
     }
+    /* Longest prefix first, so this picks the most specific subnet. */
     for (struct iface_prefix_entry *node = record->prefixes; node; node = node->next) {
         if (ip_matches_prefix(terminal_ip, node->network, node->prefix_len)) {
             if (node->address.s_addr == 0) {
@@ -787,14 +1708,26 @@ static bool iface_record_select_ip(const struct iface_record *record,
     return false;
 }
 
-static bool iface_binding_contains(const struct iface_binding_entry *head,
-                                   const struct terminal_entry *entry) {
-    for (const struct iface_binding_entry *node = head; node; node = node->next) {
-        if (node->terminal == entry) {
-            return true;
-        }
+static void iface_binding_link(struct iface_record *record, struct terminal_entry *entry) {
+    entry->binding_next = record->bindings;
+    if (record->bindings) {
+        record->bindings->binding_pprev = &entry->binding_next;
     }
-    return false;
+    entry->binding_pprev = &record->bindings;
+    record->bindings = entry;
+}
+
+static void iface_binding_unlink(struct terminal_entry *entry) {
+    if (!entry->binding_pprev) {
+        return;
+    }
+    *entry->binding_pprev = entry->binding_next;
+    if (entry->binding_next) {
+        entry->binding_next->binding_pprev = entry->binding_pprev;
+    }
+    entry->binding_next = NULL;
+    entry->binding_pprev = NULL;
+    entry->tx_iface_record = NULL;
 }
 
 static bool iface_binding_attach(struct terminal_manager *mgr,
@@ -804,8 +1737,7 @@ static bool iface_binding_attach(struct terminal_manager *mgr,
         return false;
     }
 
-    struct iface_record **slot = find_iface_record_slot(mgr, kernel_ifindex);
-    struct iface_record *record = slot ? *slot : NULL;
+    struct iface_record *record = get_iface_record(mgr, kernel_ifindex);
     if (!record) {
         td_log_writef(TD_LOG_DEBUG,
                       "terminal_manager",
@@ -814,21 +1746,10 @@ static bool iface_binding_attach(struct terminal_manager *mgr,
         return false;
     }
 
-    if (iface_binding_contains(record->bindings, entry)) {
-        return true;
-    }
-
-    struct iface_binding_entry *node = calloc(1, sizeof(*node));
-    if (!node) {
-        td_log_writef(TD_LOG_WARN,
-                      "terminal_manager",
-                      "failed to allocate iface binding for kernel ifindex %d",
-                      kernel_ifindex);
-        return false;
-    }
-    node->terminal = entry;
-    node->next = record->bindings;
-    record->bindings = node;
+    /* Callers detach before rebinding, so this only ever relinks in place. */
+    iface_binding_unlink(entry);
+    iface_binding_link(record, entry);
+    entry->tx_iface_record = record;
     return true;
 }
 
@@ -840,40 +1761,250 @@ static void iface_binding_detach(struct terminal_manager *mgr,
     }
 
     entry->tx_source_ip.s_addr = 0;
+    iface_binding_unlink(entry);
+    iface_record_prune_if_empty(mgr, get_iface_record(mgr, kernel_ifindex));
+}
 
-    struct iface_record **slot = find_iface_record_slot(mgr, kernel_ifindex);
-    struct iface_record *record = slot ? *slot : NULL;
-    if (!record) {
+static void iface_record_prune_if_empty(struct terminal_manager *mgr, struct iface_record *record) {
+    if (!record || record->prefixes || record->bindings) {
         return;
     }
+    iface_index_remove(mgr, record);
+    *record->pprev = record->next;
+    if (record->next) {
+        record->next->pprev = record->pprev;
+    } else {
+        mgr->iface_records_tail = record->pprev;
+    }
+    mgr->iface_record_count -= 1U;
+    free(record);
+}
+
+static bool vlan_id_supported(int vlan_id) {
+    return vlan_id >= TD_MIN_VLAN_ID && vlan_id <= TD_MAX_VLAN_ID;
+}
+
+static struct terminal_entry **ifindex_index_head(struct terminal_manager *mgr,
+                                                  uint32_t ifindex) {
+    return &mgr->ifindex_index[ifindex & (TERMINAL_IFINDEX_INDEX_BUCKETS - 1U)];
+}
+
+static void ifindex_index_link(struct terminal_manager *mgr, struct terminal_entry *entry) {
+    struct terminal_entry **head = ifindex_index_head(mgr, entry->meta.ifindex);
+    entry->ifindex_next = *head;
+    if (*head) {
+        (*head)->ifindex_pprev = &entry->ifindex_next;
+    }
+    entry->ifindex_pprev = head;
+    *head = entry;
+}
 
-    struct iface_binding_entry **pp = &record->bindings;
-    while (*pp) {
-        if ((*pp)->terminal == entry) {
-            struct iface_binding_entry *node = *pp;
-            *pp = node->next;
-            free(node);
-            break;
+static void ifindex_index_unlink(struct terminal_entry *entry) {
+    if (!entry->ifindex_pprev) {
+        return;
+    }
+    *entry->ifindex_pprev = entry->ifindex_next;
+    if (entry->ifindex_next) {
+        entry->ifindex_next->ifindex_pprev = entry->ifindex_pprev;
+    }
+    entry->ifindex_next = NULL;
+    entry->ifindex_pprev = NULL;
+}
+
+static void vlan_index_link(struct terminal_manager *mgr, struct terminal_entry *entry) {
+    if (!vlan_id_supported(entry->meta.vlan_id)) {
+        return;
+    }
+    struct terminal_entry **head = &mgr->vlan_index[entry->meta.vlan_id];
+    entry->vlan_next = *head;
+    if (*head) {
+        (*head)->vlan_pprev = &entry->vlan_next;
+    }
+    entry->vlan_pprev = head;
+    *head = entry;
+}
+
+static void vlan_index_unlink(struct terminal_entry *entry) {
+    if (!entry->vlan_pprev) {
+        return;
+    }
+    *entry->vlan_pprev = entry->vlan_next;
+    if (entry->vlan_next) {
+        entry->vlan_next->vlan_pprev = entry->vlan_pprev;
+    }
+    entry->vlan_next = NULL;
+    entry->vlan_pprev = NULL;
+}
+
+static uint64_t hash_mac(const uint8_t *mac) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < ETH_ALEN; ++i) {
+        hash ^= mac[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t hash_ipv4(struct in_addr ip) {
+    uint64_t hash = 1469598103934665603ULL;
+    const uint8_t *ip_bytes = (const uint8_t *)&ip.s_addr;
+    for (size_t i = 0; i < sizeof(ip.s_addr); ++i) {
+        hash ^= ip_bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static uint64_t entry_mac_hash(const struct terminal_entry *entry) {
+    return hash_mac(entry->key.mac);
+}
+
+static uint64_t entry_ip_hash(const struct terminal_entry *entry) {
+    return hash_ipv4(entry->key.ip);
+}
+
+static void point_index_init(struct terminal_point_index *index,
+                             size_t link_offset,
+                             uint64_t (*entry_hash)(const struct terminal_entry *entry)) {
+    memset(index, 0, sizeof(*index));
+    index->link_offset = link_offset;
+    index->entry_hash = entry_hash;
+}
+
+static struct terminal_index_link *point_index_link_of(const struct terminal_point_index *index,
+                                                       const struct terminal_entry *entry) {
+    return (struct terminal_index_link *)((char *)entry + index->link_offset);
+}
+
+static struct terminal_entry *point_index_bucket(const struct terminal_point_index *index,
+                                                 uint64_t hash) {
+    if (index->capacity == 0) {
+        return NULL;
+    }
+    return index->buckets[hash & (index->capacity - 1U)];
+}
+
+static void point_index_push(struct terminal_point_index *index,
+                             struct terminal_entry *entry,
+                             uint64_t hash) {
+    struct terminal_entry **head = &index->buckets[hash & (index->capacity - 1U)];
+    struct terminal_index_link *link = point_index_link_of(index, entry);
+    link->next = *head;
+    if (*head) {
+        point_index_link_of(index, *head)->pprev = &link->next;
+    }
+    link->pprev = head;
+    *head = entry;
+}
+
+/* Makes room for one more entry; the only step that can fail. */
+static int point_index_reserve(struct terminal_point_index *index) {
+    if (index->count < index->capacity) {
+        return 0;
+    }
+    size_t capacity = index->capacity ? index->capacity * 2U : TERMINAL_POINT_INDEX_INITIAL_BUCKETS;
+    struct terminal_entry **buckets = calloc(capacity, sizeof(*buckets));
+    if (!buckets) {
+        return -ENOMEM;
+    }
+    struct terminal_entry **old_buckets = index->buckets;
+    size_t old_capacity = index->capacity;
+    index->buckets = buckets;
+    index->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        struct terminal_entry *entry = old_buckets[i];
+        while (entry) {
+            struct terminal_entry *next = point_index_link_of(index, entry)->next;
+            point_index_push(index, entry, index->entry_hash(entry));
+            entry = next;
         }
-        pp = &(*pp)->next;
     }
+    free(old_buckets);
+    return 0;
+}
 
-    iface_record_prune_if_empty(slot);
+static void point_index_link(struct terminal_point_index *index, struct terminal_entry *entry) {
+    point_index_push(index, entry, index->entry_hash(entry));
+    index->count += 1U;
 }
 
-static void iface_record_prune_if_empty(struct iface_record **slot_ref) {
-    if (!slot_ref || !*slot_ref) {
+static void point_index_unlink(struct terminal_point_index *index, struct terminal_entry *entry) {
+    struct terminal_index_link *link = point_index_link_of(index, entry);
+    if (!link->pprev) {
         return;
     }
-    struct iface_record *record = *slot_ref;
-    if (!record->prefixes && !record->bindings) {
-        *slot_ref = record->next;
-        free(record);
+    *link->pprev = link->next;
+    if (link->next) {
+        point_index_link_of(index, link->next)->pprev = link->pprev;
     }
+    link->next = NULL;
+    link->pprev = NULL;
+    index->count -= 1U;
 }
 
-static bool vlan_id_supported(int vlan_id) {
-    return vlan_id >= TD_MIN_VLAN_ID && vlan_id <= TD_MAX_VLAN_ID;
+static void point_index_free(struct terminal_point_index *index) {
+    free(index->buckets);
+    index->buckets = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+/* Must succeed before an entry is created, so terminal_index_insert cannot
+ * fail once the entry is in its table. */
+static int terminal_index_reserve(struct terminal_manager *mgr) {
+    if (point_index_reserve(&mgr->mac_index) != 0 ||
+        point_index_reserve(&mgr->ip_index) != 0) {
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+/* Called once the entry is in its table, and before it leaves it. Every
+ * indexed entry is on an ifindex bucket, so ifindex_pprev doubles as the
+ * "indexed" flag for the setters below. The key never changes, so the MAC
+ * and IPv4 links stay put until removal. */
+static void terminal_index_insert(struct terminal_manager *mgr, struct terminal_entry *entry) {
+    ifindex_index_link(mgr, entry);
+    vlan_index_link(mgr, entry);
+    point_index_link(&mgr->mac_index, entry);
+    point_index_link(&mgr->ip_index, entry);
+}
+
+static void terminal_index_remove(struct terminal_manager *mgr, struct terminal_entry *entry) {
+    ifindex_index_unlink(entry);
+    vlan_index_unlink(entry);
+    point_index_unlink(&mgr->mac_index, entry);
+    point_index_unlink(&mgr->ip_index, entry);
+}
+
+/* All meta.ifindex / meta.vlan_id writes go through these so the indexes
+ * follow; entries not yet inserted just take the value. */
+static void entry_set_ifindex(struct terminal_manager *mgr,
+                              struct terminal_entry *entry,
+                              uint32_t ifindex) {
+    if (entry->meta.ifindex == ifindex) {
+        return;
+    }
+    bool indexed = entry->ifindex_pprev != NULL;
+    ifindex_index_unlink(entry);
+    entry->meta.ifindex = ifindex;
+    if (indexed) {
+        ifindex_index_link(mgr, entry);
+    }
+}
+
+static void entry_set_vlan(struct terminal_manager *mgr,
+                           struct terminal_entry *entry,
+                           int vlan_id) {
+    if (entry->meta.vlan_id == vlan_id) {
+        return;
+    }
+    bool indexed = entry->ifindex_pprev != NULL;
+    vlan_index_unlink(entry);
+    entry->meta.vlan_id = vlan_id;
+    if (indexed) {
+        vlan_index_link(mgr, entry);
+    }
 }
 
 static struct pending_vlan_bucket *pending_get_bucket(struct terminal_manager *mgr,
@@ -900,26 +2031,18 @@ static void pending_detach_from_vlan(struct terminal_manager *mgr,
     if (!vlan_id_supported(vlan_id)) {
         return;
     }
-    struct pending_vlan_bucket *bucket = pending_get_bucket(mgr, vlan_id);
-    if (!bucket) {
+    if (entry->pending_vlan_id != vlan_id) {
         return;
     }
-    struct pending_vlan_entry **cursor = &bucket->head;
-    while (*cursor) {
-        if ((*cursor)->terminal == entry) {
-            struct pending_vlan_entry *node = *cursor;
-            *cursor = node->next;
-            free(node);
-            break;
+    if (entry->pending_pprev) {
+        *entry->pending_pprev = entry->pending_next;
+        if (entry->pending_next) {
+            entry->pending_next->pending_pprev = entry->pending_pprev;
         }
-        cursor = &(*cursor)->next;
-    }
-    if (!bucket->head) {
-        pending_reset_bucket(bucket);
-    }
-    if (entry->pending_vlan_id == vlan_id) {
-        entry->pending_vlan_id = -1;
+        entry->pending_next = NULL;
+        entry->pending_pprev = NULL;
     }
+    entry->pending_vlan_id = -1;
 }
 
 static void pending_detach(struct terminal_manager *mgr,
@@ -952,26 +2075,12 @@ static void pending_attach(struct terminal_manager *mgr,
         return;
     }
 
-    struct pending_vlan_entry *node = bucket->head;
-    while (node) {
-        if (node->terminal == entry) {
-            entry->pending_vlan_id = vlan_id;
-            return;
-        }
-        node = node->next;
-    }
-
-    node = calloc(1, sizeof(*node));
-    if (!node) {
-        td_log_writef(TD_LOG_WARN,
-                      "terminal_manager",
-                      "failed to allocate pending node for vlan=%d",
-                      vlan_id);
-        return;
+    entry->pending_next = bucket->head;
+    if (bucket->head) {
+        bucket->head->pending_pprev = &entry->pending_next;
     }
-    node->terminal = entry;
-    node->next = bucket->head;
-    bucket->head = node;
+    entry->pending_pprev = &bucket->head;
+    bucket->head = entry;
     entry->pending_vlan_id = vlan_id;
 }
 
@@ -999,14 +2108,10 @@ static void pending_retry_vlan(struct terminal_manager *mgr,
         return;
     }
 
-    struct pending_vlan_entry *node = bucket->head;
-    while (node) {
-        struct pending_vlan_entry *next = node->next;
-        struct terminal_entry *entry = node->terminal;
-        if (!entry) {
-            node = next;
-            continue;
-        }
+    /* A successful resolve unlinks entry, so step past it first. */
+    struct terminal_entry *entry = bucket->head;
+    while (entry) {
+        struct terminal_entry *next = entry->pending_next;
 
         bool resolved = resolve_tx_interface(mgr, entry);
         if (resolved && is_iface_available(entry)) {
@@ -1014,7 +2119,7 @@ static void pending_retry_vlan(struct terminal_manager *mgr,
             entry->failed_probes = 0;
         }
 
-        node = next;
+        entry = next;
     }
 }
 
@@ -1024,8 +2129,27 @@ static void pending_retry_for_ifindex(struct terminal_manager *mgr,
         return;
     }
 
-    char ifname[IFNAMSIZ] = {0};
     int vlan_id = -1;
+    if (mgr->vlan_links_ready) {
+        /* Address events are rare enough for a scan of the link cache. */
+        for (int vid = TD_MIN_VLAN_ID; vid <= TD_MAX_VLAN_ID; ++vid) {
+            if (mgr->vlan_link_ifindex[vid] == kernel_ifindex) {
+                vlan_id = vid;
+                break;
+            }
+        }
+        if (vlan_id < 0) {
+            td_log_writef(TD_LOG_WARN,
+                          "terminal_manager",
+                          "pending retry on ifindex %d failed: no VLAN interface known for it",
+                          kernel_ifindex);
+            return;
+        }
+        pending_retry_vlan(mgr, vlan_id);
+        return;
+    }
+
+    char ifname[IFNAMSIZ] = {0};
     if (!if_indextoname((unsigned int)kernel_ifindex, ifname)) {
         td_log_writef(TD_LOG_WARN,
                       "terminal_manager",
@@ -1053,10 +2177,9 @@ static bool iface_prefix_add(struct terminal_manager *mgr,
         return false;
     }
 
-    struct iface_record **slot = find_iface_record_slot(mgr, kernel_ifindex);
-    struct iface_record *record = *slot;
+    struct iface_record *record = get_iface_record(mgr, kernel_ifindex);
     if (!record) {
-        record = calloc(1, sizeof(*record));
+        record = iface_record_create(mgr, kernel_ifindex);
         if (!record) {
             td_log_writef(TD_LOG_WARN,
                           "terminal_manager",
@@ -1064,19 +2187,28 @@ static bool iface_prefix_add(struct terminal_manager *mgr,
                           kernel_ifindex);
             return false;
         }
-        record->kernel_ifindex = kernel_ifindex;
-        record->next = NULL;
-        record->prefixes = NULL;
-        record->bindings = NULL;
-        *slot = record;
+        iface_record_touch(mgr, record);
     }
 
-    for (struct iface_prefix_entry *node = record->prefixes; node; node = node->next) {
+    /* Insert ahead of the first prefix no longer than this one, so among
+     * equal lengths the newest address still wins as before. */
+    struct iface_prefix_entry **insert_at = NULL;
+    for (struct iface_prefix_entry **pp = &record->prefixes; *pp; pp = &(*pp)->next) {
+        struct iface_prefix_entry *node = *pp;
         if (node->prefix_len == prefix_len &&
             node->network.s_addr == network.s_addr &&
             node->address.s_addr == address.s_addr) {
             return true;
         }
+        if (!insert_at && node->prefix_len <= prefix_len) {
+            insert_at = pp;
+        }
+    }
+    if (!insert_at) {
+        insert_at = &record->prefixes;
+        while (*insert_at) {
+            insert_at = &(*insert_at)->next;
+        }
     }
 
     struct iface_prefix_entry *entry = calloc(1, sizeof(*entry));
@@ -1090,8 +2222,9 @@ static bool iface_prefix_add(struct terminal_manager *mgr,
     entry->network = network;
     entry->address = address;
     entry->prefix_len = prefix_len;
-    entry->next = record->prefixes;
-    record->prefixes = entry;
+    entry->next = *insert_at;
+    *insert_at = entry;
+    iface_record_touch(mgr, record);
     return true;
 }
 
@@ -1100,8 +2233,7 @@ static bool iface_prefix_remove(struct terminal_manager *mgr,
                                 struct in_addr network,
                                 struct in_addr address,
                                 uint8_t prefix_len) {
-    struct iface_record **slot = find_iface_record_slot(mgr, kernel_ifindex);
-    struct iface_record *record = slot ? *slot : NULL;
+    struct iface_record *record = get_iface_record(mgr, kernel_ifindex);
     if (!record) {
         return true;
     }
@@ -1114,12 +2246,13 @@ static bool iface_prefix_remove(struct terminal_manager *mgr,
             struct iface_prefix_entry *node = *pp;
             *pp = node->next;
             free(node);
+            iface_record_touch(mgr, record);
             break;
         }
         pp = &(*pp)->next;
     }
 
-    iface_record_prune_if_empty(slot);
+    iface_record_prune_if_empty(mgr, record);
     return true;
 }
 
@@ -1149,27 +2282,11 @@ static void *terminal_manager_worker(void *arg) {
     return NULL;
 }
 
+/* Caller holds the shard lock for hash. */
 static struct terminal_entry *find_entry(struct terminal_manager *mgr,
                                          const struct terminal_key *key,
-                                         size_t bucket,
-                                         struct terminal_entry ***prev_next_out) {
-    struct terminal_entry **prev_next = &mgr->table[bucket];
-    struct terminal_entry *node = mgr->table[bucket];
-    while (node) {
-        if (memcmp(node->key.mac, key->mac, ETH_ALEN) == 0 &&
-            node->key.ip.s_addr == key->ip.s_addr) {
-                if (prev_next_out) {
-                    *prev_next_out = prev_next;
-                }
-                return node;
-            }
-        prev_next = &node->next;
-        node = node->next;
-    }
-    if (prev_next_out) {
-        *prev_next_out = prev_next;
-    }
-    return NULL;
+                                         uint64_t hash) {
+    return terminal_table_find(table_for_hash(mgr, hash), key, hash);
 }
 
 static const char *state_to_string(terminal_state_t state) {
@@ -1185,6 +2302,30 @@ static const char *state_to_string(terminal_state_t state) {
     }
 }
 
+/* Fills candidate with the entry's VLAN interface name and returns its kernel
+ * ifindex, or <= 0 when there is none. With a ready link cache this is a table
+ * read and, while the entry stays on the same interface, not even a format. */
+static int vlan_link_resolve(struct terminal_manager *mgr,
+                             const struct terminal_entry *entry,
+                             char candidate[IFNAMSIZ]) {
+    int vlan_id = entry->meta.vlan_id;
+    if (mgr->vlan_links_ready) {
+        int kernel_ifindex = vlan_id_supported(vlan_id) ? mgr->vlan_link_ifindex[vlan_id] : 0;
+        if (kernel_ifindex <= 0) {
+            return -1;
+        }
+        if (entry->tx_kernel_ifindex == kernel_ifindex && entry->tx_iface[0] != '\0') {
+            memcpy(candidate, entry->tx_iface, IFNAMSIZ);
+        } else {
+            snprintf(candidate, IFNAMSIZ, mgr->cfg.vlan_iface_format, (unsigned int)vlan_id);
+        }
+        return kernel_ifindex;
+    }
+
+    snprintf(candidate, IFNAMSIZ, mgr->cfg.vlan_iface_format, (unsigned int)vlan_id);
+    return (int)if_nametoindex(candidate);
+}
+
 static bool resolve_tx_interface(struct terminal_manager *mgr, struct terminal_entry *entry) {
     if (!mgr || !entry) {
         return false;
@@ -1203,16 +2344,13 @@ static bool resolve_tx_interface(struct terminal_manager *mgr, struct terminal_e
     struct in_addr candidate_source_ip = {0};
 
     if (mgr->cfg.vlan_iface_format) {
-        snprintf(candidate,
-                 sizeof(candidate),
-                 mgr->cfg.vlan_iface_format,
-                 (unsigned int)entry->meta.vlan_id);
-        candidate_kernel_ifindex = (int)if_nametoindex(candidate);
+        candidate_kernel_ifindex = vlan_link_resolve(mgr, entry, candidate);
         resolved = candidate_kernel_ifindex > 0;
     }
 
+    struct iface_record *record = NULL;
     if (resolved) {
-        struct iface_record *record = get_iface_record(mgr, candidate_kernel_ifindex);
+        record = get_iface_record(mgr, candidate_kernel_ifindex);
         if (!record || !iface_record_select_ip(record, entry->key.ip, &candidate_source_ip)) {
             td_log_writef(TD_LOG_DEBUG,
                           "terminal_manager",
@@ -1246,6 +2384,7 @@ static bool resolve_tx_interface(struct terminal_manager *mgr, struct terminal_e
     snprintf(entry->tx_iface, sizeof(entry->tx_iface), "%s", candidate);
     entry->tx_kernel_ifindex = candidate_kernel_ifindex;
     entry->tx_source_ip = candidate_source_ip;
+    entry->tx_iface_generation = record->generation;
 
     if (!iface_binding_attach(mgr, candidate_kernel_ifindex, entry)) {
         entry->tx_iface[0] = '\0';
@@ -1267,10 +2406,10 @@ static void apply_packet_binding(struct terminal_manager *mgr,
         return;
     }
 
-    entry->meta.vlan_id = packet->vlan_id;
+    entry_set_vlan(mgr, entry, packet->vlan_id);
 
     if (packet->ifindex > 0U) {
-        entry->meta.ifindex = packet->ifindex;
+        entry_set_ifindex(mgr, entry, packet->ifindex);
     }
 
     bool iface_resolved = resolve_tx_interface(mgr, entry);
@@ -1282,7 +2421,7 @@ static void apply_packet_binding(struct terminal_manager *mgr,
 static struct terminal_entry *create_entry(const struct terminal_key *key,
                                            struct terminal_manager *mgr,
                                            const struct td_adapter_packet_view *packet) {
-    struct terminal_entry *entry = calloc(1, sizeof(*entry));
+    struct terminal_entry *entry = td_object_pool_alloc(&mgr->entry_pool);
     if (!entry) {
         return NULL;
     }
@@ -1300,12 +2439,23 @@ static struct terminal_entry *create_entry(const struct terminal_key *key,
     entry->tx_iface[0] = '\0';
     entry->tx_kernel_ifindex = -1;
     entry->tx_source_ip.s_addr = 0;
+    entry->tx_iface_generation = 0;
+    entry->tx_iface_record = NULL;
     entry->pending_vlan_id = -1;
+    entry->binding_next = NULL;
+    entry->binding_pprev = NULL;
+    entry->pending_next = NULL;
+    entry->pending_pprev = NULL;
+    entry->ifindex_next = NULL;
+    entry->ifindex_pprev = NULL;
+    entry->vlan_next = NULL;
+    entry->vlan_pprev = NULL;
+    memset(&entry->mac_link, 0, sizeof(entry->mac_link));
+    memset(&entry->ip_link, 0, sizeof(entry->ip_link));
     entry->vid_lookup_vlan = -1;
     entry->mac_refresh_enqueued = false;
     entry->mac_verify_enqueued = false;
     entry->vid_lookup_attempted = false;
-    entry->next = NULL;
 
     if (packet) {
         apply_packet_binding(mgr, entry, packet);
@@ -1349,6 +2499,10 @@ struct terminal_manager *terminal_manager_create(const struct terminal_manager_c
     }
 
     mgr->cfg = *cfg;
+    for (size_t i = 0; i < mgr->cfg.ignored_vlan_count; ++i) {
+        mgr->vlan_ignored[mgr->cfg.ignored_vlans[i]] = true;
+    }
+    mgr->iface_records_tail = &mgr->iface_records;
     if (mgr->cfg.keepalive_interval_sec == 0) {
         mgr->cfg.keepalive_interval_sec = TERMINAL_KEEPALIVE_INTERVAL_DEFAULT_SEC;
     }
@@ -1367,26 +2521,80 @@ struct terminal_manager *terminal_manager_create(const struct terminal_manager_c
     if (mgr->cfg.max_terminals == 0) {
         mgr->cfg.max_terminals = TERMINAL_DEFAULT_MAX_TERMINALS;
     }
-    mgr->adapter = adapter;
+    if (mgr->cfg.event_ring_size == 0) {
+        mgr->cfg.event_ring_size = TERMINAL_EVENT_RING_DEFAULT_SIZE;
+    }
+    if (terminal_event_ring_init(&mgr->event_ring, mgr->cfg.event_ring_size) != 0) {
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_manager",
+                      "failed to allocate event ring (%zu records)",
+                      mgr->cfg.event_ring_size);
+        free(mgr);
+        return NULL;
+    }
+    mgr->cfg.event_ring_size = terminal_event_ring_capacity(&mgr->event_ring);
+    mgr->dispatch_capacity = mgr->cfg.event_ring_size;
+    mgr->dispatch_records = calloc(mgr->dispatch_capacity, sizeof(*mgr->dispatch_records));
+    if (!mgr->dispatch_records) {
+        terminal_event_ring_destroy(&mgr->event_ring);
+        free(mgr);
+        return NULL;
+    }
+    if (mgr->cfg.event_journal_size == 0) {
+        mgr->cfg.event_journal_size = TERMINAL_EVENT_JOURNAL_DEFAULT_SIZE;
+    }
+    mgr->event_journal.capacity = mgr->cfg.event_journal_size;
+    mgr->event_journal.records = calloc(mgr->event_journal.capacity,
+                                        sizeof(*mgr->event_journal.records));
+    if (!mgr->event_journal.records) {
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_manager",
+                      "failed to allocate event journal (%zu records)",
+                      mgr->cfg.event_journal_size);
+        free(mgr->dispatch_records);
+        terminal_event_ring_destroy(&mgr->event_ring);
+        free(mgr);
+        return NULL;
+    }
+    mgr->adapter = adapter;
     mgr->adapter_ops = adapter_ops;
     mgr->mac_locator_ops = adapter_ops ? adapter_ops->mac_locator_ops : NULL;
     mgr->probe_cb = probe_cb;
     mgr->probe_ctx = probe_ctx;
     pthread_mutex_init(&mgr->lock, NULL);
+    for (size_t i = 0; i < TERMINAL_SHARD_COUNT; ++i) {
+        pthread_mutex_init(&mgr->shard_locks[i], NULL);
+    }
     pthread_mutex_init(&mgr->worker_lock, NULL);
+    pthread_mutex_init(&mgr->overflow_lock, NULL);
+    pthread_mutex_init(&mgr->drain_lock, NULL);
+    pthread_mutex_init(&mgr->dispatch_lock, NULL);
+    pthread_mutex_init(&mgr->view_lock, NULL);
+    pthread_mutex_init(&mgr->lookup_batch_lock, NULL);
+    terminal_event_coalescer_init(&mgr->event_overflow);
+    terminal_event_coalescer_init(&mgr->event_overflow_spare);
+    terminal_event_coalescer_init(&mgr->event_window);
+    point_index_init(&mgr->mac_index, offsetof(struct terminal_entry, mac_link), entry_mac_hash);
+    point_index_init(&mgr->ip_index, offsetof(struct terminal_entry, ip_link), entry_ip_hash);
+    td_object_pool_init(&mgr->entry_pool, sizeof(struct terminal_entry), TERMINAL_POOL_SLAB_OBJECTS);
+    td_object_pool_init(&mgr->lookup_task_pool, sizeof(struct mac_lookup_task), TERMINAL_POOL_SLAB_OBJECTS);
+    td_object_pool_init(&mgr->probe_task_pool, sizeof(struct probe_task), TERMINAL_POOL_SLAB_OBJECTS);
 
     pthread_condattr_t cond_attr;
     pthread_condattr_init(&cond_attr);
     pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
     pthread_cond_init(&mgr->worker_cond, &cond_attr);
+    pthread_cond_init(&mgr->dispatch_cond, &cond_attr);
+    pthread_cond_init(&mgr->flush_cond, NULL);
     pthread_condattr_destroy(&cond_attr);
     mgr->worker_stop = false;
     mgr->worker_started = false;
     mgr->event_cb = NULL;
     mgr->event_cb_ctx = NULL;
-    mgr->events.head = NULL;
-    mgr->events.tail = NULL;
-    mgr->events.size = 0;
+    mgr->dispatch_cb = NULL;
+    mgr->dispatch_cb_ctx = NULL;
+    mgr->dispatch_stop = false;
+    mgr->dispatch_started = false;
     mgr->terminal_count = 0;
     mgr->max_terminals = mgr->cfg.max_terminals;
     memset(&mgr->stats, 0, sizeof(mgr->stats));
@@ -1402,8 +2610,12 @@ struct terminal_manager *terminal_manager_create(const struct terminal_manager_c
     mgr->address_sync_pending = false;
     mgr->address_sync_in_progress = false;
 
-    for (size_t i = 0; i < TERMINAL_BUCKET_COUNT; ++i) {
-        mgr->table[i] = NULL;
+    memset(mgr->tables, 0, sizeof(mgr->tables));
+    struct timespec created;
+    monotonic_now(&created);
+    for (size_t i = 0; i < TERMINAL_SHARD_COUNT; ++i) {
+        memset(&mgr->timer_wheels[i], 0, sizeof(mgr->timer_wheels[i]));
+        mgr->timer_wheels[i].now_sec = (uint64_t)created.tv_sec;
     }
 
     for (int vid = 0; vid < TD_PENDING_VLAN_CAPACITY; ++vid) {
@@ -1416,16 +2628,28 @@ struct terminal_manager *terminal_manager_create(const struct terminal_manager_c
         td_log_writef(TD_LOG_ERROR, "terminal_manager", "failed to start timer worker thread");
     }
 
-    if (mgr->mac_locator_ops && mgr->mac_locator_ops->lookup && mgr->mac_locator_ops->subscribe) {
+    if (pthread_create(&mgr->dispatch_thread, NULL, terminal_event_dispatcher, mgr) == 0) {
+        mgr->dispatch_started = true;
+    } else {
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_manager",
+                      "failed to start event dispatcher thread; dispatching inline");
+    }
+
+    if (mgr->mac_locator_ops && mgr->mac_locator_ops->lookup &&
+        (mgr->mac_locator_ops->subscribe || mgr->mac_locator_ops->subscribe_delta)) {
         uint64_t version = 0ULL;
         if (mgr->mac_locator_ops->get_version &&
             mgr->mac_locator_ops->get_version(mgr->adapter, &version) == TD_ADAPTER_OK) {
-            mgr->mac_locator_version = version;
+            __atomic_store_n(&mgr->mac_locator_version, version, __ATOMIC_RELEASE);
         }
 
-        td_adapter_result_t sub_rc = mgr->mac_locator_ops->subscribe(mgr->adapter,
-                                                                      mac_locator_on_refresh,
-                                                                      mgr);
+        td_adapter_result_t sub_rc;
+        if (mgr->mac_locator_ops->subscribe_delta) {
+            sub_rc = mgr->mac_locator_ops->subscribe_delta(mgr->adapter, mac_locator_on_delta, mgr);
+        } else {
+            sub_rc = mgr->mac_locator_ops->subscribe(mgr->adapter, mac_locator_on_refresh, mgr);
+        }
         if (sub_rc == TD_ADAPTER_OK) {
             mgr->mac_locator_subscribed = true;
         } else if (sub_rc == TD_ADAPTER_ERR_ALREADY) {
@@ -1463,30 +2687,31 @@ void terminal_manager_destroy(struct terminal_manager *mgr) {
         mgr->worker_started = false;
     }
 
+    /* Records still in the ring are discarded, as the old queue was. */
+    pthread_mutex_lock(&mgr->dispatch_lock);
+    mgr->dispatch_stop = true;
+    pthread_cond_broadcast(&mgr->dispatch_cond);
+    pthread_cond_broadcast(&mgr->flush_cond);
+    pthread_mutex_unlock(&mgr->dispatch_lock);
+
+    if (mgr->dispatch_started) {
+        pthread_join(mgr->dispatch_thread, NULL);
+        mgr->dispatch_started = false;
+    }
+
+    lock_all_shards(mgr);
     pthread_mutex_lock(&mgr->lock);
-    mac_lookup_task_list_free(mgr->mac_need_refresh_head);
-    mac_lookup_task_list_free(mgr->mac_pending_verify_head);
+    mac_lookup_task_list_free(mgr, mgr->mac_need_refresh_head);
+    mac_lookup_task_list_free(mgr, mgr->mac_pending_verify_head);
     mgr->mac_need_refresh_head = NULL;
     mgr->mac_need_refresh_tail = NULL;
     mgr->mac_pending_verify_head = NULL;
     mgr->mac_pending_verify_tail = NULL;
     for (int vid = 0; vid < TD_PENDING_VLAN_CAPACITY; ++vid) {
-        struct pending_vlan_entry *node = mgr->pending_vlans[vid].head;
-        while (node) {
-            struct pending_vlan_entry *next = node->next;
-            free(node);
-            node = next;
-        }
         pending_reset_bucket(&mgr->pending_vlans[vid]);
     }
-    for (size_t i = 0; i < TERMINAL_BUCKET_COUNT; ++i) {
-        struct terminal_entry *node = mgr->table[i];
-        while (node) {
-            struct terminal_entry *next = node->next;
-            free(node);
-            node = next;
-        }
-        mgr->table[i] = NULL;
+    for (size_t i = 0; i < TERMINAL_SHARD_COUNT; ++i) {
+        terminal_table_free(mgr, &mgr->tables[i]);
     }
     struct iface_record *record = mgr->iface_records;
     while (record) {
@@ -1497,22 +2722,46 @@ void terminal_manager_destroy(struct terminal_manager *mgr) {
             free(prefix);
             prefix = next_prefix;
         }
-        struct iface_binding_entry *binding = record->bindings;
-        while (binding) {
-            struct iface_binding_entry *next_binding = binding->next;
-            free(binding);
-            binding = next_binding;
-        }
         free(record);
         record = next_record;
     }
     mgr->iface_records = NULL;
-    free_event_queue(&mgr->events);
+    mgr->iface_records_tail = &mgr->iface_records;
+    free(mgr->iface_index);
+    mgr->iface_index = NULL;
+    mgr->iface_index_capacity = 0;
+    mgr->iface_record_count = 0;
+    point_index_free(&mgr->mac_index);
+    point_index_free(&mgr->ip_index);
     pthread_mutex_unlock(&mgr->lock);
+    unlock_all_shards(mgr);
 
     pthread_mutex_destroy(&mgr->lock);
+    for (size_t i = 0; i < TERMINAL_SHARD_COUNT; ++i) {
+        pthread_mutex_destroy(&mgr->shard_locks[i]);
+    }
     pthread_mutex_destroy(&mgr->worker_lock);
     pthread_cond_destroy(&mgr->worker_cond);
+    pthread_mutex_destroy(&mgr->overflow_lock);
+    pthread_mutex_destroy(&mgr->drain_lock);
+    pthread_mutex_destroy(&mgr->dispatch_lock);
+    pthread_cond_destroy(&mgr->dispatch_cond);
+    pthread_cond_destroy(&mgr->flush_cond);
+    /* Queries must have returned by now, so only the published ref remains. */
+    free(mgr->view_snapshot);
+    pthread_mutex_destroy(&mgr->view_lock);
+    pthread_mutex_destroy(&mgr->lookup_batch_lock);
+    free(mgr->lookup_batch_requests);
+    free(mgr->lookup_batch_tasks);
+    terminal_event_ring_destroy(&mgr->event_ring);
+    terminal_event_coalescer_destroy(&mgr->event_overflow);
+    terminal_event_coalescer_destroy(&mgr->event_overflow_spare);
+    terminal_event_coalescer_destroy(&mgr->event_window);
+    free(mgr->dispatch_records);
+    free(mgr->event_journal.records);
+    td_object_pool_destroy(&mgr->entry_pool);
+    td_object_pool_destroy(&mgr->lookup_task_pool);
+    td_object_pool_destroy(&mgr->probe_task_pool);
     free(mgr);
 }
 
@@ -1544,30 +2793,19 @@ static void set_state(struct terminal_entry *entry, terminal_state_t new_state)
     entry->state = new_state;
 }
 
-static void mac_lookup_apply_result(struct terminal_manager *mgr,
+/* Caller holds the shard lock for hash and mgr->lock. */
+static void mac_lookup_apply_locked(struct terminal_manager *mgr,
                                     const struct mac_lookup_task *task,
+                                    uint64_t hash,
                                     td_adapter_result_t rc,
                                     uint32_t ifindex,
                                     uint64_t version) {
-    if (!mgr || !task) {
-        return;
-    }
-
-    pthread_mutex_lock(&mgr->lock);
-
-    if (mgr->destroying) {
-        pthread_mutex_unlock(&mgr->lock);
-        return;
-    }
-
     if (version > mgr->mac_locator_version) {
-        mgr->mac_locator_version = version;
+        __atomic_store_n(&mgr->mac_locator_version, version, __ATOMIC_RELEASE);
     }
 
-    size_t bucket = hash_key(&task->key) % TERMINAL_BUCKET_COUNT;
-    struct terminal_entry *entry = find_entry(mgr, &task->key, bucket, NULL);
+    struct terminal_entry *entry = find_entry(mgr, &task->key, hash);
     if (!entry) {
-        pthread_mutex_unlock(&mgr->lock);
         return;
     }
 
@@ -1579,18 +2817,17 @@ static void mac_lookup_apply_result(struct terminal_manager *mgr,
 
     if (rc == TD_ADAPTER_OK) {
         uint32_t before_ifindex = entry->meta.ifindex;
-        entry->meta.ifindex = ifindex;
+        entry_set_ifindex(mgr, entry, ifindex);
         entry->meta.mac_view_version = version;
         entry->vid_lookup_attempted = true;
         entry->vid_lookup_vlan = entry->meta.vlan_id;
-        if (mgr->event_cb && before_ifindex != entry->meta.ifindex) {
+        if (before_ifindex != entry->meta.ifindex) {
             queue_event(mgr,
                         TERMINAL_EVENT_TAG_MOD,
                         &entry->key,
                         &entry->meta,
                         before_ifindex);
         }
-        pthread_mutex_unlock(&mgr->lock);
         return;
     }
 
@@ -1603,7 +2840,7 @@ static void mac_lookup_apply_result(struct terminal_manager *mgr,
                 entry->meta.mac_view_version = version;
             }
         }
-        if (mgr->event_cb && before_ifindex != entry->meta.ifindex) {
+        if (before_ifindex != entry->meta.ifindex) {
             queue_event(mgr,
                         TERMINAL_EVENT_TAG_MOD,
                         &entry->key,
@@ -1618,13 +2855,160 @@ static void mac_lookup_apply_result(struct terminal_manager *mgr,
         }
     }
 
+}
+
+
+static void mac_lookup_apply_result(struct terminal_manager *mgr,
+                                    const struct mac_lookup_task *task,
+                                    td_adapter_result_t rc,
+                                    uint32_t ifindex,
+                                    uint64_t version) {
+    if (!mgr || !task) {
+        return;
+    }
+
+    pthread_mutex_t *shard_lock = shard_lock_for_hash(mgr, task->hash);
+    pthread_mutex_lock(shard_lock);
+    pthread_mutex_lock(&mgr->lock);
+    if (!mgr->destroying) {
+        mac_lookup_apply_locked(mgr, task, task->hash, rc, ifindex, version);
+    }
     pthread_mutex_unlock(&mgr->lock);
+    pthread_mutex_unlock(shard_lock);
+}
+
+/* Caller holds lookup_batch_lock. */
+static bool mac_lookup_batch_reserve(struct terminal_manager *mgr, size_t count) {
+    if (count <= mgr->lookup_batch_capacity) {
+        return true;
+    }
+    size_t capacity = mgr->lookup_batch_capacity ? mgr->lookup_batch_capacity : TERMINAL_MAC_LOOKUP_LOCAL_BATCH;
+    while (capacity < count) {
+        capacity *= 2U;
+    }
+    struct td_adapter_mac_lookup *requests = realloc(mgr->lookup_batch_requests,
+                                                     capacity * sizeof(*requests));
+    if (!requests) {
+        return false;
+    }
+    mgr->lookup_batch_requests = requests;
+    struct mac_lookup_task **tasks = realloc(mgr->lookup_batch_tasks, capacity * sizeof(*tasks));
+    if (!tasks) {
+        return false;
+    }
+    mgr->lookup_batch_tasks = tasks;
+    mgr->lookup_batch_capacity = capacity;
+    return true;
+}
+
+/* Orders the list by shard into sorted, resolves it in one lookup_batch
+ * call, then applies each shard's results under that shard lock and
+ * mgr->lock alone, so ingest on other shards is not held up. Frees every
+ * task. */
+static void mac_lookup_run_batch(struct terminal_manager *mgr,
+                                 struct mac_lookup_task *tasks,
+                                 size_t count,
+                                 struct td_adapter_mac_lookup *requests,
+                                 struct mac_lookup_task **sorted) {
+    size_t shard_end[TERMINAL_SHARD_COUNT];
+    size_t next[TERMINAL_SHARD_COUNT] = {0};
+    for (const struct mac_lookup_task *node = tasks; node; node = node->next) {
+        next[shard_for_hash(node->hash)] += 1U;
+    }
+    size_t offset = 0;
+    for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+        size_t n = next[shard];
+        next[shard] = offset;
+        offset += n;
+        shard_end[shard] = offset;
+    }
+    for (struct mac_lookup_task *node = tasks; node; node = node->next) {
+        sorted[next[shard_for_hash(node->hash)]++] = node;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(requests[i].mac, sorted[i]->key.mac, ETH_ALEN);
+        requests[i].vlan_id = sorted[i]->vlan_id >= 0 ? (uint16_t)sorted[i]->vlan_id : 0U;
+        requests[i].rc = TD_ADAPTER_ERR_UNSUPPORTED;
+        requests[i].ifindex = 0U;
+        requests[i].version = 0ULL;
+    }
+
+    td_adapter_result_t batch_rc = TD_ADAPTER_ERR_UNSUPPORTED;
+    if (!mgr->destroying) {
+        batch_rc = mgr->mac_locator_ops->lookup_batch(mgr->adapter, requests, count);
+    }
+
+    size_t begin = 0;
+    for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+        size_t end = shard_end[shard];
+        if (begin == end) {
+            continue;
+        }
+        pthread_mutex_lock(&mgr->shard_locks[shard]);
+        pthread_mutex_lock(&mgr->lock);
+        for (size_t i = begin; i < end && !mgr->destroying; ++i) {
+            td_adapter_result_t rc = batch_rc;
+            uint32_t ifindex = 0U;
+            uint64_t version = 0ULL;
+            if (batch_rc == TD_ADAPTER_OK) {
+                rc = requests[i].rc;
+                ifindex = requests[i].ifindex;
+                version = requests[i].version;
+            }
+            if (sorted[i]->vlan_id < 0) {
+                rc = TD_ADAPTER_ERR_UNSUPPORTED;
+            }
+            mac_lookup_apply_locked(mgr, sorted[i], sorted[i]->hash, rc, ifindex, version);
+        }
+        pthread_mutex_unlock(&mgr->lock);
+        pthread_mutex_unlock(&mgr->shard_locks[shard]);
+        begin = end;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        td_object_pool_free(&mgr->lookup_task_pool, sorted[i]);
+    }
+}
+
+/* Resolves the whole list through lookup_batch in one adapter call.
+ * Returns false, leaving tasks untouched, when the batch path is unavailable. */
+static bool mac_lookup_execute_batch(struct terminal_manager *mgr,
+                                     struct mac_lookup_task *tasks) {
+    size_t count = 0;
+    for (const struct mac_lookup_task *node = tasks; node; node = node->next) {
+        ++count;
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    if (count <= TERMINAL_MAC_LOOKUP_LOCAL_BATCH) {
+        struct td_adapter_mac_lookup requests[TERMINAL_MAC_LOOKUP_LOCAL_BATCH];
+        struct mac_lookup_task *sorted[TERMINAL_MAC_LOOKUP_LOCAL_BATCH];
+        mac_lookup_run_batch(mgr, tasks, count, requests, sorted);
+        return true;
+    }
+
+    pthread_mutex_lock(&mgr->lookup_batch_lock);
+    if (!mac_lookup_batch_reserve(mgr, count)) {
+        pthread_mutex_unlock(&mgr->lookup_batch_lock);
+        return false;
+    }
+    mac_lookup_run_batch(mgr, tasks, count, mgr->lookup_batch_requests, mgr->lookup_batch_tasks);
+    pthread_mutex_unlock(&mgr->lookup_batch_lock);
+    return true;
 }
 
 static void mac_lookup_execute(struct terminal_manager *mgr,
                                struct mac_lookup_task *tasks) {
     if (!mgr) {
-        mac_lookup_task_list_free(tasks);
+        return;
+    }
+
+    if (tasks && mgr->mac_locator_ops && mgr->mac_locator_ops->lookup_batch &&
+        mac_lookup_execute_batch(mgr, tasks)) {
+        terminal_manager_maybe_dispatch_events(mgr);
         return;
     }
 
@@ -1644,21 +3028,17 @@ static void mac_lookup_execute(struct terminal_manager *mgr,
         }
 
         mac_lookup_apply_result(mgr, node, rc, ifindex, version);
-        free(node);
+        td_object_pool_free(&mgr->lookup_task_pool, node);
         node = next;
     }
 
     terminal_manager_maybe_dispatch_events(mgr);
 }
 
-void terminal_manager_on_packet(struct terminal_manager *mgr,
-                                const struct td_adapter_packet_view *packet) {
-    if (!mgr || !packet) {
-        return;
-    }
-
+static bool packet_extract_key(const struct td_adapter_packet_view *packet,
+                               struct terminal_key *key_out) {
     if (packet->payload_len < sizeof(struct ether_arp)) {
-        return;
+        return false;
     }
 
     if (!vlan_id_supported(packet->vlan_id)) {
@@ -1666,12 +3046,9 @@ void terminal_manager_on_packet(struct terminal_manager *mgr,
                       "terminal_manager",
                       "ignore packet on unsupported vlan=%d",
                       (int)packet->vlan_id);
-        return;
+        return false;
     }
 
-    struct mac_lookup_task *lookup_head = NULL;
-    struct mac_lookup_task *lookup_tail = NULL;
-
     const struct ether_arp *arp = (const struct ether_arp *)packet->payload;
     struct terminal_key key;
     memcpy(key.mac, arp->arp_sha, ETH_ALEN);
@@ -1691,7 +3068,7 @@ void terminal_manager_on_packet(struct terminal_manager *mgr,
                       key.mac[3],
                       key.mac[4],
                       key.mac[5]);
-        return;
+        return false;
     }
 
     struct in_addr effective_ip = sender_ip;
@@ -1700,28 +3077,97 @@ void terminal_manager_on_packet(struct terminal_manager *mgr,
     }
 
     memcpy(&key.ip.s_addr, &effective_ip.s_addr, sizeof(key.ip.s_addr));
+    *key_out = key;
+    return true;
+}
 
-    size_t bucket = hash_key(&key) % TERMINAL_BUCKET_COUNT;
+static bool mac_lookup_task_list_contains(const struct mac_lookup_task *head,
+                                          const struct terminal_key *key) {
+    for (const struct mac_lookup_task *node = head; node; node = node->next) {
+        if (memcmp(node->key.mac, key->mac, ETH_ALEN) == 0 &&
+            node->key.ip.s_addr == key->ip.s_addr) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    pthread_mutex_lock(&mgr->lock);
+/* Caller holds the entry's shard lock; mgr->lock is not needed. Handles the
+ * common packet from an ACTIVE terminal on the VLAN, port and interface
+ * record generation it was last resolved against, with no MAC lookup
+ * outstanding: nothing but liveness can change, so resolve_tx_interface is
+ * skipped. The bound record cannot be freed while the entry is on its
+ * binding list, and the locator version and record generation are read
+ * atomically. Returns false when the full ingest path must run. */
+static bool terminal_refresh_if_unchanged(struct terminal_manager *mgr,
+                                          struct terminal_entry *entry,
+                                          const struct td_adapter_packet_view *packet) {
+    if (entry->state != TERMINAL_STATE_ACTIVE ||
+        entry->tx_kernel_ifindex <= 0 ||
+        entry->meta.vlan_id != packet->vlan_id) {
+        return false;
+    }
+    if (packet->ifindex > 0U && packet->ifindex != entry->meta.ifindex) {
+        return false;
+    }
+    if (mgr->mac_locator_ops) {
+        uint64_t locator_version = __atomic_load_n(&mgr->mac_locator_version, __ATOMIC_ACQUIRE);
+        if (locator_version == 0 ||
+            entry->meta.ifindex == 0U ||
+            entry->meta.mac_view_version < locator_version) {
+            return false;
+        }
+    }
+
+    const struct iface_record *record = entry->tx_iface_record;
+    if (!record ||
+        __atomic_load_n(&record->generation, __ATOMIC_ACQUIRE) != entry->tx_iface_generation) {
+        return false;
+    }
+
+    /* The timer deadline only moves later here, which the wheel picks up
+     * lazily when it fires. */
+    entry->failed_probes = 0;
+    monotonic_now(&entry->last_seen);
+    return true;
+}
 
+/* Caller holds the shard lock for hash only. Drops packets on ignored VLANs
+ * and refreshes terminals terminal_refresh_if_unchanged accepts; returns
+ * false when terminal_manager_ingest_locked has to run under mgr->lock. */
+static bool terminal_manager_ingest_fast(struct terminal_manager *mgr,
+                                         const struct td_adapter_packet_view *packet,
+                                         const struct terminal_key *key,
+                                         uint64_t hash) {
     if (vlan_is_ignored(mgr, packet->vlan_id)) {
-        pthread_mutex_unlock(&mgr->lock);
         td_log_writef(TD_LOG_DEBUG,
                       "terminal_manager",
                       "ignored packet on vlan=%d",
                       packet->vlan_id);
-        return;
+        return true;
     }
 
-    bool track_events = mgr->event_cb != NULL;
+    struct terminal_entry *entry = find_entry(mgr, key, hash);
+    return entry && terminal_refresh_if_unchanged(mgr, entry, packet);
+}
+
+/* Caller holds the shard lock for hash and mgr->lock, after
+ * terminal_manager_ingest_fast declined the packet. Immediate MAC lookups
+ * are appended to the given list. */
+static void terminal_manager_ingest_locked(struct terminal_manager *mgr,
+                                           const struct td_adapter_packet_view *packet,
+                                           const struct terminal_key *key_in,
+                                           uint64_t hash,
+                                           struct mac_lookup_task **lookup_head,
+                                           struct mac_lookup_task **lookup_tail) {
+    struct terminal_key key = *key_in;
+
     bool newly_created = false;
     terminal_snapshot_t before_snapshot;
     bool have_before_snapshot = false;
     int previous_vlan = -1;
 
-    struct terminal_entry **prev_next = NULL;
-    struct terminal_entry *entry = find_entry(mgr, &key, bucket, &prev_next);
+    struct terminal_entry *entry = find_entry(mgr, &key, hash);
     if (entry) {
         previous_vlan = entry->meta.vlan_id;
     }
@@ -1739,7 +3185,29 @@ void terminal_manager_on_packet(struct terminal_manager *mgr,
                           mac_buf,
                           ip_buf);
             mgr->stats.capacity_drops += 1;
-            pthread_mutex_unlock(&mgr->lock);
+            return;
+        }
+        struct terminal_table *table = table_for_hash(mgr, hash);
+        if (terminal_table_reserve(table) != 0) {
+            char mac_buf[18];
+            char ip_buf[INET_ADDRSTRLEN];
+            format_terminal_identity(&key, mac_buf, ip_buf);
+            td_log_writef(TD_LOG_ERROR,
+                          "terminal_manager",
+                          "failed to grow terminal table for %s/%s",
+                          mac_buf,
+                          ip_buf);
+            return;
+        }
+        if (terminal_index_reserve(mgr) != 0) {
+            char mac_buf[18];
+            char ip_buf[INET_ADDRSTRLEN];
+            format_terminal_identity(&key, mac_buf, ip_buf);
+            td_log_writef(TD_LOG_ERROR,
+                          "terminal_manager",
+                          "failed to grow terminal indexes for %s/%s",
+                          mac_buf,
+                          ip_buf);
             return;
         }
         entry = create_entry(&key, mgr, packet);
@@ -1752,11 +3220,10 @@ void terminal_manager_on_packet(struct terminal_manager *mgr,
                           "failed to allocate terminal entry for %s/%s",
                           mac_buf,
                           ip_buf);
-            pthread_mutex_unlock(&mgr->lock);
             return;
         }
-        entry->next = mgr->table[bucket];
-        mgr->table[bucket] = entry;
+        terminal_table_insert(table, entry, hash);
+        terminal_index_insert(mgr, entry);
         td_log_writef(TD_LOG_INFO,
                       "terminal_manager",
                       "new terminal discovered on %s vlan=%d",
@@ -1767,18 +3234,15 @@ void terminal_manager_on_packet(struct terminal_manager *mgr,
         mgr->stats.terminals_discovered += 1;
         mgr->stats.current_terminals = mgr->terminal_count;
     } else {
-        if (track_events) {
-            snapshot_from_entry(entry, &before_snapshot);
-            have_before_snapshot = true;
-        }
-    monotonic_now(&entry->last_seen);
+        snapshot_from_entry(entry, &before_snapshot);
+        have_before_snapshot = true;
         apply_packet_binding(mgr, entry, packet);
     }
 
     bool vlan_changed = (!newly_created) && (previous_vlan != entry->meta.vlan_id);
     if (vlan_changed) {
         if (packet->ifindex > 0U) {
-            entry->meta.ifindex = packet->ifindex;
+            entry_set_ifindex(mgr, entry, packet->ifindex);
         }
         entry->meta.mac_view_version = 0ULL;
         entry->vid_lookup_attempted = false;
@@ -1809,7 +3273,7 @@ void terminal_manager_on_packet(struct terminal_manager *mgr,
                                                                          (uint16_t)entry->meta.vlan_id,
                                                                          &resolved_ifindex);
             if (rc == TD_ADAPTER_OK) {
-                entry->meta.ifindex = resolved_ifindex;
+                entry_set_ifindex(mgr, entry, resolved_ifindex);
                 entry->meta.mac_view_version = mgr->mac_locator_version;
                 entry->vid_lookup_attempted = true;
                 entry->vid_lookup_vlan = entry->meta.vlan_id;
@@ -1836,30 +3300,145 @@ void terminal_manager_on_packet(struct terminal_manager *mgr,
         }
 
         if (wants_lookup) {
-            if (version_ready) {
-                struct mac_lookup_task *task = mac_lookup_task_create(&entry->key,
+            if (version_ready && !mac_lookup_task_list_contains(*lookup_head, &entry->key)) {
+                struct mac_lookup_task *task = mac_lookup_task_create(mgr, &entry->key,
                                                                       entry->meta.vlan_id,
                                                                       false);
                 if (task) {
-                    mac_lookup_task_append_node(&lookup_head, &lookup_tail, task);
+                    mac_lookup_task_append_node(lookup_head, lookup_tail, task);
                 } else {
                     td_log_writef(TD_LOG_WARN,
                                   "terminal_manager",
                                   "failed to allocate immediate mac lookup task");
                 }
-            } else {
+            } else if (!version_ready) {
                 enqueue_need_refresh(mgr, entry);
             }
         }
     }
 
+    timer_pull_in(mgr, entry);
+
     if (newly_created) {
         queue_add_event(mgr, entry);
     } else if (have_before_snapshot) {
         queue_modify_event_if_ifindex_changed(mgr, &before_snapshot, entry);
     }
+}
+
+void terminal_manager_on_packet(struct terminal_manager *mgr,
+                                const struct td_adapter_packet_view *packet) {
+    if (!mgr || !packet) {
+        return;
+    }
+
+    struct terminal_key key;
+    if (!packet_extract_key(packet, &key)) {
+        return;
+    }
+
+    struct mac_lookup_task *lookup_head = NULL;
+    struct mac_lookup_task *lookup_tail = NULL;
 
+    uint64_t hash = hash_key(&key);
+    pthread_mutex_t *shard_lock = shard_lock_for_hash(mgr, hash);
+    pthread_mutex_lock(shard_lock);
+    if (terminal_manager_ingest_fast(mgr, packet, &key, hash)) {
+        pthread_mutex_unlock(shard_lock);
+        return;
+    }
+    pthread_mutex_lock(&mgr->lock);
+    terminal_manager_ingest_locked(mgr, packet, &key, hash, &lookup_head, &lookup_tail);
     pthread_mutex_unlock(&mgr->lock);
+    pthread_mutex_unlock(shard_lock);
+
+    mac_lookup_execute(mgr, lookup_head);
+}
+
+struct ingest_batch_item {
+    struct terminal_key key;
+    uint64_t hash;
+    const struct td_adapter_packet_view *packet;
+};
+
+/* Stable counting sort of items by shard; shard_end[s] is one past the last
+ * item of shard s in sorted. */
+static void ingest_batch_sort(const struct ingest_batch_item *items,
+                              size_t count,
+                              struct ingest_batch_item *sorted,
+                              size_t shard_end[TERMINAL_SHARD_COUNT]) {
+    size_t next[TERMINAL_SHARD_COUNT] = {0};
+    for (size_t i = 0; i < count; ++i) {
+        next[shard_for_hash(items[i].hash)] += 1U;
+    }
+    size_t offset = 0;
+    for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+        size_t n = next[shard];
+        next[shard] = offset;
+        offset += n;
+        shard_end[shard] = offset;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        sorted[next[shard_for_hash(items[i].hash)]++] = items[i];
+    }
+}
+
+void terminal_manager_on_packet_batch(struct terminal_manager *mgr,
+                                      const struct td_adapter_packet_view *packets,
+                                      size_t count) {
+    if (!mgr || !packets || count == 0) {
+        return;
+    }
+
+    struct mac_lookup_task *lookup_head = NULL;
+    struct mac_lookup_task *lookup_tail = NULL;
+    struct ingest_batch_item items[TERMINAL_INGEST_BATCH_CHUNK];
+    struct ingest_batch_item sorted[TERMINAL_INGEST_BATCH_CHUNK];
+    size_t shard_end[TERMINAL_SHARD_COUNT];
+
+    /* Each shard lock is taken once per chunk; mgr->lock only from the first
+     * packet of a shard group the fast path declines, held to the group's
+     * end. Packets of one terminal share a shard, so their order holds. */
+    size_t pos = 0;
+    while (pos < count) {
+        size_t n = 0;
+        for (; pos < count && n < TERMINAL_INGEST_BATCH_CHUNK; ++pos) {
+            if (!packet_extract_key(&packets[pos], &items[n].key)) {
+                continue;
+            }
+            items[n].hash = hash_key(&items[n].key);
+            items[n].packet = &packets[pos];
+            n += 1U;
+        }
+        ingest_batch_sort(items, n, sorted, shard_end);
+
+        size_t begin = 0;
+        for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+            size_t end = shard_end[shard];
+            if (begin == end) {
+                continue;
+            }
+            bool have_lock = false;
+            pthread_mutex_lock(&mgr->shard_locks[shard]);
+            for (size_t i = begin; i < end; ++i) {
+                const struct ingest_batch_item *item = &sorted[i];
+                if (terminal_manager_ingest_fast(mgr, item->packet, &item->key, item->hash)) {
+                    continue;
+                }
+                if (!have_lock) {
+                    pthread_mutex_lock(&mgr->lock);
+                    have_lock = true;
+                }
+                terminal_manager_ingest_locked(mgr, item->packet, &item->key, item->hash,
+                                               &lookup_head, &lookup_tail);
+            }
+            if (have_lock) {
+                pthread_mutex_unlock(&mgr->lock);
+            }
+            pthread_mutex_unlock(&mgr->shard_locks[shard]);
+            begin = end;
+        }
+    }
 
     mac_lookup_execute(mgr, lookup_head);
 }
@@ -1901,29 +3480,21 @@ static void terminal_manager_run_address_sync(struct terminal_manager *mgr) {
 }
 
 static bool vlan_is_ignored(const struct terminal_manager *mgr, int vlan_id) {
-    if (!mgr || !vlan_id_supported(vlan_id) || mgr->cfg.ignored_vlan_count == 0) {
+    if (!mgr || !vlan_id_supported(vlan_id)) {
         return false;
     }
-
-    uint16_t vlan = (uint16_t)vlan_id;
-    for (size_t i = 0; i < mgr->cfg.ignored_vlan_count; ++i) {
-        if (mgr->cfg.ignored_vlans[i] == vlan) {
-            return true;
-        }
-    }
-    return false;
+    return __atomic_load_n(&mgr->vlan_ignored[vlan_id], __ATOMIC_RELAXED);
 }
 
-static bool has_expired(const struct terminal_manager *mgr,
+static bool has_expired(unsigned int holdoff_sec,
                         const struct terminal_entry *entry,
                         const struct timespec *now) {
-    (void)mgr;
     if (entry->state != TERMINAL_STATE_IFACE_INVALID) {
         return false;
     }
 
     uint64_t elapsed_ms = timespec_diff_ms(&entry->last_seen, now);
-    uint64_t holdoff_ms = (uint64_t)mgr->cfg.iface_invalid_holdoff_sec * 1000ULL;
+    uint64_t holdoff_ms = (uint64_t)holdoff_sec * 1000ULL;
     return elapsed_ms >= holdoff_ms;
 }
 
@@ -1937,33 +3508,42 @@ void terminal_manager_on_timer(struct terminal_manager *mgr) {
     struct timespec now;
     monotonic_now(&now);
 
-    pthread_mutex_lock(&mgr->lock);
-
     struct probe_task *tasks_head = NULL;
     struct probe_task *tasks_tail = NULL;
-    bool track_events = mgr->event_cb != NULL;
     struct mac_lookup_task *lookup_head = NULL;
     struct mac_lookup_task *lookup_tail = NULL;
 
-    for (size_t i = 0; i < TERMINAL_BUCKET_COUNT; ++i) {
-        struct terminal_entry **prev_next = &mgr->table[i];
-        struct terminal_entry *entry = mgr->table[i];
-        while (entry) {
+    /* Visit one shard at a time, touching only the entries its timer wheel
+     * reports due, and take mgr->lock only around shared bookkeeping. */
+    for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+        pthread_mutex_lock(&mgr->shard_locks[shard]);
+
+        pthread_mutex_lock(&mgr->lock);
+        uint64_t locator_version = mgr->mac_locator_version;
+        unsigned int keepalive_interval_sec = mgr->cfg.keepalive_interval_sec;
+        unsigned int keepalive_miss_threshold = mgr->cfg.keepalive_miss_threshold;
+        unsigned int holdoff_sec = mgr->cfg.iface_invalid_holdoff_sec;
+        pthread_mutex_unlock(&mgr->lock);
+
+        uint64_t probes_scheduled = 0;
+        struct terminal_table *table = &mgr->tables[shard];
+        struct terminal_timer_wheel *wheel = &mgr->timer_wheels[shard];
+        struct terminal_entry *due = NULL;
+        timer_wheel_advance(wheel, (uint64_t)now.tv_sec, &due);
+
+        while (due) {
+            struct terminal_entry *entry = due;
+            timer_unlink(entry);
             bool remove = false;
             bool removed_due_to_probe_failure = false;
             terminal_snapshot_t before_snapshot;
-            bool have_before_snapshot = false;
-
-            if (track_events) {
-                snapshot_from_entry(entry, &before_snapshot);
-                have_before_snapshot = true;
-            }
+            snapshot_from_entry(entry, &before_snapshot);
 
             if (mgr->mac_locator_ops) {
                 if (entry->state == TERMINAL_STATE_IFACE_INVALID) {
-                    if (mgr->mac_locator_version > 0 &&
-                        entry->meta.mac_view_version < mgr->mac_locator_version) {
-                        struct mac_lookup_task *task = mac_lookup_task_create(&entry->key,
+                    if (locator_version > 0 &&
+                        entry->meta.mac_view_version < locator_version) {
+                        struct mac_lookup_task *task = mac_lookup_task_create(mgr, &entry->key,
                                                                               entry->meta.vlan_id,
                                                                               false);
                         if (task) {
@@ -1973,23 +3553,25 @@ void terminal_manager_on_timer(struct terminal_manager *mgr) {
                                           "terminal_manager",
                                           "failed to allocate timer mac lookup task");
                         }
-                    } else if (mgr->mac_locator_version == 0 && entry->meta.ifindex == 0) {
+                    } else if (locator_version == 0 && entry->meta.ifindex == 0) {
+                        pthread_mutex_lock(&mgr->lock);
                         enqueue_need_refresh(mgr, entry);
+                        pthread_mutex_unlock(&mgr->lock);
                     }
                 }
             }
 
-            if (has_expired(mgr, entry, &now)) {
+            if (has_expired(holdoff_sec, entry, &now)) {
                 td_log_writef(TD_LOG_INFO,
                               "terminal_manager",
                               "terminal expired after iface invalid holdoff: state=%s", state_to_string(entry->state));
                 remove = true;
             } else {
                 time_t since_last_seen = now.tv_sec - entry->last_seen.tv_sec;
-                time_t since_last_probe = entry->last_probe.tv_sec ? (now.tv_sec - entry->last_probe.tv_sec) : (time_t)mgr->cfg.keepalive_interval_sec;
+                time_t since_last_probe = entry->last_probe.tv_sec ? (now.tv_sec - entry->last_probe.tv_sec) : (time_t)keepalive_interval_sec;
 
-                bool need_probe = since_last_seen >= (time_t)mgr->cfg.keepalive_interval_sec &&
-                                   since_last_probe >= (time_t)mgr->cfg.keepalive_interval_sec;
+                bool need_probe = since_last_seen >= (time_t)keepalive_interval_sec &&
+                                   since_last_probe >= (time_t)keepalive_interval_sec;
 
                 if (need_probe) {
                     if (!is_iface_available(entry)) {
@@ -2000,7 +3582,7 @@ void terminal_manager_on_timer(struct terminal_manager *mgr) {
                         entry->failed_probes += 1;
 
                         if (mgr->probe_cb) {
-                            struct probe_task *task = calloc(1, sizeof(*task));
+                            struct probe_task *task = td_object_pool_alloc(&mgr->probe_task_pool);
                             if (task) {
                                 task->request.key = entry->key;
                                 snprintf(task->request.tx_iface, sizeof(task->request.tx_iface), "%s", entry->tx_iface);
@@ -2015,7 +3597,7 @@ void terminal_manager_on_timer(struct terminal_manager *mgr) {
                                     tasks_tail->next = task;
                                     tasks_tail = task;
                                 }
-                                mgr->stats.probes_scheduled += 1;
+                                probes_scheduled += 1;
                             } else {
                                 td_log_writef(TD_LOG_WARN,
                                               "terminal_manager",
@@ -2023,7 +3605,7 @@ void terminal_manager_on_timer(struct terminal_manager *mgr) {
                             }
                         }
 
-                        if (entry->failed_probes >= mgr->cfg.keepalive_miss_threshold) {
+                        if (entry->failed_probes >= keepalive_miss_threshold) {
                             td_log_writef(TD_LOG_INFO,
                                           "terminal_manager",
                                           "terminal exceeded probe failure threshold (iface=%s)",
@@ -2037,16 +3619,16 @@ void terminal_manager_on_timer(struct terminal_manager *mgr) {
 
             if (remove) {
                 struct terminal_entry *to_free = entry;
+                pthread_mutex_lock(&mgr->lock);
                 if (to_free->tx_kernel_ifindex > 0) {
                     iface_binding_detach(mgr, to_free->tx_kernel_ifindex, to_free);
                 }
-                if (track_events) {
-                    terminal_snapshot_t remove_snapshot;
-                    snapshot_from_entry(entry, &remove_snapshot);
-                    queue_remove_event(mgr, &remove_snapshot);
-                }
-                *prev_next = entry->next;
-                entry = entry->next;
+                pending_detach(mgr, to_free);
+                terminal_index_remove(mgr, to_free);
+                terminal_snapshot_t remove_snapshot;
+                snapshot_from_entry(entry, &remove_snapshot);
+                queue_remove_event(mgr, &remove_snapshot);
+                terminal_table_remove(table, to_free, hash_key(&to_free->key));
                 if (mgr->terminal_count > 0) {
                     mgr->terminal_count -= 1;
                 }
@@ -2055,18 +3637,30 @@ void terminal_manager_on_timer(struct terminal_manager *mgr) {
                 if (removed_due_to_probe_failure) {
                     mgr->stats.probe_failures += 1;
                 }
-                free(to_free);
+                pthread_mutex_unlock(&mgr->lock);
+                td_object_pool_free(&mgr->entry_pool, to_free);
             } else {
-                if (have_before_snapshot) {
+                if (before_snapshot.meta.ifindex != entry->meta.ifindex) {
+                    pthread_mutex_lock(&mgr->lock);
                     queue_modify_event_if_ifindex_changed(mgr, &before_snapshot, entry);
+                    pthread_mutex_unlock(&mgr->lock);
                 }
-                prev_next = &entry->next;
-                entry = entry->next;
+                timer_wheel_schedule(wheel,
+                                     entry,
+                                     timer_deadline_for_entry(entry,
+                                                              keepalive_interval_sec,
+                                                              holdoff_sec,
+                                                              mgr->mac_locator_ops != NULL));
             }
         }
-    }
 
-    pthread_mutex_unlock(&mgr->lock);
+        if (probes_scheduled > 0) {
+            pthread_mutex_lock(&mgr->lock);
+            mgr->stats.probes_scheduled += probes_scheduled;
+            pthread_mutex_unlock(&mgr->lock);
+        }
+        pthread_mutex_unlock(&mgr->shard_locks[shard]);
+    }
 
     mac_lookup_execute(mgr, lookup_head);
 
@@ -2077,15 +3671,74 @@ void terminal_manager_on_timer(struct terminal_manager *mgr) {
             mgr->probe_cb(&task->request, mgr->probe_ctx);
         }
         struct probe_task *next = task->next;
-        free(task);
+        td_object_pool_free(&mgr->probe_task_pool, task);
         task = next;
     }
 
     terminal_manager_maybe_dispatch_events(mgr);
 }
 
-static void mac_locator_on_refresh(uint64_t version, void *ctx) {
-    struct terminal_manager *mgr = (struct terminal_manager *)ctx;
+/* (mac, vlan) keys named by a delta batch, open addressed over the batch. */
+struct mac_delta_set {
+    const struct td_adapter_mac_delta *deltas;
+    uint32_t *slots; /* delta position + 1, 0 = empty */
+    size_t mask;
+};
+
+static uint32_t mac_delta_hash(const uint8_t mac[ETH_ALEN], uint16_t vlan_id) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < ETH_ALEN; ++i) {
+        hash ^= mac[i];
+        hash *= 16777619u;
+    }
+    hash ^= vlan_id;
+    hash *= 16777619u;
+    return hash;
+}
+
+static bool mac_delta_set_build(struct mac_delta_set *set,
+                                const struct td_adapter_mac_delta_batch *batch) {
+    size_t size = 2U;
+    while (size < batch->count * 2U) {
+        size <<= 1U;
+    }
+    set->slots = calloc(size, sizeof(*set->slots));
+    if (!set->slots) {
+        return false;
+    }
+    set->deltas = batch->deltas;
+    set->mask = size - 1U;
+    for (size_t i = 0; i < batch->count; ++i) {
+        size_t slot = mac_delta_hash(batch->deltas[i].mac, batch->deltas[i].vlan_id) & set->mask;
+        while (set->slots[slot] != 0U) {
+            slot = (slot + 1U) & set->mask;
+        }
+        set->slots[slot] = (uint32_t)(i + 1U);
+    }
+    return true;
+}
+
+static bool mac_delta_set_contains(const struct mac_delta_set *set,
+                                   const uint8_t mac[ETH_ALEN],
+                                   uint16_t vlan_id) {
+    size_t slot = mac_delta_hash(mac, vlan_id) & set->mask;
+    while (set->slots[slot] != 0U) {
+        const struct td_adapter_mac_delta *delta = &set->deltas[set->slots[slot] - 1U];
+        if (delta->vlan_id == vlan_id && memcmp(delta->mac, mac, ETH_ALEN) == 0) {
+            return true;
+        }
+        slot = (slot + 1U) & set->mask;
+    }
+    return false;
+}
+
+/* Queues lookups for terminals whose binding may be stale against version.
+ * With a change set, a terminal already verified at base_version or later
+ * whose key did not change is simply advanced to version without a lookup. */
+static void mac_locator_reverify(struct terminal_manager *mgr,
+                                 uint64_t version,
+                                 const struct mac_delta_set *changed,
+                                 uint64_t base_version) {
     if (!mgr || mgr->destroying) {
         return;
     }
@@ -2111,7 +3764,7 @@ static void mac_locator_on_refresh(uint64_t version, void *ctx) {
     }
 
     if (version > mgr->mac_locator_version) {
-        mgr->mac_locator_version = version;
+        __atomic_store_n(&mgr->mac_locator_version, version, __ATOMIC_RELEASE);
     }
 
     refresh_head = mgr->mac_need_refresh_head;
@@ -2124,50 +3777,86 @@ static void mac_locator_on_refresh(uint64_t version, void *ctx) {
     mgr->mac_pending_verify_head = NULL;
     mgr->mac_pending_verify_tail = NULL;
 
-    for (size_t i = 0; i < TERMINAL_BUCKET_COUNT; ++i) {
-        for (struct terminal_entry *entry = mgr->table[i]; entry; entry = entry->next) {
-            if (entry->meta.ifindex == 0) {
-                entry->vid_lookup_attempted = false;
-                entry->vid_lookup_vlan = -1;
-                if (!entry->mac_refresh_enqueued) {
-                    struct mac_lookup_task *task = mac_lookup_task_create(&entry->key,
-                                                                          entry->meta.vlan_id,
-                                                                          false);
-                    if (task) {
-                        mac_lookup_task_append_node(&refresh_head, &refresh_tail, task);
-                        entry->mac_refresh_enqueued = true;
-                    } else {
-                        td_log_writef(TD_LOG_WARN,
-                                      "terminal_manager",
-                                      "failed to allocate mac refresh task on callback");
+    pthread_mutex_unlock(&mgr->lock);
+
+    for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+        pthread_mutex_lock(&mgr->shard_locks[shard]);
+        struct terminal_table *table = &mgr->tables[shard];
+        terminal_table_finish_migration(table);
+        for (size_t i = 0; i < table->capacity; ++i) {
+            struct terminal_entry *entry = table->slots[i].entry;
+            if (entry) {
+                if (changed && entry->meta.mac_view_version >= base_version &&
+                    !mac_delta_set_contains(changed, entry->key.mac, (uint16_t)entry->meta.vlan_id)) {
+                    if (entry->meta.mac_view_version < version) {
+                        entry->meta.mac_view_version = version;
                     }
+                    continue;
                 }
-            } else if (entry->meta.mac_view_version < version) {
-                entry->vid_lookup_attempted = false;
-                entry->vid_lookup_vlan = -1;
-                if (!entry->mac_verify_enqueued) {
-                    struct mac_lookup_task *task = mac_lookup_task_create(&entry->key,
-                                                                          entry->meta.vlan_id,
-                                                                          true);
-                    if (task) {
-                        mac_lookup_task_append_node(&verify_head, &verify_tail, task);
-                        entry->mac_verify_enqueued = true;
-                    } else {
-                        td_log_writef(TD_LOG_WARN,
-                                      "terminal_manager",
-                                      "failed to allocate mac verify task on callback");
+                if (entry->meta.ifindex == 0) {
+                    entry->vid_lookup_attempted = false;
+                    entry->vid_lookup_vlan = -1;
+                    if (!entry->mac_refresh_enqueued) {
+                        struct mac_lookup_task *task = mac_lookup_task_create(mgr, &entry->key,
+                                                                              entry->meta.vlan_id,
+                                                                              false);
+                        if (task) {
+                            mac_lookup_task_append_node(&refresh_head, &refresh_tail, task);
+                            entry->mac_refresh_enqueued = true;
+                        } else {
+                            td_log_writef(TD_LOG_WARN,
+                                          "terminal_manager",
+                                          "failed to allocate mac refresh task on callback");
+                        }
+                    }
+                } else if (entry->meta.mac_view_version < version) {
+                    entry->vid_lookup_attempted = false;
+                    entry->vid_lookup_vlan = -1;
+                    if (!entry->mac_verify_enqueued) {
+                        struct mac_lookup_task *task = mac_lookup_task_create(mgr, &entry->key,
+                                                                              entry->meta.vlan_id,
+                                                                              true);
+                        if (task) {
+                            mac_lookup_task_append_node(&verify_head, &verify_tail, task);
+                            entry->mac_verify_enqueued = true;
+                        } else {
+                            td_log_writef(TD_LOG_WARN,
+                                          "terminal_manager",
+                                          "failed to allocate mac verify task on callback");
+                        }
                     }
                 }
             }
         }
+        pthread_mutex_unlock(&mgr->shard_locks[shard]);
     }
 
-    pthread_mutex_unlock(&mgr->lock);
-
     mac_lookup_execute(mgr, refresh_head);
     mac_lookup_execute(mgr, verify_head);
 }
 
+static void mac_locator_on_refresh(uint64_t version, void *ctx) {
+    mac_locator_reverify((struct terminal_manager *)ctx, version, NULL, 0ULL);
+}
+
+static void mac_locator_on_delta(const struct td_adapter_mac_delta_batch *batch, void *ctx) {
+    struct terminal_manager *mgr = (struct terminal_manager *)ctx;
+    if (!mgr || !batch) {
+        return;
+    }
+
+    /* Without a usable diff fall back to checking every cached binding. */
+    struct mac_delta_set changed;
+    if (batch->version == 0ULL || batch->base_version == 0ULL ||
+        (batch->count > 0 && !batch->deltas) || !mac_delta_set_build(&changed, batch)) {
+        mac_locator_reverify(mgr, batch->version, NULL, 0ULL);
+        return;
+    }
+
+    mac_locator_reverify(mgr, batch->version, &changed, batch->base_version);
+    free(changed.slots);
+}
+
 void terminal_manager_on_address_update(struct terminal_manager *mgr,
                                         const terminal_address_update_t *update) {
     if (!mgr || !update || update->kernel_ifindex <= 0) {
@@ -2182,6 +3871,8 @@ void terminal_manager_on_address_update(struct terminal_manager *mgr,
         return;
     }
 
+    /* Bindings and pending lists point into every shard, so take them all. */
+    lock_all_shards(mgr);
     pthread_mutex_lock(&mgr->lock);
     mgr->stats.address_update_events += 1;
 
@@ -2194,6 +3885,7 @@ void terminal_manager_on_address_update(struct terminal_manager *mgr,
                               update->address,
                               update->prefix_len)) {
             pthread_mutex_unlock(&mgr->lock);
+        unlock_all_shards(mgr);
             return;
         }
         retry_pending = true;
@@ -2205,64 +3897,186 @@ void terminal_manager_on_address_update(struct terminal_manager *mgr,
                             update->prefix_len);
     }
 
-    struct iface_record **slot = find_iface_record_slot(mgr, update->kernel_ifindex);
-    struct iface_record *record = slot ? *slot : NULL;
-    if (!record) {
+    struct iface_record *record = get_iface_record(mgr, update->kernel_ifindex);
+    if (!record) {
+        pthread_mutex_unlock(&mgr->lock);
+        unlock_all_shards(mgr);
+        return;
+    }
+
+    struct terminal_entry *terminal = record->bindings;
+    while (terminal) {
+        struct terminal_entry *next = terminal->binding_next;
+        if (update->is_add) {
+            struct in_addr refreshed_ip;
+            if (iface_record_select_ip(record, terminal->key.ip, &refreshed_ip)) {
+                terminal->tx_source_ip = refreshed_ip;
+            }
+            terminal = next;
+            continue;
+        }
+
+        if (!iface_record_matches_ip(record, terminal->key.ip)) {
+            iface_binding_unlink(terminal);
+            terminal->tx_iface[0] = '\0';
+            terminal->tx_kernel_ifindex = -1;
+            terminal->tx_source_ip.s_addr = 0;
+            pending_attach(mgr, terminal, terminal->meta.vlan_id);
+            monotonic_now(&terminal->last_seen);
+            set_state(terminal, TERMINAL_STATE_IFACE_INVALID);
+            timer_pull_in(mgr, terminal);
+        }
+        terminal = next;
+    }
+
+    iface_record_prune_if_empty(mgr, record);
+
+    if (retry_pending) {
+        pending_retry_for_ifindex(mgr, update->kernel_ifindex);
+    }
+
+    pthread_mutex_unlock(&mgr->lock);
+    unlock_all_shards(mgr);
+}
+
+void terminal_manager_set_address_sync_handler(struct terminal_manager *mgr,
+                                               terminal_address_sync_fn handler,
+                                               void *handler_ctx) {
+    if (!mgr) {
+        return;
+    }
+
+    pthread_mutex_lock(&mgr->lock);
+    mgr->address_sync_cb = handler;
+    mgr->address_sync_ctx = handler_ctx;
+    if (!handler) {
+        mgr->address_sync_pending = false;
+        mgr->address_sync_in_progress = false;
+    }
+    pthread_mutex_unlock(&mgr->lock);
+}
+
+/* Returns the VLAN whose interface name is exactly ifname under format. */
+static bool vlan_from_link_name(const char *format, const char *ifname, int *vlan_out) {
+    int vlan_id = -1;
+    if (!parse_vlan_from_ifname(format, ifname, &vlan_id)) {
+        return false;
+    }
+    char expected[IFNAMSIZ];
+    snprintf(expected, sizeof(expected), format, (unsigned int)vlan_id);
+    if (strncmp(expected, ifname, sizeof(expected)) != 0) {
+        return false;
+    }
+    *vlan_out = vlan_id;
+    return true;
+}
+
+/* Called under lock while a link dump is in flight. Records live deletions
+ * and returns true for dump replies about an ifindex already deleted since
+ * the dump began: the reply may predate the DELLINK, and the live events
+ * have the final say on that ifindex. */
+static bool link_resync_filter(struct terminal_manager *mgr,
+                               const terminal_link_update_t *update) {
+    bool seen = false;
+    for (size_t i = 0; i < mgr->link_resync_deleted_count; ++i) {
+        if (mgr->link_resync_deleted[i] == update->kernel_ifindex) {
+            seen = true;
+            break;
+        }
+    }
+
+    if (update->from_dump) {
+        return seen;
+    }
+    if (!update->is_add && !seen) {
+        if (mgr->link_resync_deleted_count < TERMINAL_LINK_RESYNC_DELETED_MAX) {
+            mgr->link_resync_deleted[mgr->link_resync_deleted_count++] = update->kernel_ifindex;
+        } else {
+            mgr->link_resync_overflow = true;
+        }
+    }
+    return false;
+}
+
+void terminal_manager_on_link_update(struct terminal_manager *mgr,
+                                     const terminal_link_update_t *update) {
+    if (!mgr || !update || update->kernel_ifindex <= 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&mgr->lock);
+    if (mgr->link_resync_active && link_resync_filter(mgr, update)) {
+        pthread_mutex_unlock(&mgr->lock);
+        return;
+    }
+
+    int vlan_id = -1;
+    if (update->is_add && mgr->cfg.vlan_iface_format) {
+        if (!vlan_from_link_name(mgr->cfg.vlan_iface_format, update->ifname, &vlan_id)) {
+            vlan_id = -1;
+        }
+    }
+
+    /* Most RTM_NEWLINK traffic is flag/carrier churn on a known link. */
+    if (vlan_id > 0 && mgr->vlan_link_ifindex[vlan_id] == update->kernel_ifindex) {
         pthread_mutex_unlock(&mgr->lock);
         return;
     }
 
-    struct iface_binding_entry **binding_ref = &record->bindings;
-    while (*binding_ref) {
-        struct iface_binding_entry *binding = *binding_ref;
-        struct terminal_entry *terminal = binding->terminal;
-        if (update->is_add) {
-            struct in_addr refreshed_ip;
-            if (iface_record_select_ip(record, terminal->key.ip, &refreshed_ip)) {
-                terminal->tx_source_ip = refreshed_ip;
-            }
-            binding_ref = &(*binding_ref)->next;
-            continue;
+    /* Deleted or renamed: drop whatever VLAN the ifindex used to serve. */
+    bool unmapped = false;
+    for (int vid = TD_MIN_VLAN_ID; vid <= TD_MAX_VLAN_ID; ++vid) {
+        if (mgr->vlan_link_ifindex[vid] == update->kernel_ifindex) {
+            mgr->vlan_link_ifindex[vid] = 0;
+            unmapped = true;
         }
-
-        if (!iface_record_matches_ip(record, terminal->key.ip)) {
-            *binding_ref = binding->next;
-            free(binding);
-            terminal->tx_iface[0] = '\0';
-            terminal->tx_kernel_ifindex = -1;
-            terminal->tx_source_ip.s_addr = 0;
-            pending_attach(mgr, terminal, terminal->meta.vlan_id);
-            monotonic_now(&terminal->last_seen);
-            set_state(terminal, TERMINAL_STATE_IFACE_INVALID);
-        } else {
-            binding_ref = &(*binding_ref)->next;
+    }
+    if (unmapped || vlan_id > 0) {
+        iface_record_touch(mgr, get_iface_record(mgr, update->kernel_ifindex));
+    }
+    if (vlan_id > 0) {
+        int displaced = mgr->vlan_link_ifindex[vlan_id];
+        if (displaced > 0) {
+            iface_record_touch(mgr, get_iface_record(mgr, displaced));
         }
+        mgr->vlan_link_ifindex[vlan_id] = update->kernel_ifindex;
     }
+    pthread_mutex_unlock(&mgr->lock);
+}
 
-    iface_record_prune_if_empty(slot);
-
-    if (retry_pending) {
-        pending_retry_for_ifindex(mgr, update->kernel_ifindex);
+void terminal_manager_reset_link_cache(struct terminal_manager *mgr) {
+    if (!mgr) {
+        return;
     }
 
+    pthread_mutex_lock(&mgr->lock);
+    memset(mgr->vlan_link_ifindex, 0, sizeof(mgr->vlan_link_ifindex));
+    mgr->vlan_links_ready = false;
+    mgr->link_resync_active = true;
+    mgr->link_resync_overflow = false;
+    mgr->link_resync_deleted_count = 0;
+    iface_record_touch_all(mgr);
     pthread_mutex_unlock(&mgr->lock);
 }
 
-void terminal_manager_set_address_sync_handler(struct terminal_manager *mgr,
-                                               terminal_address_sync_fn handler,
-                                               void *handler_ctx) {
+int terminal_manager_mark_link_cache_ready(struct terminal_manager *mgr) {
     if (!mgr) {
-        return;
+        return -EINVAL;
     }
 
     pthread_mutex_lock(&mgr->lock);
-    mgr->address_sync_cb = handler;
-    mgr->address_sync_ctx = handler_ctx;
-    if (!handler) {
-        mgr->address_sync_pending = false;
-        mgr->address_sync_in_progress = false;
+    bool overflow = mgr->link_resync_overflow;
+    mgr->link_resync_active = false;
+    mgr->link_resync_overflow = false;
+    mgr->link_resync_deleted_count = 0;
+    if (overflow) {
+        pthread_mutex_unlock(&mgr->lock);
+        return -EAGAIN;
     }
+    mgr->vlan_links_ready = true;
+    iface_record_touch_all(mgr);
     pthread_mutex_unlock(&mgr->lock);
+    return 0;
 }
 
 void terminal_manager_request_address_sync(struct terminal_manager *mgr) {
@@ -2296,68 +4110,496 @@ int terminal_manager_set_event_sink(struct terminal_manager *mgr,
     pthread_mutex_lock(&mgr->lock);
     mgr->event_cb = callback;
     mgr->event_cb_ctx = callback_ctx;
-    if (!callback) {
-        size_t dropped = mgr->events.size;
-        free_event_queue(&mgr->events);
-        if (dropped > 0) {
-            mgr->stats.event_dispatch_failures += 1;
-        }
-    }
     pthread_mutex_unlock(&mgr->lock);
 
+    pthread_mutex_lock(&mgr->dispatch_lock);
+    mgr->dispatch_cb = callback;
+    mgr->dispatch_cb_ctx = callback_ctx;
+    pthread_mutex_unlock(&mgr->dispatch_lock);
+
     if (callback) {
         terminal_manager_maybe_dispatch_events(mgr);
+    } else {
+        /* Drains with no sink count one dispatch failure and discard. */
+        terminal_manager_flush_events(mgr);
+    }
+
+    return 0;
+}
+
+static void view_snapshot_release(struct terminal_manager *mgr,
+                                  struct terminal_view_snapshot *snapshot) {
+    pthread_mutex_lock(&mgr->view_lock);
+    bool last = --snapshot->refs == 0;
+    pthread_mutex_unlock(&mgr->view_lock);
+    if (last) {
+        free(snapshot);
+    }
+}
+
+/* Returns the current snapshot with a reference held for the caller, or NULL
+ * when the view changed since it was published. */
+static struct terminal_view_snapshot *view_snapshot_acquire_clean(struct terminal_manager *mgr) {
+    struct terminal_view_snapshot *snapshot = NULL;
+    pthread_mutex_lock(&mgr->view_lock);
+    if (mgr->view_snapshot && !__atomic_load_n(&mgr->view_dirty, __ATOMIC_ACQUIRE)) {
+        snapshot = mgr->view_snapshot;
+        snapshot->refs += 1;
+    }
+    pthread_mutex_unlock(&mgr->view_lock);
+    return snapshot;
+}
+
+/* Copies the table under every shard lock and publishes the copy. Concurrent
+ * rebuilders may each publish; the later one simply replaces the earlier. */
+static struct terminal_view_snapshot *view_snapshot_rebuild(struct terminal_manager *mgr) {
+    lock_all_shards(mgr);
+
+    size_t count = 0;
+    for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+        terminal_table_finish_migration(&mgr->tables[shard]);
+        count += mgr->tables[shard].size;
+    }
+
+    struct terminal_view_snapshot *snapshot =
+        malloc(sizeof(*snapshot) + count * sizeof(snapshot->records[0]));
+    if (!snapshot) {
+        unlock_all_shards(mgr);
+        return NULL;
+    }
+
+    size_t idx = 0;
+    for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+        const struct terminal_table *table = &mgr->tables[shard];
+        for (size_t i = 0; i < table->capacity && idx < count; ++i) {
+            const struct terminal_entry *entry = table->slots[i].entry;
+            if (!entry) {
+                continue;
+            }
+            terminal_event_record_t *record = &snapshot->records[idx++];
+            memset(record, 0, sizeof(*record));
+            memcpy(record->key.mac, entry->key.mac, ETH_ALEN);
+            record->key.ip = entry->key.ip;
+            record->ifindex = entry->meta.ifindex;
+            record->prev_ifindex = 0U;
+            record->tag = TERMINAL_EVENT_TAG_ADD;
+        }
+    }
+    snapshot->count = idx;
+    snapshot->version = mgr->event_seq;
+    snapshot->refs = 2U; /* published slot + caller */
+
+    /* Swap and clear view_dirty together, before the shard locks drop, so a
+     * clean flag never pairs with an older snapshot. */
+    pthread_mutex_lock(&mgr->view_lock);
+    struct terminal_view_snapshot *previous = mgr->view_snapshot;
+    mgr->view_snapshot = snapshot;
+    __atomic_store_n(&mgr->view_dirty, false, __ATOMIC_RELEASE);
+    bool free_previous = previous && --previous->refs == 0;
+    pthread_mutex_unlock(&mgr->view_lock);
+
+    unlock_all_shards(mgr);
+
+    if (free_previous) {
+        free(previous);
+    }
+    return snapshot;
+}
+
+int terminal_manager_query_snapshot(struct terminal_manager *mgr,
+                                    terminal_query_callback_fn callback,
+                                    void *callback_ctx,
+                                    uint64_t *version) {
+    if (!mgr || !callback) {
+        return -1;
+    }
+
+    struct terminal_view_snapshot *snapshot = view_snapshot_acquire_clean(mgr);
+    if (!snapshot) {
+        snapshot = view_snapshot_rebuild(mgr);
+        if (!snapshot) {
+            return -1;
+        }
+    }
+
+    if (version) {
+        *version = snapshot->version;
+    }
+    for (size_t i = 0; i < snapshot->count; ++i) {
+        if (!callback(&snapshot->records[i], callback_ctx)) {
+            break;
+        }
     }
 
+    view_snapshot_release(mgr, snapshot);
     return 0;
 }
 
 int terminal_manager_query_all(struct terminal_manager *mgr,
                                terminal_query_callback_fn callback,
                                void *callback_ctx) {
+    return terminal_manager_query_snapshot(mgr, callback, callback_ctx, NULL);
+}
+
+static int terminal_key_compare(const struct terminal_key *lhs,
+                                const struct terminal_key *rhs) {
+    int rc = memcmp(lhs->mac, rhs->mac, ETH_ALEN);
+    if (rc != 0) {
+        return rc;
+    }
+    uint32_t lhs_ip = ntohl(lhs->ip.s_addr);
+    uint32_t rhs_ip = ntohl(rhs->ip.s_addr);
+    if (lhs_ip != rhs_ip) {
+        return lhs_ip < rhs_ip ? -1 : 1;
+    }
+    return 0;
+}
+
+static int query_record_compare(const void *lhs, const void *rhs) {
+    const terminal_event_record_t *a = lhs;
+    const terminal_event_record_t *b = rhs;
+    return terminal_key_compare(&a->key, &b->key);
+}
+
+static bool query_filter_matches(const struct terminal_entry *entry,
+                                 const terminal_query_filter_t *filter) {
+    if (!filter) {
+        return true;
+    }
+    if (filter->filter_by_vlan && entry->meta.vlan_id != filter->vlan_id) {
+        return false;
+    }
+    if (filter->filter_by_ifindex && entry->meta.ifindex != filter->ifindex) {
+        return false;
+    }
+    if (filter->filter_by_state && entry->state != filter->state) {
+        return false;
+    }
+    if (filter->filter_by_mac_prefix && filter->mac_prefix_len > 0) {
+        size_t len = filter->mac_prefix_len > ETH_ALEN ? ETH_ALEN : filter->mac_prefix_len;
+        if (memcmp(entry->key.mac, filter->mac_prefix, len) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct query_filtered_ctx {
+    const terminal_query_filter_t *filter;
+    const struct terminal_key *cursor; /* NULL on the first page */
+    size_t limit; /* 0 keeps every match; otherwise records is a max-heap of
+                   * the limit smallest keys after cursor */
+    terminal_event_record_t *records;
+    size_t count;
+    size_t capacity;
+    size_t total;        /* matches, ignoring the cursor */
+    size_t after_cursor; /* matches past the cursor */
+    bool failed;
+};
+
+static void query_heap_sift_up(terminal_event_record_t *heap, size_t pos) {
+    while (pos > 0) {
+        size_t parent = (pos - 1U) / 2U;
+        if (terminal_key_compare(&heap[parent].key, &heap[pos].key) >= 0) {
+            break;
+        }
+        terminal_event_record_t tmp = heap[parent];
+        heap[parent] = heap[pos];
+        heap[pos] = tmp;
+        pos = parent;
+    }
+}
+
+static void query_heap_sift_down(terminal_event_record_t *heap, size_t count, size_t pos) {
+    for (;;) {
+        size_t largest = pos;
+        size_t left = 2U * pos + 1U;
+        size_t right = left + 1U;
+        if (left < count && terminal_key_compare(&heap[left].key, &heap[largest].key) > 0) {
+            largest = left;
+        }
+        if (right < count && terminal_key_compare(&heap[right].key, &heap[largest].key) > 0) {
+            largest = right;
+        }
+        if (largest == pos) {
+            return;
+        }
+        terminal_event_record_t tmp = heap[largest];
+        heap[largest] = heap[pos];
+        heap[pos] = tmp;
+        pos = largest;
+    }
+}
+
+static void query_record_fill(terminal_event_record_t *record,
+                              const struct terminal_entry *entry) {
+    memset(record, 0, sizeof(*record));
+    record->key = entry->key;
+    record->ifindex = entry->meta.ifindex;
+    record->tag = TERMINAL_EVENT_TAG_ADD;
+}
+
+/* Keeps at most limit records however many terminals match, so a paged walk
+ * costs one table scan per page rather than a copy and sort of the rest. */
+static void query_filtered_collect(struct query_filtered_ctx *ctx,
+                                   const struct terminal_entry *entry) {
+    if (!query_filter_matches(entry, ctx->filter)) {
+        return;
+    }
+    ctx->total += 1U;
+    if (ctx->cursor && terminal_key_compare(&entry->key, ctx->cursor) <= 0) {
+        return;
+    }
+    ctx->after_cursor += 1U;
+    if (ctx->failed) {
+        return;
+    }
+    if (ctx->limit > 0U && ctx->count == ctx->limit) {
+        if (terminal_key_compare(&entry->key, &ctx->records[0].key) >= 0) {
+            return;
+        }
+        query_record_fill(&ctx->records[0], entry);
+        query_heap_sift_down(ctx->records, ctx->count, 0);
+        return;
+    }
+    if (ctx->count == ctx->capacity) {
+        size_t capacity = ctx->capacity ? ctx->capacity * 2U : 64U;
+        if (ctx->limit > 0U && capacity > ctx->limit) {
+            capacity = ctx->limit;
+        }
+        terminal_event_record_t *grown = realloc(ctx->records, capacity * sizeof(*grown));
+        if (!grown) {
+            ctx->failed = true;
+            return;
+        }
+        ctx->records = grown;
+        ctx->capacity = capacity;
+    }
+    query_record_fill(&ctx->records[ctx->count], entry);
+    ctx->count += 1U;
+    if (ctx->limit > 0U) {
+        query_heap_sift_up(ctx->records, ctx->count - 1U);
+    }
+}
+
+int terminal_manager_query_filtered(struct terminal_manager *mgr,
+                                    const terminal_query_filter_t *filter,
+                                    terminal_query_page_t *page,
+                                    terminal_query_callback_fn callback,
+                                    void *callback_ctx) {
     if (!mgr || !callback) {
-        return -1;
+        return -EINVAL;
     }
 
-    pthread_mutex_lock(&mgr->lock);
+    struct query_filtered_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.filter = filter;
+    ctx.cursor = (page && page->has_cursor) ? &page->cursor : NULL;
+    ctx.limit = page ? page->limit : 0U;
+
+    uint64_t version;
+    if (filter && (filter->filter_by_ifindex ||
+                   (filter->filter_by_vlan && vlan_id_supported(filter->vlan_id)))) {
+        /* The secondary index chains cross shards, so walk them with every
+         * shard lock and lock held; the walk only visits matches. */
+        lock_all_shards(mgr);
+        pthread_mutex_lock(&mgr->lock);
+        const struct terminal_entry *entry;
+        if (filter->filter_by_ifindex) {
+            for (entry = *ifindex_index_head(mgr, filter->ifindex); entry; entry = entry->ifindex_next) {
+                query_filtered_collect(&ctx, entry);
+            }
+        } else {
+            for (entry = mgr->vlan_index[filter->vlan_id]; entry; entry = entry->vlan_next) {
+                query_filtered_collect(&ctx, entry);
+            }
+        }
+        version = mgr->event_seq;
+        pthread_mutex_unlock(&mgr->lock);
+        unlock_all_shards(mgr);
+    } else {
+        /* Full scans hold one shard lock at a time. The version is read
+         * first, so the page reflects at least every event up to it. */
+        pthread_mutex_lock(&mgr->lock);
+        version = mgr->event_seq;
+        pthread_mutex_unlock(&mgr->lock);
+        for (size_t shard = 0; shard < TERMINAL_SHARD_COUNT; ++shard) {
+            pthread_mutex_lock(&mgr->shard_locks[shard]);
+            struct terminal_table *table = &mgr->tables[shard];
+            terminal_table_finish_migration(table);
+            for (size_t i = 0; i < table->capacity; ++i) {
+                if (table->slots[i].entry) {
+                    query_filtered_collect(&ctx, table->slots[i].entry);
+                }
+            }
+            pthread_mutex_unlock(&mgr->shard_locks[shard]);
+        }
+    }
+
+    if (ctx.failed) {
+        free(ctx.records);
+        return -ENOMEM;
+    }
+
+    if (ctx.count > 1U) {
+        qsort(ctx.records, ctx.count, sizeof(ctx.records[0]), query_record_compare);
+    }
+
+    size_t delivered = 0;
+    while (delivered < ctx.count) {
+        bool keep_going = callback(&ctx.records[delivered], callback_ctx);
+        delivered += 1U;
+        if (!keep_going) {
+            break;
+        }
+    }
+
+    if (page) {
+        page->total = ctx.total;
+        page->version = version;
+        page->more = delivered < ctx.after_cursor;
+        if (delivered > 0U) {
+            page->cursor = ctx.records[delivered - 1U].key;
+            page->has_cursor = true;
+        }
+    }
+
+    free(ctx.records);
+    return 0;
+}
+
+static bool point_lookup_matches_mac(const struct terminal_entry *entry, const void *needle) {
+    return memcmp(entry->key.mac, needle, ETH_ALEN) == 0;
+}
+
+static bool point_lookup_matches_ip(const struct terminal_entry *entry, const void *needle) {
+    return entry->key.ip.s_addr == ((const struct in_addr *)needle)->s_addr;
+}
 
+static int point_index_lookup(struct terminal_manager *mgr,
+                              const struct terminal_point_index *index,
+                              uint64_t hash,
+                              bool (*matches)(const struct terminal_entry *entry, const void *needle),
+                              const void *needle,
+                              terminal_query_callback_fn callback,
+                              void *callback_ctx) {
+    terminal_event_record_t local[TERMINAL_LOOKUP_LOCAL_RECORDS];
+    terminal_event_record_t *records = local;
+    size_t capacity = TERMINAL_LOOKUP_LOCAL_RECORDS;
     size_t count = 0;
-    for (size_t i = 0; i < TERMINAL_BUCKET_COUNT; ++i) {
-        for (struct terminal_entry *entry = mgr->table[i]; entry; entry = entry->next) {
-            ++count;
+
+    pthread_mutex_lock(&mgr->lock);
+    const struct terminal_entry *entry = point_index_bucket(index, hash);
+    for (; entry; entry = point_index_link_of(index, entry)->next) {
+        if (!matches(entry, needle)) {
+            continue;
+        }
+        if (count == capacity) {
+            terminal_event_record_t *grown = malloc(capacity * 2U * sizeof(*grown));
+            if (!grown) {
+                pthread_mutex_unlock(&mgr->lock);
+                if (records != local) {
+                    free(records);
+                }
+                return -ENOMEM;
+            }
+            memcpy(grown, records, count * sizeof(*grown));
+            if (records != local) {
+                free(records);
+            }
+            records = grown;
+            capacity *= 2U;
+        }
+        terminal_event_record_t *record = &records[count++];
+        memset(record, 0, sizeof(*record));
+        record->key = entry->key;
+        record->ifindex = entry->meta.ifindex;
+        record->tag = TERMINAL_EVENT_TAG_ADD;
+    }
+    pthread_mutex_unlock(&mgr->lock);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!callback(&records[i], callback_ctx)) {
+            break;
         }
     }
 
+    if (records != local) {
+        free(records);
+    }
+    return 0;
+}
+
+int terminal_manager_lookup_by_mac(struct terminal_manager *mgr,
+                                   const uint8_t mac[ETH_ALEN],
+                                   terminal_query_callback_fn callback,
+                                   void *callback_ctx) {
+    if (!mgr || !mac || !callback) {
+        return -EINVAL;
+    }
+    return point_index_lookup(mgr,
+                              &mgr->mac_index,
+                              hash_mac(mac),
+                              point_lookup_matches_mac,
+                              mac,
+                              callback,
+                              callback_ctx);
+}
+
+int terminal_manager_lookup_by_ip(struct terminal_manager *mgr,
+                                  struct in_addr ip,
+                                  terminal_query_callback_fn callback,
+                                  void *callback_ctx) {
+    if (!mgr || !callback) {
+        return -EINVAL;
+    }
+    return point_index_lookup(mgr,
+                              &mgr->ip_index,
+                              hash_ipv4(ip),
+                              point_lookup_matches_ip,
+                              &ip,
+                              callback,
+                              callback_ctx);
+}
+
+int terminal_manager_query_since(struct terminal_manager *mgr,
+                                 uint64_t since_seq,
+                                 terminal_query_callback_fn callback,
+                                 void *callback_ctx,
+                                 uint64_t *latest_seq) {
+    if (!mgr || !callback) {
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&mgr->lock);
+    const struct terminal_event_journal *journal = &mgr->event_journal;
+    uint64_t latest = mgr->event_seq;
+    if (latest_seq) {
+        *latest_seq = latest;
+    }
+    if (since_seq > latest || latest - since_seq > journal->count) {
+        pthread_mutex_unlock(&mgr->lock);
+        return -ESTALE;
+    }
+
+    size_t count = (size_t)(latest - since_seq);
     terminal_event_record_t *records = NULL;
     if (count > 0) {
-        records = calloc(count, sizeof(*records));
+        records = malloc(count * sizeof(*records));
         if (!records) {
             pthread_mutex_unlock(&mgr->lock);
-            return -1;
+            return -ENOMEM;
         }
-    }
-
-    size_t idx = 0;
-    for (size_t i = 0; i < TERMINAL_BUCKET_COUNT; ++i) {
-        for (struct terminal_entry *entry = mgr->table[i]; entry; entry = entry->next) {
-            if (records && idx < count) {
-                memcpy(records[idx].key.mac, entry->key.mac, ETH_ALEN);
-                records[idx].key.ip = entry->key.ip;
-                records[idx].ifindex = entry->meta.ifindex;
-                records[idx].prev_ifindex = 0U;
-                records[idx].tag = TERMINAL_EVENT_TAG_ADD;
-            }
-            ++idx;
+        size_t start = (journal->head + journal->capacity - count) % journal->capacity;
+        for (size_t i = 0; i < count; ++i) {
+            records[i] = journal->records[(start + i) % journal->capacity];
         }
     }
-
     pthread_mutex_unlock(&mgr->lock);
 
-    if (records) {
-        for (size_t i = 0; i < count; ++i) {
-            if (!callback(&records[i], callback_ctx)) {
-                break;
-            }
+    for (size_t i = 0; i < count; ++i) {
+        if (!callback(&records[i], callback_ctx)) {
+            break;
         }
     }
 
@@ -2369,7 +4611,24 @@ void terminal_manager_flush_events(struct terminal_manager *mgr) {
     if (!mgr) {
         return;
     }
-    terminal_manager_maybe_dispatch_events(mgr);
+
+    if (!mgr->dispatch_started) {
+        terminal_manager_maybe_dispatch_events(mgr);
+        return;
+    }
+    if (pthread_equal(pthread_self(), mgr->dispatch_thread)) {
+        return;
+    }
+
+    /* The dispatcher samples flush_requested before each drain, so once it
+     * reports our generation it has emptied the ring after we asked. */
+    pthread_mutex_lock(&mgr->dispatch_lock);
+    uint64_t generation = ++mgr->flush_requested;
+    pthread_cond_signal(&mgr->dispatch_cond);
+    while (mgr->flush_completed < generation && !mgr->dispatch_stop) {
+        pthread_cond_wait(&mgr->flush_cond, &mgr->dispatch_lock);
+    }
+    pthread_mutex_unlock(&mgr->dispatch_lock);
 }
 
 void terminal_manager_get_stats(struct terminal_manager *mgr,
@@ -2382,6 +4641,23 @@ void terminal_manager_get_stats(struct terminal_manager *mgr,
     mgr->stats.current_terminals = mgr->terminal_count;
     *out = mgr->stats;
     pthread_mutex_unlock(&mgr->lock);
+
+    pthread_mutex_lock(&mgr->dispatch_lock);
+    out->events_dispatched = mgr->events_dispatched;
+    out->event_dispatch_failures = mgr->event_dispatch_failures;
+    out->events_coalesced = mgr->events_coalesced;
+    pthread_mutex_unlock(&mgr->dispatch_lock);
+
+    out->event_ring_capacity = terminal_event_ring_capacity(&mgr->event_ring);
+    out->event_ring_depth = terminal_event_ring_depth(&mgr->event_ring);
+    out->event_ring_high_water = terminal_event_ring_high_water(&mgr->event_ring);
+    out->event_ring_drops = __atomic_load_n(&mgr->event_drops, __ATOMIC_RELAXED);
+    out->event_ring_coalesced = __atomic_load_n(&mgr->event_coalesced, __ATOMIC_RELAXED);
+    out->event_ring_backpressure_waits = __atomic_load_n(&mgr->event_backpressure_waits, __ATOMIC_RELAXED);
+
+    td_object_pool_get_stats(&mgr->entry_pool, &out->entry_pool);
+    td_object_pool_get_stats(&mgr->lookup_task_pool, &out->lookup_task_pool);
+    td_object_pool_get_stats(&mgr->probe_task_pool, &out->probe_task_pool);
 }
 
 int terminal_manager_set_keepalive_interval(struct terminal_manager *mgr,
@@ -2393,9 +4669,12 @@ int terminal_manager_set_keepalive_interval(struct terminal_manager *mgr,
         interval_sec = TERMINAL_KEEPALIVE_INTERVAL_DEFAULT_SEC;
     }
 
+    lock_all_shards(mgr);
     pthread_mutex_lock(&mgr->lock);
     mgr->cfg.keepalive_interval_sec = interval_sec;
+    timer_reschedule_all(mgr);
     pthread_mutex_unlock(&mgr->lock);
+    unlock_all_shards(mgr);
     return 0;
 }
 
@@ -2423,9 +4702,12 @@ int terminal_manager_set_iface_invalid_holdoff(struct terminal_manager *mgr,
         holdoff_sec = TERMINAL_IFACE_INVALID_HOLDOFF_DEFAULT_SEC;
     }
 
+    lock_all_shards(mgr);
     pthread_mutex_lock(&mgr->lock);
     mgr->cfg.iface_invalid_holdoff_sec = holdoff_sec;
+    timer_reschedule_all(mgr);
     pthread_mutex_unlock(&mgr->lock);
+    unlock_all_shards(mgr);
     return 0;
 }
 
@@ -2466,6 +4748,7 @@ int terminal_manager_add_ignored_vlan(struct terminal_manager *mgr,
     }
 
     mgr->cfg.ignored_vlans[mgr->cfg.ignored_vlan_count++] = vlan_id;
+    __atomic_store_n(&mgr->vlan_ignored[vlan_id], true, __ATOMIC_RELAXED);
     pthread_mutex_unlock(&mgr->lock);
     return 0;
 }
@@ -2491,6 +4774,7 @@ int terminal_manager_remove_ignored_vlan(struct terminal_manager *mgr,
             }
             mgr->cfg.ignored_vlan_count -= 1;
             mgr->cfg.ignored_vlans[mgr->cfg.ignored_vlan_count] = 0U;
+            __atomic_store_n(&mgr->vlan_ignored[vlan_id], false, __ATOMIC_RELAXED);
             pthread_mutex_unlock(&mgr->lock);
             return 0;
         }
@@ -2506,6 +4790,9 @@ void terminal_manager_clear_ignored_vlans(struct terminal_manager *mgr) {
     }
 
     pthread_mutex_lock(&mgr->lock);
+    for (size_t i = 0; i < mgr->cfg.ignored_vlan_count; ++i) {
+        __atomic_store_n(&mgr->vlan_ignored[mgr->cfg.ignored_vlans[i]], false, __ATOMIC_RELAXED);
+    }
     if (mgr->cfg.ignored_vlan_count > 0) {
         memset(mgr->cfg.ignored_vlans, 0, sizeof(mgr->cfg.ignored_vlans));
         mgr->cfg.ignored_vlan_count = 0;
@@ -2645,7 +4932,7 @@ int td_debug_dump_terminal_table(struct terminal_manager *mgr,
         return -EINVAL;
     }
 
-    pthread_mutex_lock(&mgr->lock);
+    lock_all_shards(mgr);
 
     struct timespec mono_now;
     struct timespec wall_now;
@@ -2654,22 +4941,30 @@ int td_debug_dump_terminal_table(struct terminal_manager *mgr,
 
     int rc = 0;
 
+    /* Buckets are reported as the logical hash % TERMINAL_BUCKET_COUNT groups;
+     * their entries live in the owning shard's open-addressed table. */
     for (size_t i = 0; i < TERMINAL_BUCKET_COUNT && rc == 0; ++i) {
-        struct terminal_entry *entry = mgr->table[i];
-        if (!entry) {
-            continue;
-        }
+        struct terminal_table *table = &mgr->tables[i / TERMINAL_SHARD_BUCKETS];
+        terminal_table_finish_migration(table);
 
         size_t bucket_total = 0;
         size_t bucket_filtered = 0;
-        for (struct terminal_entry *iter = entry; iter; iter = iter->next) {
+        for (size_t slot = 0; slot < table->capacity; ++slot) {
+            const struct terminal_entry *iter = table->slots[slot].entry;
+            if (!iter || bucket_for_key(&iter->key) != i) {
+                continue;
+            }
             bucket_total += 1;
             if (debug_entry_matches_opts(iter, opts)) {
                 bucket_filtered += 1;
             }
         }
 
-        size_t collisions = bucket_total > 0 ? bucket_total - 1U : 0U;
+        if (bucket_total == 0) {
+            continue;
+        }
+
+        size_t collisions = bucket_total - 1U;
 
         rc = debug_emit_line(writer,
                              writer_ctx,
@@ -2687,8 +4982,9 @@ int td_debug_dump_terminal_table(struct terminal_manager *mgr,
             continue;
         }
 
-        for (struct terminal_entry *iter = entry; iter && rc == 0; iter = iter->next) {
-            if (!debug_entry_matches_opts(iter, opts)) {
+        for (size_t slot = 0; slot < table->capacity && rc == 0; ++slot) {
+            const struct terminal_entry *iter = table->slots[slot].entry;
+            if (!iter || bucket_for_key(&iter->key) != i || !debug_entry_matches_opts(iter, opts)) {
                 continue;
             }
 
@@ -2758,7 +5054,7 @@ int td_debug_dump_terminal_table(struct terminal_manager *mgr,
         }
     }
 
-    pthread_mutex_unlock(&mgr->lock);
+    unlock_all_shards(mgr);
 
     return rc;
 }
@@ -2786,7 +5082,7 @@ int td_debug_dump_iface_prefix_table(struct terminal_manager *mgr,
         for (struct iface_prefix_entry *p = record->prefixes; p; p = p->next) {
             prefix_count += 1;
         }
-        for (struct iface_binding_entry *b = record->bindings; b; b = b->next) {
+        for (const struct terminal_entry *t = record->bindings; t; t = t->binding_next) {
             binding_count += 1;
         }
 
@@ -2841,6 +5137,7 @@ int td_debug_dump_iface_binding_table(struct terminal_manager *mgr,
         return -EINVAL;
     }
 
+    lock_all_shards(mgr);
     pthread_mutex_lock(&mgr->lock);
 
     int rc = 0;
@@ -2852,13 +5149,13 @@ int td_debug_dump_iface_binding_table(struct terminal_manager *mgr,
         size_t binding_count = 0;
         bool has_invalid = false;
         struct terminal_entry *first_terminal = NULL;
-        for (struct iface_binding_entry *b = record->bindings; b; b = b->next) {
+        for (struct terminal_entry *t = record->bindings; t; t = t->binding_next) {
             binding_count += 1;
-            if (b->terminal->state == TERMINAL_STATE_IFACE_INVALID) {
+            if (t->state == TERMINAL_STATE_IFACE_INVALID) {
                 has_invalid = true;
             }
             if (!first_terminal) {
-                first_terminal = b->terminal;
+                first_terminal = t;
             }
         }
 
@@ -2894,15 +5191,15 @@ int td_debug_dump_iface_binding_table(struct terminal_manager *mgr,
             continue;
         }
 
-        for (struct iface_binding_entry *b = record->bindings; b && rc == 0; b = b->next) {
-            struct terminal_entry *terminal = b->terminal;
+        for (struct terminal_entry *terminal = record->bindings; terminal && rc == 0;
+             terminal = terminal->binding_next) {
             if (!debug_entry_matches_opts(terminal, opts)) {
                 continue;
             }
             char mac_buf[18];
             char ip_buf[INET_ADDRSTRLEN];
             format_terminal_identity(&terminal->key, mac_buf, ip_buf);
-            size_t bucket = hash_key(&terminal->key) % TERMINAL_BUCKET_COUNT;
+            size_t bucket = bucket_for_key(&terminal->key);
             rc = debug_emit_line(writer,
                                  writer_ctx,
                                  ctx_in,
@@ -2916,6 +5213,7 @@ int td_debug_dump_iface_binding_table(struct terminal_manager *mgr,
     }
 
     pthread_mutex_unlock(&mgr->lock);
+    unlock_all_shards(mgr);
     return rc;
 }
 
@@ -2939,6 +5237,7 @@ int td_debug_dump_pending_vlan_table(struct terminal_manager *mgr,
     memset(filtered_counts, 0, sizeof(filtered_counts));
     memset(total_counts, 0, sizeof(total_counts));
 
+    lock_all_shards(mgr);
     pthread_mutex_lock(&mgr->lock);
 
     size_t matched_buckets = 0;
@@ -2956,11 +5255,7 @@ int td_debug_dump_pending_vlan_table(struct terminal_manager *mgr,
 
         size_t bucket_total = 0;
         size_t bucket_filtered = 0;
-        for (struct pending_vlan_entry *node = bucket->head; node; node = node->next) {
-            struct terminal_entry *entry = node->terminal;
-            if (!entry) {
-                continue;
-            }
+        for (struct terminal_entry *entry = bucket->head; entry; entry = entry->pending_next) {
             bucket_total += 1;
             if (!opts || debug_entry_matches_opts(entry, opts)) {
                 bucket_filtered += 1;
@@ -3007,11 +5302,8 @@ int td_debug_dump_pending_vlan_table(struct terminal_manager *mgr,
                 if (!bucket) {
                     continue;
                 }
-                for (struct pending_vlan_entry *node = bucket->head; node && rc == 0; node = node->next) {
-                    struct terminal_entry *entry = node->terminal;
-                    if (!entry) {
-                        continue;
-                    }
+                for (struct terminal_entry *entry = bucket->head; entry && rc == 0;
+                     entry = entry->pending_next) {
                     if (opts && !debug_entry_matches_opts(entry, opts)) {
                         continue;
                     }
@@ -3034,6 +5326,7 @@ int td_debug_dump_pending_vlan_table(struct terminal_manager *mgr,
     }
 
     pthread_mutex_unlock(&mgr->lock);
+    unlock_all_shards(mgr);
     return rc;
 }
 
@@ -33,12 +33,14 @@ struct terminal_netlink_listener {
     bool thread_started;
     struct terminal_manager *manager;
     struct terminal_netlink_sync_state *sync_state;
+    bool dump; /* replies to netlink_dump rather than multicast events */
 };
 
 struct terminal_netlink_sync_state {
     struct terminal_manager *manager;
     bool last_attempt_failed;
     bool logged_initial_success;
+    bool link_sync_failed;
 };
 
 static void handle_netlink_message(struct terminal_netlink_listener *listener,
@@ -116,7 +118,9 @@ static int sync_addresses_via_getifaddrs(struct terminal_manager *manager) {
     return 0;
 }
 
-static int sync_addresses_via_netlink(struct terminal_manager *manager) {
+/* Issues one rtnetlink dump request and feeds every reply through
+ * handle_netlink_message until NLMSG_DONE. */
+static int netlink_dump(struct terminal_manager *manager, uint16_t type, uint8_t family) {
     int fd = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
     if (fd < 0) {
         return -errno;
@@ -139,11 +143,11 @@ static int sync_addresses_via_netlink(struct terminal_manager *manager) {
 
     memset(&req, 0, sizeof(req));
     req.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtgenmsg));
-    req.hdr.nlmsg_type = RTM_GETADDR;
+    req.hdr.nlmsg_type = type;
     req.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_ROOT | NLM_F_MATCH;
     req.hdr.nlmsg_seq = next_netlink_seq();
     req.hdr.nlmsg_pid = (uint32_t)getpid();
-    req.gen.rtgen_family = AF_INET;
+    req.gen.rtgen_family = family;
 
     struct sockaddr_nl kernel;
     memset(&kernel, 0, sizeof(kernel));
@@ -163,6 +167,7 @@ static int sync_addresses_via_netlink(struct terminal_manager *manager) {
     memset(&temp_listener, 0, sizeof(temp_listener));
     temp_listener.fd = fd;
     temp_listener.manager = manager;
+    temp_listener.dump = true;
 
     while (!done) {
         ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
@@ -214,6 +219,24 @@ static int sync_addresses_via_netlink(struct terminal_manager *manager) {
     return rc;
 }
 
+static int sync_addresses_via_netlink(struct terminal_manager *manager) {
+    return netlink_dump(manager, RTM_GETADDR, AF_INET);
+}
+
+/* Rebuilds the manager's VLAN link cache from a full RTM_GETLINK dump. Link
+ * events that race the dump are applied as they arrive, and dump replies for
+ * links a live RTM_DELLINK removed meanwhile are dropped by the manager; the
+ * cache is only trusted once the dump completed, until then lookups use
+ * ioctls. */
+static int sync_links_via_netlink(struct terminal_manager *manager) {
+    terminal_manager_reset_link_cache(manager);
+    int rc = netlink_dump(manager, RTM_GETLINK, AF_UNSPEC);
+    if (rc == 0) {
+        rc = terminal_manager_mark_link_cache_ready(manager);
+    }
+    return rc;
+}
+
 static int terminal_netlink_sync_address_table(struct terminal_manager *manager,
                                                bool *used_fallback) {
     if (used_fallback) {
@@ -245,6 +268,15 @@ static int terminal_netlink_sync_handler(void *ctx) {
         return -EINVAL;
     }
 
+    int link_rc = sync_links_via_netlink(state->manager);
+    if (link_rc != 0 && !state->link_sync_failed) {
+        td_log_writef(TD_LOG_WARN,
+                      "netlink_listener",
+                      "link table sync failed: %s; VLAN interfaces resolved per packet",
+                      strerror(-link_rc));
+    }
+    state->link_sync_failed = link_rc != 0;
+
     bool used_fallback = false;
     int rc = terminal_netlink_sync_address_table(state->manager, &used_fallback);
     if (rc != 0) {
@@ -278,12 +310,55 @@ static int terminal_netlink_sync_handler(void *ctx) {
     return 0;
 }
 
+static void handle_link_message(struct terminal_netlink_listener *listener,
+                                struct nlmsghdr *nlh) {
+    struct ifinfomsg *ifi = (struct ifinfomsg *)NLMSG_DATA(nlh);
+    if (!ifi || ifi->ifi_index <= 0) {
+        return;
+    }
+
+    terminal_link_update_t update;
+    memset(&update, 0, sizeof(update));
+    update.kernel_ifindex = ifi->ifi_index;
+    update.is_add = (nlh->nlmsg_type == RTM_NEWLINK);
+    update.from_dump = listener->dump;
+
+    int attr_len = (int)nlh->nlmsg_len - (int)NLMSG_LENGTH(sizeof(*ifi));
+    if (attr_len < 0) {
+        attr_len = 0;
+    }
+    for (struct rtattr *attr = IFLA_RTA(ifi); attr && RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len)) {
+        if (attr->rta_type == IFLA_IFNAME) {
+            size_t name_len = RTA_PAYLOAD(attr);
+            if (name_len >= sizeof(update.ifname)) {
+                name_len = sizeof(update.ifname) - 1U;
+            }
+            memcpy(update.ifname, RTA_DATA(attr), name_len);
+            update.ifname[name_len] = '\0';
+            break;
+        }
+    }
+
+    if (update.is_add && update.ifname[0] == '\0') {
+        return;
+    }
+
+    if (listener->manager) {
+        terminal_manager_on_link_update(listener->manager, &update);
+    }
+}
+
 static void handle_netlink_message(struct terminal_netlink_listener *listener,
                                    struct nlmsghdr *nlh) {
     if (!listener || !nlh) {
         return;
     }
 
+    if (nlh->nlmsg_type == RTM_NEWLINK || nlh->nlmsg_type == RTM_DELLINK) {
+        handle_link_message(listener, nlh);
+        return;
+    }
+
     if (nlh->nlmsg_type != RTM_NEWADDR && nlh->nlmsg_type != RTM_DELADDR) {
         return;
     }
@@ -374,6 +449,14 @@ static void *netlink_thread_main(void *arg) {
             if (errno == EINTR) {
                 continue;
             }
+            if (errno == ENOBUFS) {
+                /* Events were lost; the cached link and address views can no
+                 * longer be trusted, so let the worker re-dump both. */
+                td_log_writef(TD_LOG_WARN, "netlink_listener", "event overrun; resyncing link and address tables");
+                terminal_manager_reset_link_cache(listener->manager);
+                terminal_manager_request_address_sync(listener->manager);
+                continue;
+            }
             td_log_writef(TD_LOG_ERROR, "netlink_listener", "recv error: %s", strerror(errno));
             break;
         }
@@ -417,7 +500,7 @@ int terminal_netlink_start(struct terminal_manager *manager,
     struct sockaddr_nl addr;
     memset(&addr, 0, sizeof(addr));
     addr.nl_family = AF_NETLINK;
-    addr.nl_groups = RTMGRP_IPV4_IFADDR;
+    addr.nl_groups = RTMGRP_IPV4_IFADDR | RTMGRP_LINK;
 
     if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
         td_log_writef(TD_LOG_ERROR, "netlink_listener", "bind failed: %s", strerror(errno));
@@ -476,6 +559,7 @@ void terminal_netlink_stop(struct terminal_netlink_listener *listener) {
 
     if (listener->manager) {
         terminal_manager_set_address_sync_handler(listener->manager, NULL, NULL);
+        terminal_manager_reset_link_cache(listener->manager);
     }
 
     if (listener->sync_state) {
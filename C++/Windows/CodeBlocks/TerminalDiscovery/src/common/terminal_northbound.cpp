@@ -13,6 +13,8 @@
 #include <netinet/in.h>
 #include <netinet/if_ether.h>
 
+static_assert(kTerminalIpStrLen == INET_ADDRSTRLEN, "kTerminalIpStrLen must match INET_ADDRSTRLEN");
+
 namespace {
 
 std::string format_mac(const uint8_t mac[ETH_ALEN]) {
@@ -29,20 +31,6 @@ std::string format_mac(const uint8_t mac[ETH_ALEN]) {
     return std::string(buf);
 }
 
-std::string format_ip(const struct in_addr &ip) {
-    char buf[INET_ADDRSTRLEN];
-    std::memset(buf, 0, sizeof(buf));
-    const char *res = inet_ntop(AF_INET, &ip, buf, sizeof(buf));
-    if (!res) {
-        td_log_writef(TD_LOG_WARN,
-                      "terminal_northbound",
-                      "inet_ntop failed: %s",
-                      std::strerror(errno));
-        return std::string();
-    }
-    return std::string(buf);
-}
-
 const char *event_tag_to_string(terminal_event_tag_t tag) {
     switch (tag) {
     case TERMINAL_EVENT_TAG_ADD:
@@ -68,6 +56,18 @@ ModifyTag to_modify_tag(terminal_event_tag_t tag) {
     }
 }
 
+TerminalRecord to_terminal_record(const terminal_event_record_t &event) {
+    TerminalRecord record;
+    std::memcpy(record.mac, event.key.mac, ETH_ALEN);
+    record.reserved[0] = 0;
+    record.reserved[1] = 0;
+    record.ipv4 = event.key.ip.s_addr;
+    record.ifindex = event.ifindex;
+    record.prev_ifindex = event.prev_ifindex;
+    record.tag = to_modify_tag(event.tag);
+    return record;
+}
+
 struct QueryCtx {
     MAC_IP_INFO *info;
     bool ok;
@@ -80,13 +80,7 @@ bool accumulate_query(const terminal_event_record_t *record, void *user_ctx) {
 
     auto *ctx = static_cast<QueryCtx *>(user_ctx);
     try {
-        TerminalInfo info;
-        info.mac = format_mac(record->key.mac);
-        info.ip = format_ip(record->key.ip);
-        info.ifindex = record->ifindex;
-        info.prev_ifindex = record->prev_ifindex;
-        info.tag = to_modify_tag(record->tag);
-        ctx->info->push_back(std::move(info));
+        ctx->info->push_back(toTerminalInfo(to_terminal_record(*record)));
         return true;
     } catch (const std::exception &ex) {
         ctx->ok = false;
@@ -103,33 +97,95 @@ bool accumulate_query(const terminal_event_record_t *record, void *user_ctx) {
     return false;
 }
 
+/* Fills the caller's buffer and keeps counting past it so the caller learns
+ * how much room a retry needs. */
+struct RecordBufferCtx {
+    TerminalRecord *records;
+    std::size_t capacity;
+    std::size_t total;
+};
+
+bool accumulate_records(const terminal_event_record_t *record, void *user_ctx) {
+    if (!record || !user_ctx) {
+        return false;
+    }
+
+    auto *ctx = static_cast<RecordBufferCtx *>(user_ctx);
+    if (ctx->total < ctx->capacity) {
+        ctx->records[ctx->total] = to_terminal_record(*record);
+    }
+    ctx->total += 1;
+    return true;
+}
+
+struct RecordArenaCtx {
+    std::vector<TerminalRecord> *records;
+    bool ok;
+};
+
+bool accumulate_arena(const terminal_event_record_t *record, void *user_ctx) {
+    if (!record || !user_ctx) {
+        return false;
+    }
+
+    auto *ctx = static_cast<RecordArenaCtx *>(user_ctx);
+    try {
+        ctx->records->push_back(to_terminal_record(*record));
+        return true;
+    } catch (...) {
+        ctx->ok = false;
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_northbound",
+                      "failed to grow terminal record arena");
+    }
+    return false;
+}
+
 std::mutex g_inc_report_mutex;
 IncReportCb g_inc_report_cb = nullptr;
+IncRecordReportCb g_inc_record_cb = nullptr;
 
-void inc_report_adapter(const terminal_event_record_t *records, size_t count, void *ctx) {
-    (void)ctx;
+/* Batch staging for IncRecordReportCb. The manager delivers batches one at a
+ * time, so a single buffer reused across batches suffices; it only grows when
+ * a batch is larger than any seen before. */
+std::mutex g_inc_record_mutex;
+std::vector<TerminalRecord> g_inc_record_buffer;
 
-    IncReportCb cb = nullptr;
-    {
-        std::lock_guard<std::mutex> lock(g_inc_report_mutex);
-        cb = g_inc_report_cb;
+void report_records(IncRecordReportCb cb, const terminal_event_record_t *records, size_t count) {
+    std::lock_guard<std::mutex> lock(g_inc_record_mutex);
+    try {
+        g_inc_record_buffer.clear();
+        g_inc_record_buffer.reserve(count);
+    } catch (...) {
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_northbound",
+                      "failed to prepare incremental record batch");
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        g_inc_record_buffer.push_back(to_terminal_record(records[i]));
     }
 
-    if (!cb) {
-        return;
+    try {
+        cb(TerminalRecordSpan{g_inc_record_buffer.data(), g_inc_record_buffer.size()});
+    } catch (const std::exception &ex) {
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_northbound",
+                      "IncRecordReportCb raised exception: %s",
+                      ex.what());
+    } catch (...) {
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_northbound",
+                      "IncRecordReportCb raised unknown exception");
     }
+}
 
+void report_strings(IncReportCb cb, const terminal_event_record_t *records, size_t count) {
     MAC_IP_INFO payload;
     try {
         payload.reserve(count);
         for (size_t i = 0; i < count; ++i) {
-            TerminalInfo info;
-            info.mac = format_mac(records[i].key.mac);
-            info.ip = format_ip(records[i].key.ip);
-            info.ifindex = records[i].ifindex;
-            info.prev_ifindex = records[i].prev_ifindex;
-            info.tag = to_modify_tag(records[i].tag);
-            payload.push_back(std::move(info));
+            payload.push_back(toTerminalInfo(to_terminal_record(records[i])));
         }
     } catch (const std::exception &ex) {
         td_log_writef(TD_LOG_ERROR,
@@ -158,6 +214,75 @@ void inc_report_adapter(const terminal_event_record_t *records, size_t count, vo
     }
 }
 
+void inc_report_adapter(const terminal_event_record_t *records, size_t count, void *ctx) {
+    (void)ctx;
+
+    IncReportCb cb = nullptr;
+    IncRecordReportCb record_cb = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_inc_report_mutex);
+        cb = g_inc_report_cb;
+        record_cb = g_inc_record_cb;
+    }
+
+    if (record_cb) {
+        report_records(record_cb, records, count);
+    }
+    if (cb) {
+        report_strings(cb, records, count);
+    }
+}
+
+/* Installs inc_report_adapter for the first registered callback; the
+ * adapter fans out to whichever of the two is set. */
+int register_inc_report(const char *api_name, IncReportCb cb, IncRecordReportCb record_cb) {
+    struct terminal_manager *mgr = terminal_manager_get_active();
+    if (!mgr) {
+        td_log_writef(TD_LOG_WARN,
+                      "terminal_northbound",
+                      "%s called without an active terminal manager",
+                      api_name);
+        return -ENODEV;
+    }
+
+    bool attach = false;
+    {
+        std::lock_guard<std::mutex> lock(g_inc_report_mutex);
+        if ((cb && g_inc_report_cb) || (record_cb && g_inc_record_cb)) {
+            td_log_writef(TD_LOG_WARN,
+                          "terminal_northbound",
+                          "%s invoked multiple times",
+                          api_name);
+            return -EALREADY;
+        }
+        attach = !g_inc_report_cb && !g_inc_record_cb;
+        if (cb) {
+            g_inc_report_cb = cb;
+        }
+        if (record_cb) {
+            g_inc_record_cb = record_cb;
+        }
+    }
+
+    if (!attach) {
+        return 0;
+    }
+
+    int rc = terminal_manager_set_event_sink(mgr, inc_report_adapter, nullptr);
+    if (rc != 0) {
+        std::lock_guard<std::mutex> lock(g_inc_report_mutex);
+        g_inc_report_cb = nullptr;
+        g_inc_record_cb = nullptr;
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_northbound",
+                      "terminal_manager_set_event_sink failed: %d",
+                      rc);
+        return rc;
+    }
+
+    return 0;
+}
+
 void default_event_logger(const terminal_event_record_t *records, size_t count, void *ctx) {
     (void)ctx;
     if (!records || count == 0) {
@@ -258,6 +383,7 @@ extern "C" int terminal_northbound_attach_default_sink(struct terminal_manager *
     {
         std::lock_guard<std::mutex> lock(g_inc_report_mutex);
         g_inc_report_cb = nullptr;
+        g_inc_record_cb = nullptr;
     }
 
     int rc = terminal_manager_set_event_sink(manager, default_event_logger, nullptr);
@@ -278,39 +404,249 @@ extern "C" int setIncrementReport(IncReportCb cb) {
         return -EINVAL;
     }
 
+    return register_inc_report("setIncrementReport", cb, nullptr);
+}
+
+extern "C" int setIncrementRecordReport(IncRecordReportCb cb) {
+    if (!cb) {
+        td_log_writef(TD_LOG_WARN,
+                      "terminal_northbound",
+                      "setIncrementRecordReport requires a non-null callback");
+        return -EINVAL;
+    }
+
+    return register_inc_report("setIncrementRecordReport", nullptr, cb);
+}
+
+extern "C" int getAllTerminalRecords(TerminalRecord *records, std::size_t capacity, std::size_t *total) {
+    if ((!records && capacity > 0) || !total) {
+        return -EINVAL;
+    }
+    *total = 0;
+
     struct terminal_manager *mgr = terminal_manager_get_active();
     if (!mgr) {
         td_log_writef(TD_LOG_WARN,
                       "terminal_northbound",
-                      "setIncrementReport called without an active terminal manager");
+                      "getAllTerminalRecords called without an active terminal manager");
         return -ENODEV;
     }
 
-    {
-        std::lock_guard<std::mutex> lock(g_inc_report_mutex);
-        if (g_inc_report_cb) {
-            td_log_writef(TD_LOG_WARN,
+    RecordBufferCtx ctx{records, capacity, 0};
+    int rc = terminal_manager_query_all(mgr, accumulate_records, &ctx);
+    if (rc != 0) {
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_northbound",
+                      "terminal_manager_query_all failed: %d",
+                      rc);
+        return rc;
+    }
+
+    *total = ctx.total;
+    return ctx.total > capacity ? -ENOSPC : 0;
+}
+
+int getAllTerminalRecordsInto(TerminalRecordArena &arena) {
+    arena.clear();
+
+    struct terminal_manager *mgr = terminal_manager_get_active();
+    if (!mgr) {
+        td_log_writef(TD_LOG_WARN,
+                      "terminal_northbound",
+                      "getAllTerminalRecordsInto called without an active terminal manager");
+        return -ENODEV;
+    }
+
+    RecordArenaCtx ctx{&arena.records_, true};
+    uint64_t version = 0;
+    int rc = terminal_manager_query_snapshot(mgr, accumulate_arena, &ctx, &version);
+    if (rc != 0) {
+        td_log_writef(TD_LOG_ERROR,
+                      "terminal_northbound",
+                      "terminal_manager_query_snapshot failed: %d",
+                      rc);
+        arena.clear();
+        return rc;
+    }
+
+    if (!ctx.ok) {
+        arena.clear();
+        return -ENOMEM;
+    }
+
+    arena.version_ = version;
+    return 0;
+}
+
+int getTerminalRecordsSince(std::uint64_t since, TerminalRecordArena &arena) {
+    arena.clear();
+
+    struct terminal_manager *mgr = terminal_manager_get_active();
+    if (!mgr) {
+        td_log_writef(TD_LOG_WARN,
+                      "terminal_northbound",
+                      "getTerminalRecordsSince called without an active terminal manager");
+        return -ENODEV;
+    }
+
+    RecordArenaCtx ctx{&arena.records_, true};
+    uint64_t latest = 0;
+    int rc = terminal_manager_query_since(mgr, since, accumulate_arena, &ctx, &latest);
+    if (rc != 0) {
+        if (rc != -ESTALE) {
+            td_log_writef(TD_LOG_ERROR,
                           "terminal_northbound",
-                          "setIncrementReport invoked multiple times");
-            return -EALREADY;
+                          "terminal_manager_query_since failed: %d",
+                          rc);
         }
-        g_inc_report_cb = cb;
+        arena.clear();
+        return rc;
     }
 
-    int rc = terminal_manager_set_event_sink(mgr, inc_report_adapter, nullptr);
+    if (!ctx.ok) {
+        arena.clear();
+        return -ENOMEM;
+    }
+
+    arena.version_ = latest;
+    return 0;
+}
+
+int getTerminalRecordsPage(const TerminalQueryFilter &filter,
+                           TerminalQueryPage &page,
+                           TerminalRecordArena &arena) {
+    arena.clear();
+
+    struct terminal_manager *mgr = terminal_manager_get_active();
+    if (!mgr) {
+        td_log_writef(TD_LOG_WARN,
+                      "terminal_northbound",
+                      "getTerminalRecordsPage called without an active terminal manager");
+        return -ENODEV;
+    }
+
+    terminal_query_filter_t c_filter = filter.to_c();
+    terminal_query_page_t c_page;
+    std::memset(&c_page, 0, sizeof(c_page));
+    c_page.limit = page.limit;
+    c_page.has_cursor = page.hasCursor;
+    c_page.cursor = page.cursor;
+
+    RecordArenaCtx ctx{&arena.records_, true};
+    int rc = terminal_manager_query_filtered(mgr, &c_filter, &c_page, accumulate_arena, &ctx);
     if (rc != 0) {
-        std::lock_guard<std::mutex> lock(g_inc_report_mutex);
-        g_inc_report_cb = nullptr;
         td_log_writef(TD_LOG_ERROR,
                       "terminal_northbound",
-                      "terminal_manager_set_event_sink failed: %d",
+                      "terminal_manager_query_filtered failed: %d",
                       rc);
+        arena.clear();
         return rc;
     }
 
+    if (!ctx.ok) {
+        arena.clear();
+        return -ENOMEM;
+    }
+
+    page.more = c_page.more;
+    page.total = c_page.total;
+    page.hasCursor = c_page.has_cursor;
+    page.cursor = c_page.cursor;
+    arena.version_ = c_page.version;
+    return 0;
+}
+
+int lookupTerminalRecordsByMac(const std::uint8_t *mac, TerminalRecordArena &arena) {
+    arena.clear();
+    if (!mac) {
+        return -EINVAL;
+    }
+
+    struct terminal_manager *mgr = terminal_manager_get_active();
+    if (!mgr) {
+        td_log_writef(TD_LOG_WARN,
+                      "terminal_northbound",
+                      "lookupTerminalRecordsByMac called without an active terminal manager");
+        return -ENODEV;
+    }
+
+    RecordArenaCtx ctx{&arena.records_, true};
+    int rc = terminal_manager_lookup_by_mac(mgr, mac, accumulate_arena, &ctx);
+    if (rc != 0 || !ctx.ok) {
+        arena.clear();
+        return rc != 0 ? rc : -ENOMEM;
+    }
+    return 0;
+}
+
+int lookupTerminalRecordsByIp(std::uint32_t ipv4, TerminalRecordArena &arena) {
+    arena.clear();
+
+    struct terminal_manager *mgr = terminal_manager_get_active();
+    if (!mgr) {
+        td_log_writef(TD_LOG_WARN,
+                      "terminal_northbound",
+                      "lookupTerminalRecordsByIp called without an active terminal manager");
+        return -ENODEV;
+    }
+
+    struct in_addr addr;
+    addr.s_addr = ipv4;
+    RecordArenaCtx ctx{&arena.records_, true};
+    int rc = terminal_manager_lookup_by_ip(mgr, addr, accumulate_arena, &ctx);
+    if (rc != 0 || !ctx.ok) {
+        arena.clear();
+        return rc != 0 ? rc : -ENOMEM;
+    }
     return 0;
 }
 
+bool formatTerminalMac(const TerminalRecord &record, char *buf, std::size_t len) noexcept {
+    if (!buf || len < kTerminalMacStrLen) {
+        return false;
+    }
+    std::snprintf(buf,
+                  len,
+                  "%02x:%02x:%02x:%02x:%02x:%02x",
+                  record.mac[0],
+                  record.mac[1],
+                  record.mac[2],
+                  record.mac[3],
+                  record.mac[4],
+                  record.mac[5]);
+    return true;
+}
+
+bool formatTerminalIp(const TerminalRecord &record, char *buf, std::size_t len) noexcept {
+    if (!buf || len < kTerminalIpStrLen) {
+        return false;
+    }
+    struct in_addr ip;
+    ip.s_addr = record.ipv4;
+    return inet_ntop(AF_INET, &ip, buf, static_cast<socklen_t>(len)) != nullptr;
+}
+
+TerminalInfo toTerminalInfo(const TerminalRecord &record) {
+    char mac_buf[kTerminalMacStrLen];
+    char ip_buf[kTerminalIpStrLen];
+
+    TerminalInfo info;
+    formatTerminalMac(record, mac_buf, sizeof(mac_buf));
+    info.mac = mac_buf;
+    if (formatTerminalIp(record, ip_buf, sizeof(ip_buf))) {
+        info.ip = ip_buf;
+    } else {
+        td_log_writef(TD_LOG_WARN,
+                      "terminal_northbound",
+                      "inet_ntop failed: %s",
+                      std::strerror(errno));
+    }
+    info.ifindex = record.ifindex;
+    info.prev_ifindex = record.prev_ifindex;
+    info.tag = record.tag;
+    return info;
+}
+
 TerminalDebugSnapshot::TerminalDebugSnapshot(struct terminal_manager *manager) noexcept
     : manager_(manager) {}
 
@@ -0,0 +1,271 @@
+#define _GNU_SOURCE
+
+#include "terminal_probe_scheduler.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "td_logging.h"
+
+#define NSEC_PER_MSEC 1000000ULL
+#define NSEC_PER_SEC 1000000000ULL
+
+struct probe_slot {
+    terminal_probe_request_t request;
+    uint64_t submitted_ns;
+};
+
+struct terminal_probe_scheduler {
+    pthread_mutex_t lock;
+    pthread_cond_t cond; /* CLOCK_MONOTONIC */
+    pthread_t thread;
+    bool started;
+    bool stopping;
+    bool stopped;
+
+    terminal_probe_send_fn send_fn;
+    void *send_ctx;
+
+    struct probe_slot *slots;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    bool overflow_logged;
+
+    uint64_t interval_ns;
+    uint64_t bucket_ns;  /* burst * interval_ns */
+    uint64_t credit_ns;  /* banked send time, at most bucket_ns */
+    uint64_t refill_ns;  /* when credit_ns was last topped up */
+
+    struct terminal_probe_scheduler_stats stats;
+    uint64_t pacing_wait_ns;
+    uint64_t queue_delay_ns;
+    uint64_t max_queue_delay_ns;
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static void scheduler_refill_locked(struct terminal_probe_scheduler *scheduler, uint64_t now) {
+    if (now > scheduler->refill_ns) {
+        uint64_t credit = scheduler->credit_ns + (now - scheduler->refill_ns);
+        scheduler->credit_ns = credit > scheduler->bucket_ns ? scheduler->bucket_ns : credit;
+    }
+    scheduler->refill_ns = now;
+}
+
+static void scheduler_wait_until_locked(struct terminal_probe_scheduler *scheduler, uint64_t deadline) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(deadline / NSEC_PER_SEC),
+        .tv_nsec = (long)(deadline % NSEC_PER_SEC),
+    };
+    pthread_cond_timedwait(&scheduler->cond, &scheduler->lock, &ts);
+}
+
+static void *terminal_probe_scheduler_main(void *arg) {
+    struct terminal_probe_scheduler *scheduler = arg;
+    terminal_probe_request_t batch[TERMINAL_PROBE_SEND_BATCH_MAX];
+
+    pthread_mutex_lock(&scheduler->lock);
+    while (!scheduler->stopping) {
+        if (scheduler->count == 0) {
+            scheduler->overflow_logged = false;
+            pthread_cond_wait(&scheduler->cond, &scheduler->lock);
+            continue;
+        }
+
+        uint64_t now = monotonic_ns();
+        size_t tokens = scheduler->count;
+        if (scheduler->interval_ns > 0) {
+            scheduler_refill_locked(scheduler, now);
+            if (scheduler->credit_ns < scheduler->interval_ns) {
+                /* Submits only signal an empty queue, so this sleep runs to
+                 * the next token unless stop interrupts it. */
+                scheduler->stats.pacing_waits += 1;
+                scheduler_wait_until_locked(scheduler,
+                                            now + (scheduler->interval_ns - scheduler->credit_ns));
+                scheduler->pacing_wait_ns += monotonic_ns() - now;
+                continue;
+            }
+            uint64_t available = scheduler->credit_ns / scheduler->interval_ns;
+            if (available < tokens) {
+                tokens = (size_t)available;
+            }
+        }
+        if (tokens > TERMINAL_PROBE_SEND_BATCH_MAX) {
+            tokens = TERMINAL_PROBE_SEND_BATCH_MAX;
+        }
+        scheduler->credit_ns -= scheduler->interval_ns * tokens;
+
+        for (size_t i = 0; i < tokens; ++i) {
+            const struct probe_slot *slot = &scheduler->slots[scheduler->head];
+            batch[i] = slot->request;
+            uint64_t delay = now > slot->submitted_ns ? now - slot->submitted_ns : 0U;
+            scheduler->queue_delay_ns += delay;
+            if (delay > scheduler->max_queue_delay_ns) {
+                scheduler->max_queue_delay_ns = delay;
+            }
+            scheduler->head = (scheduler->head + 1U) % scheduler->capacity;
+        }
+        scheduler->count -= tokens;
+
+        pthread_mutex_unlock(&scheduler->lock);
+        scheduler->send_fn(batch, tokens, scheduler->send_ctx);
+        pthread_mutex_lock(&scheduler->lock);
+        scheduler->stats.sent += tokens;
+        scheduler->stats.send_batches += 1;
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+    return NULL;
+}
+
+int terminal_probe_scheduler_create(const struct terminal_probe_scheduler_config *cfg,
+                                    terminal_probe_send_fn send_fn,
+                                    void *send_ctx,
+                                    struct terminal_probe_scheduler **out) {
+    if (!send_fn || !out) {
+        return -EINVAL;
+    }
+
+    struct terminal_probe_scheduler *scheduler = calloc(1, sizeof(*scheduler));
+    if (!scheduler) {
+        return -ENOMEM;
+    }
+
+    unsigned int interval_ms = cfg ? cfg->interval_ms : 0U;
+    unsigned int burst = (cfg && cfg->burst > 0U) ? cfg->burst : 1U;
+    size_t capacity = (cfg && cfg->queue_size > 0U) ? cfg->queue_size : TERMINAL_PROBE_QUEUE_DEFAULT_SIZE;
+
+    scheduler->slots = calloc(capacity, sizeof(*scheduler->slots));
+    if (!scheduler->slots) {
+        free(scheduler);
+        return -ENOMEM;
+    }
+    scheduler->capacity = capacity;
+    scheduler->send_fn = send_fn;
+    scheduler->send_ctx = send_ctx;
+    scheduler->interval_ns = (uint64_t)interval_ms * NSEC_PER_MSEC;
+    scheduler->bucket_ns = scheduler->interval_ns * burst;
+    scheduler->credit_ns = scheduler->bucket_ns;
+    scheduler->refill_ns = monotonic_ns();
+    scheduler->stats.queue_capacity = capacity;
+
+    pthread_mutex_init(&scheduler->lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&scheduler->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    int rc = pthread_create(&scheduler->thread, NULL, terminal_probe_scheduler_main, scheduler);
+    if (rc != 0) {
+        pthread_cond_destroy(&scheduler->cond);
+        pthread_mutex_destroy(&scheduler->lock);
+        free(scheduler->slots);
+        free(scheduler);
+        return -rc;
+    }
+    scheduler->started = true;
+
+    *out = scheduler;
+    return 0;
+}
+
+int terminal_probe_scheduler_submit(struct terminal_probe_scheduler *scheduler,
+                                    const terminal_probe_request_t *request) {
+    if (!scheduler || !request) {
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&scheduler->lock);
+    if (scheduler->stopping) {
+        pthread_mutex_unlock(&scheduler->lock);
+        return -ESHUTDOWN;
+    }
+    if (scheduler->count == scheduler->capacity) {
+        scheduler->stats.dropped += 1;
+        bool log_overflow = !scheduler->overflow_logged;
+        scheduler->overflow_logged = true;
+        pthread_mutex_unlock(&scheduler->lock);
+        if (log_overflow) {
+            td_log_writef(TD_LOG_WARN,
+                          "probe_scheduler",
+                          "probe queue full (capacity=%zu); dropping probes until it drains",
+                          scheduler->capacity);
+        }
+        return -EAGAIN;
+    }
+
+    size_t tail = (scheduler->head + scheduler->count) % scheduler->capacity;
+    scheduler->slots[tail].request = *request;
+    scheduler->slots[tail].submitted_ns = monotonic_ns();
+    scheduler->count += 1U;
+    scheduler->stats.enqueued += 1;
+    if (scheduler->count > scheduler->stats.queue_high_water) {
+        scheduler->stats.queue_high_water = scheduler->count;
+    }
+    if (scheduler->count == 1U) {
+        pthread_cond_signal(&scheduler->cond);
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+    return 0;
+}
+
+void terminal_probe_scheduler_stop(struct terminal_probe_scheduler *scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    pthread_mutex_lock(&scheduler->lock);
+    if (scheduler->stopped) {
+        pthread_mutex_unlock(&scheduler->lock);
+        return;
+    }
+    scheduler->stopping = true;
+    pthread_cond_broadcast(&scheduler->cond);
+    pthread_mutex_unlock(&scheduler->lock);
+
+    if (scheduler->started) {
+        pthread_join(scheduler->thread, NULL);
+        scheduler->started = false;
+    }
+
+    pthread_mutex_lock(&scheduler->lock);
+    scheduler->head = 0;
+    scheduler->count = 0;
+    scheduler->stopped = true;
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+void terminal_probe_scheduler_destroy(struct terminal_probe_scheduler *scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    terminal_probe_scheduler_stop(scheduler);
+    pthread_cond_destroy(&scheduler->cond);
+    pthread_mutex_destroy(&scheduler->lock);
+    free(scheduler->slots);
+    free(scheduler);
+}
+
+void terminal_probe_scheduler_get_stats(struct terminal_probe_scheduler *scheduler,
+                                        struct terminal_probe_scheduler_stats *out) {
+    if (!scheduler || !out) {
+        return;
+    }
+
+    pthread_mutex_lock(&scheduler->lock);
+    *out = scheduler->stats;
+    out->queue_depth = scheduler->count;
+    out->pacing_wait_ms = scheduler->pacing_wait_ns / NSEC_PER_MSEC;
+    out->queue_delay_ms = scheduler->queue_delay_ns / NSEC_PER_MSEC;
+    out->max_queue_delay_ms = scheduler->max_queue_delay_ns / NSEC_PER_MSEC;
+    pthread_mutex_unlock(&scheduler->lock);
+}
@@ -43,11 +43,27 @@ typedef enum {
 
 typedef struct td_adapter td_adapter_t;
 
+typedef enum {
+    TD_ADAPTER_RX_MODE_RECVMSG = 0, /* one recvmsg() per frame (default) */
+    TD_ADAPTER_RX_MODE_MMAP = 1,    /* TPACKET_V3 PACKET_RX_RING, falls back to recvmsg */
+    TD_ADAPTER_RX_MODE_RECVMMSG = 2, /* recvmmsg() drain until EAGAIN, for kernels without PACKET_MMAP */
+} td_adapter_rx_mode_t;
+
 struct td_adapter_config {
     const char *rx_iface;           /* inbound raw socket interface */
     const char *tx_iface;           /* outbound physical interface */
-    unsigned int tx_interval_ms;    /* minimum gap between ARP probes */
-    unsigned int rx_ring_size;      /* optional fan-out / ring size hint */
+    unsigned int tx_interval_ms;    /* probe gap the caller paces send_arp to; informational here */
+    unsigned int rx_ring_size;      /* optional ring size hint; ring bytes in MMAP mode, else SO_RCVBUF */
+    td_adapter_rx_mode_t rx_mode;   /* receive path selection */
+    unsigned int rx_batch_size;     /* frames per recvmmsg() in RECVMMSG mode; 0 selects the default */
+    unsigned int rx_fanout;         /* RX sockets/threads in one PACKET_FANOUT group; 0 or 1 disables */
+    const char *rx_cpu_list;        /* optional CPU list ("0,2-3") RX threads are pinned to round-robin */
+};
+
+struct td_adapter_rx_stats {
+    uint64_t wakeups;                /* RX thread wakeups that delivered at least one frame */
+    uint64_t frames;                 /* frames read from the socket or ring */
+    uint32_t max_frames_per_wakeup;  /* largest single wakeup seen */
 };
 
 struct td_adapter_env {
@@ -61,7 +77,7 @@ struct td_adapter_env {
 struct td_adapter_mac_locator_ops;
 
 struct td_adapter_packet_view {
-    const uint8_t *frame;       /* pointer to full Ethernet frame */
+    const uint8_t *frame;       /* pointer to full Ethernet frame, valid only during the callback */
     size_t frame_len;           /* length of full frame */
     const uint8_t *payload;     /* pointer to protocol payload start */
     size_t payload_len;         /* payload length */
@@ -81,6 +97,16 @@ struct td_adapter_packet_subscription {
     void *user_ctx;
 };
 
+/* Views in the array are only valid for the duration of the callback. */
+typedef void (*td_adapter_packet_batch_cb)(const struct td_adapter_packet_view *packets,
+                                           size_t count,
+                                           void *user_ctx);
+
+struct td_adapter_packet_batch_subscription {
+    td_adapter_packet_batch_cb callback;
+    void *user_ctx;
+};
+
 struct td_adapter_iface_info {
     char ifname[IFNAMSIZ];
     uint8_t mac[ETH_ALEN];
@@ -108,11 +134,23 @@ struct td_adapter_ops {
     void (*stop)(td_adapter_t *handle);
     td_adapter_result_t (*register_packet_rx)(td_adapter_t *handle,
                                               const struct td_adapter_packet_subscription *sub);
+    td_adapter_result_t (*register_packet_rx_batch)(td_adapter_t *handle,
+                                                    const struct td_adapter_packet_batch_subscription *sub); /* optional */
     td_adapter_result_t (*send_arp)(td_adapter_t *handle,
                                     const struct td_adapter_arp_request *req);
+    /* Optional. Sends count probes in as few syscalls as the platform allows;
+     * results[i] receives what send_arp would have returned for requests[i].
+     * Any result other than OK applies to the whole batch and leaves results
+     * unspecified. */
+    td_adapter_result_t (*send_arp_batch)(td_adapter_t *handle,
+                                          const struct td_adapter_arp_request *requests,
+                                          td_adapter_result_t *results,
+                                          size_t count);
     td_adapter_result_t (*query_iface)(td_adapter_t *handle,
                                        const char *ifname,
                                        struct td_adapter_iface_info *info_out);
+    td_adapter_result_t (*get_rx_stats)(td_adapter_t *handle,
+                                        struct td_adapter_rx_stats *stats_out); /* optional */
     void (*log_write)(td_adapter_t *handle,
                       td_log_level_t level,
                       const char *component,
@@ -122,6 +160,39 @@ struct td_adapter_ops {
 
 typedef void (*td_adapter_mac_locator_refresh_cb)(uint64_t version, void *ctx);
 
+/* One (mac, vlan) whose port differs between two consecutive MAC table
+ * snapshots; old_ifindex == 0 means newly learned, new_ifindex == 0 aged out. */
+struct td_adapter_mac_delta {
+    uint8_t mac[ETH_ALEN];
+    uint16_t vlan_id;
+    uint32_t old_ifindex;
+    uint32_t new_ifindex;
+};
+
+/* Change set published after a refresh. deltas take base_version to version;
+ * base_version == 0 means no diff is available (first snapshot, too many
+ * changes) and every cached binding must be re-verified. version == 0 reports
+ * a failed refresh. Only valid for the duration of the callback. */
+struct td_adapter_mac_delta_batch {
+    uint64_t version;
+    uint64_t base_version;
+    const struct td_adapter_mac_delta *deltas;
+    size_t count;
+};
+
+typedef void (*td_adapter_mac_locator_delta_cb)(const struct td_adapter_mac_delta_batch *batch,
+                                                void *ctx);
+
+/* One element of a batched MAC lookup. The caller fills mac and vlan_id; the
+ * adapter fills rc and, as lookup would, ifindex and version. */
+struct td_adapter_mac_lookup {
+    uint8_t mac[ETH_ALEN];
+    uint16_t vlan_id;
+    td_adapter_result_t rc;
+    uint32_t ifindex;
+    uint64_t version;
+};
+
 struct td_adapter_mac_locator_ops {
     td_adapter_result_t (*lookup)(td_adapter_t *handle,
                                   const uint8_t mac[ETH_ALEN],
@@ -137,6 +208,17 @@ struct td_adapter_mac_locator_ops {
                                      void *ctx);
     td_adapter_result_t (*get_version)(td_adapter_t *handle,
                                        uint64_t *version_out);
+    /* Optional; takes the place of subscribe when present. The adapter keeps
+     * a single subscriber across subscribe and subscribe_delta. */
+    td_adapter_result_t (*subscribe_delta)(td_adapter_t *handle,
+                                           td_adapter_mac_locator_delta_cb cb,
+                                           void *ctx);
+    /* Optional; resolves count requests against one table generation.
+     * TD_ADAPTER_OK means every element's rc is set; any other result
+     * applies to the whole batch. */
+    td_adapter_result_t (*lookup_batch)(td_adapter_t *handle,
+                                        struct td_adapter_mac_lookup *requests,
+                                        size_t count);
 };
 
 struct td_adapter_descriptor {
@@ -8,6 +8,7 @@ extern "C" {
 #endif
 
 #define TD_ADAPTER_NAME_MAX 64
+#define TD_CPU_LIST_MAX 64
 
 struct terminal_manager_config;
 
@@ -16,6 +17,7 @@ struct terminal_manager_config;
 #define TD_DEFAULT_MAX_TERMINALS 1000U
 #define TD_DEFAULT_IFACE_INVALID_HOLDOFF_SEC 1800U
 #define TD_DEFAULT_STATS_LOG_INTERVAL_SEC 0U
+#define TD_DEFAULT_TX_BURST 1U
 #ifndef TD_MAX_IGNORED_VLANS
 #define TD_MAX_IGNORED_VLANS 32U
 #endif
@@ -25,11 +27,22 @@ struct td_runtime_config {
     char rx_iface[IFNAMSIZ];
     char tx_iface[IFNAMSIZ];
     unsigned int tx_interval_ms;
+    unsigned int tx_burst;      /* probes the scheduler may send back to back */
+    unsigned int tx_queue_size; /* 0 selects TERMINAL_PROBE_QUEUE_DEFAULT_SIZE */
+    td_adapter_rx_mode_t rx_mode;
+    unsigned int rx_ring_size;
+    unsigned int rx_batch_size;
+    unsigned int rx_fanout;
+    char rx_cpu_list[TD_CPU_LIST_MAX];
     unsigned int keepalive_interval_sec;
     unsigned int keepalive_miss_threshold;
     unsigned int iface_invalid_holdoff_sec;
     unsigned int max_terminals;
     unsigned int stats_log_interval_sec;
+    unsigned int event_ring_size;
+    unsigned int event_overflow_policy; /* terminal_event_overflow_policy_t */
+    unsigned int event_window_ms;
+    unsigned int event_journal_size;
     td_log_level_t log_level;
     size_t ignored_vlan_count;
     uint16_t ignored_vlans[TD_MAX_IGNORED_VLANS];
@@ -0,0 +1,58 @@
+#ifndef TD_OBJECT_POOL_H
+#define TD_OBJECT_POOL_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct td_object_pool_stats {
+    uint64_t in_use;       /* objects currently handed out */
+    uint64_t capacity;     /* objects across all slabs */
+    uint64_t slabs;        /* slabs allocated so far */
+    uint64_t peak_in_use;  /* high-water mark of in_use */
+    uint64_t alloc_failures; /* allocations that could not grow the pool */
+};
+
+struct td_object_pool_slab;
+struct td_object_pool_free_node;
+
+/* Fixed-size object pool. Objects are carved from slabs of objects_per_slab
+ * and recycled through a freelist; slabs are only returned to the heap by
+ * td_object_pool_destroy, so a long-running process settles at its peak
+ * footprint instead of fragmenting the heap. All calls are thread-safe. */
+struct td_object_pool {
+    pthread_mutex_t lock;
+    size_t object_size;
+    size_t objects_per_slab;
+    struct td_object_pool_slab *slabs;
+    struct td_object_pool_free_node *free_list;
+    size_t in_use;
+    size_t capacity;
+    size_t slab_count;
+    size_t peak_in_use;
+    uint64_t alloc_failures;
+};
+
+int td_object_pool_init(struct td_object_pool *pool,
+                        size_t object_size,
+                        size_t objects_per_slab);
+
+void td_object_pool_destroy(struct td_object_pool *pool);
+
+/* Returns a zeroed object, or NULL when a new slab cannot be allocated. */
+void *td_object_pool_alloc(struct td_object_pool *pool);
+
+void td_object_pool_free(struct td_object_pool *pool, void *object);
+
+void td_object_pool_get_stats(struct td_object_pool *pool,
+                              struct td_object_pool_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TD_OBJECT_POOL_H */
@@ -2,9 +2,11 @@
 #define TERMINAL_DISCOVERY_API_HPP
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 extern "C" {
@@ -31,6 +33,152 @@ using IncReportCb = void (*)(const MAC_IP_INFO &info);
 extern "C" int getAllTerminalInfo(MAC_IP_INFO &allTerIpInfo);
 extern "C" int setIncrementReport(IncReportCb cb);
 
+/*
+ * Binary form of TerminalInfo: fixed-size POD with no heap members, so full
+ * queries and incremental batches can be delivered as flat arrays. ipv4 stays
+ * in network byte order; text is only produced on demand by the format
+ * helpers below.
+ */
+struct TerminalRecord {
+    std::uint8_t mac[ETH_ALEN];
+    std::uint8_t reserved[2];
+    std::uint32_t ipv4;
+    std::uint32_t ifindex;
+    std::uint32_t prev_ifindex;
+    ModifyTag tag;
+};
+
+static_assert(std::is_standard_layout<TerminalRecord>::value &&
+                  std::is_trivially_copyable<TerminalRecord>::value,
+              "TerminalRecord must stay a POD");
+static_assert(sizeof(TerminalRecord) == 24, "TerminalRecord layout changed");
+
+constexpr std::size_t kTerminalMacStrLen = 18;  /* "xx:xx:xx:xx:xx:xx" + NUL */
+constexpr std::size_t kTerminalIpStrLen = 16;   /* INET_ADDRSTRLEN */
+
+/* Write the textual MAC/IP into caller storage; return false if len is short. */
+bool formatTerminalMac(const TerminalRecord &record, char *buf, std::size_t len) noexcept;
+bool formatTerminalIp(const TerminalRecord &record, char *buf, std::size_t len) noexcept;
+TerminalInfo toTerminalInfo(const TerminalRecord &record);
+
+struct TerminalRecordSpan {
+    const TerminalRecord *data;
+    std::size_t size;
+
+    const TerminalRecord *begin() const noexcept { return data; }
+    const TerminalRecord *end() const noexcept { return data + size; }
+    bool empty() const noexcept { return size == 0; }
+};
+
+/*
+ * Reusable storage for full queries. Capacity is kept across calls, so once
+ * it has grown to the terminal count a refresh performs no allocation.
+ * version() is the event sequence the records are current to, usable as the
+ * cursor for getTerminalRecordsSince.
+ */
+struct TerminalQueryPage;
+struct TerminalQueryFilter;
+
+class TerminalRecordArena {
+public:
+    TerminalRecordArena() = default;
+    explicit TerminalRecordArena(std::size_t reserve_hint) { records_.reserve(reserve_hint); }
+
+    TerminalRecordSpan records() const noexcept { return TerminalRecordSpan{records_.data(), records_.size()}; }
+    std::size_t capacity() const noexcept { return records_.capacity(); }
+    std::uint64_t version() const noexcept { return version_; }
+    void clear() noexcept {
+        records_.clear();
+        version_ = 0;
+    }
+
+private:
+    friend int getAllTerminalRecordsInto(TerminalRecordArena &arena);
+    friend int getTerminalRecordsSince(std::uint64_t since, TerminalRecordArena &arena);
+    friend int getTerminalRecordsPage(const TerminalQueryFilter &filter,
+                                      TerminalQueryPage &page,
+                                      TerminalRecordArena &arena);
+    friend int lookupTerminalRecordsByMac(const std::uint8_t *mac, TerminalRecordArena &arena);
+    friend int lookupTerminalRecordsByIp(std::uint32_t ipv4, TerminalRecordArena &arena);
+    std::vector<TerminalRecord> records_;
+    std::uint64_t version_ = 0;
+};
+
+using IncRecordReportCb = void (*)(TerminalRecordSpan records);
+
+/*
+ * Copy up to capacity records into the caller's buffer. *total receives the
+ * number of terminals present; -ENOSPC is returned when it exceeds capacity
+ * (the first capacity entries are still filled).
+ */
+extern "C" int getAllTerminalRecords(TerminalRecord *records, std::size_t capacity, std::size_t *total);
+int getAllTerminalRecordsInto(TerminalRecordArena &arena);
+/*
+ * Fill the arena with the changes made after `since` (typically an earlier
+ * arena.version()) and advance version() to the newest event. -ESTALE means
+ * the journal no longer reaches back that far and a full query is needed.
+ */
+int getTerminalRecordsSince(std::uint64_t since, TerminalRecordArena &arena);
+/* Server-side filter for getTerminalRecordsPage; unset criteria match everything. */
+struct TerminalQueryFilter {
+    bool filterByVlan = false;
+    int vlanId = -1;
+    bool filterByIfindex = false;
+    std::uint32_t ifindex = 0;
+    bool filterByState = false;
+    terminal_state_t state = TERMINAL_STATE_ACTIVE;
+    bool filterByMacPrefix = false;
+    std::array<std::uint8_t, ETH_ALEN> macPrefix{{0}};
+    std::size_t macPrefixLen = 0;
+
+    terminal_query_filter_t to_c() const {
+        terminal_query_filter_t filter;
+        std::memset(&filter, 0, sizeof(filter));
+        filter.filter_by_vlan = filterByVlan;
+        filter.vlan_id = vlanId;
+        filter.filter_by_ifindex = filterByIfindex;
+        filter.ifindex = ifindex;
+        filter.filter_by_state = filterByState;
+        filter.state = state;
+        filter.filter_by_mac_prefix = filterByMacPrefix;
+        filter.mac_prefix_len = macPrefixLen > ETH_ALEN ? ETH_ALEN : macPrefixLen;
+        if (filter.mac_prefix_len > 0) {
+            std::memcpy(filter.mac_prefix, macPrefix.data(), filter.mac_prefix_len);
+        }
+        return filter;
+    }
+};
+
+/*
+ * Page state for getTerminalRecordsPage. Start from a default value with
+ * limit set and pass the same object back for the next page; hasCursor and
+ * cursor form the page token and are advanced by each call.
+ */
+struct TerminalQueryPage {
+    std::size_t limit = 0;   /* records per page, 0 = no limit */
+    bool more = false;       /* out: another page follows */
+    std::size_t total = 0;   /* out: matches across all pages */
+    bool hasCursor = false;
+    terminal_key cursor{};
+};
+
+/*
+ * Fill the arena with the next page of terminals matching filter, ordered by
+ * (mac, ip). VLAN and ifindex filters are answered from server-side indexes.
+ */
+int getTerminalRecordsPage(const TerminalQueryFilter &filter,
+                           TerminalQueryPage &page,
+                           TerminalRecordArena &arena);
+/*
+ * Point lookups answered from the manager's MAC and IPv4 indexes: every
+ * terminal with this MAC (ETH_ALEN bytes, any IP) or this IPv4 address
+ * (network byte order, any MAC). version() is left at 0.
+ */
+int lookupTerminalRecordsByMac(const std::uint8_t *mac, TerminalRecordArena &arena);
+int lookupTerminalRecordsByIp(std::uint32_t ipv4, TerminalRecordArena &arena);
+/* Binary counterpart of setIncrementReport; both may be registered at once. */
+extern "C" int setIncrementRecordReport(IncRecordReportCb cb);
+
 struct terminal_manager;
 extern "C" int terminal_northbound_attach_default_sink(struct terminal_manager *manager);
 
@@ -0,0 +1,94 @@
+#ifndef TERMINAL_EVENT_RING_H
+#define TERMINAL_EVENT_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "terminal_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TERMINAL_EVENT_RING_CACHELINE 64
+
+struct terminal_event_cell {
+    size_t seq;
+    terminal_event_record_t record;
+};
+
+/* Bounded lock-free ring of event records using per-cell sequence numbers:
+ * producers claim a cell by advancing tail with compare-and-swap, consumers
+ * by advancing head the same way. Any number of threads may push and pop
+ * concurrently; the manager has one dispatcher popping plus producers that
+ * pop to discard the oldest record on overflow. Positions are size_t so the
+ * ring only needs word-sized atomics on 32-bit targets; wrap-around is safe
+ * because cells are compared by signed difference. */
+struct terminal_event_ring {
+    struct terminal_event_cell *cells;
+    size_t mask;
+    unsigned char pad0[TERMINAL_EVENT_RING_CACHELINE];
+    size_t head;
+    unsigned char pad1[TERMINAL_EVENT_RING_CACHELINE];
+    size_t tail;
+    unsigned char pad2[TERMINAL_EVENT_RING_CACHELINE];
+    size_t high_water;
+};
+
+/* capacity is rounded up to a power of two; returns -EINVAL or -ENOMEM. */
+int terminal_event_ring_init(struct terminal_event_ring *ring, size_t capacity);
+
+void terminal_event_ring_destroy(struct terminal_event_ring *ring);
+
+size_t terminal_event_ring_capacity(const struct terminal_event_ring *ring);
+
+/* Returns false without blocking when the ring is full. */
+bool terminal_event_ring_push(struct terminal_event_ring *ring,
+                              const terminal_event_record_t *record);
+
+/* Returns false without blocking when the ring is empty. */
+bool terminal_event_ring_pop(struct terminal_event_ring *ring,
+                             terminal_event_record_t *out);
+
+/* Racy occupancy estimate, exact when producers and consumers are idle. */
+size_t terminal_event_ring_depth(struct terminal_event_ring *ring);
+
+/* Deepest occupancy observed by a producer since init. */
+size_t terminal_event_ring_high_water(struct terminal_event_ring *ring);
+
+/* Per-key net-effect accumulator for event records. Records keep the order in
+ * which their key first appeared; later records for the same key fold into
+ * that slot (ADD then DEL cancels, MOD chains keep the first prev_ifindex and
+ * the last ifindex); a folded record carries the seq of its newest input.
+ * Not thread-safe. */
+struct terminal_event_coalescer {
+    terminal_event_record_t *records;
+    bool *live;
+    size_t count;
+    size_t capacity;
+    uint32_t *index;      /* open addressing, stores record position + 1 */
+    size_t index_capacity;
+};
+
+void terminal_event_coalescer_init(struct terminal_event_coalescer *coalescer);
+
+void terminal_event_coalescer_destroy(struct terminal_event_coalescer *coalescer);
+
+/* Folds record into the accumulator; returns 0 or -ENOMEM. Sets *merged when
+ * the record was absorbed by an existing entry for the same key. */
+int terminal_event_coalescer_add(struct terminal_event_coalescer *coalescer,
+                                 const terminal_event_record_t *record,
+                                 bool *merged);
+
+/* Squeezes cancelled records out of coalescer->records and returns how many
+ * remain; call terminal_event_coalescer_reset once they are consumed. */
+size_t terminal_event_coalescer_compact(struct terminal_event_coalescer *coalescer);
+
+void terminal_event_coalescer_reset(struct terminal_event_coalescer *coalescer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TERMINAL_EVENT_RING_H */
@@ -9,6 +9,7 @@
 #include <time.h>
 
 #include "adapter_api.h"
+#include "td_object_pool.h"
 
 #ifndef TD_MAX_IGNORED_VLANS
 #define TD_MAX_IGNORED_VLANS 32U
@@ -35,6 +36,16 @@ struct terminal_metadata {
     uint64_t mac_view_version; /* 0 when unresolved; snapshot version for last bridge lookup */
 };
 
+struct terminal_entry;
+struct iface_record;
+
+/* Chain node for the manager's MAC/IPv4 point-lookup indexes; pprev is
+ * NULL while the entry is not on the index. */
+struct terminal_index_link {
+    struct terminal_entry *next;
+    struct terminal_entry **pprev;
+};
+
 struct terminal_entry {
     struct terminal_key key;
     terminal_state_t state;
@@ -45,12 +56,32 @@ struct terminal_entry {
     char tx_iface[IFNAMSIZ];
     int tx_kernel_ifindex;
     struct in_addr tx_source_ip;
+    uint64_t tx_iface_generation;        /* iface_record generation tx_* were resolved against */
+    struct iface_record *tx_iface_record; /* record bound to, while on its binding list */
     int pending_vlan_id;
+    /* Intrusive membership, guarded by mgr->lock: the binding list of the
+     * iface record for tx_kernel_ifindex, and the pending_vlan_id bucket.
+     * A NULL pprev means the entry is not on that list. */
+    struct terminal_entry *binding_next;
+    struct terminal_entry **binding_pprev;
+    struct terminal_entry *pending_next;
+    struct terminal_entry **pending_pprev;
+    /* Secondary indexes for filtered queries, also guarded by mgr->lock: the
+     * meta.ifindex bucket (NULL pprev until the entry is in the table) and
+     * the meta.vlan_id list (only while the VLAN is in range). */
+    struct terminal_entry *ifindex_next;
+    struct terminal_entry **ifindex_pprev;
+    struct terminal_entry *vlan_next;
+    struct terminal_entry **vlan_pprev;
+    struct terminal_index_link mac_link; /* point index by key.mac */
+    struct terminal_index_link ip_link;  /* point index by key.ip */
     int vid_lookup_vlan;
     bool mac_refresh_enqueued;
     bool mac_verify_enqueued;
     bool vid_lookup_attempted;
-    struct terminal_entry *next;
+    uint64_t timer_deadline;             /* monotonic second the timer wheel fires at */
+    struct terminal_entry *timer_next;
+    struct terminal_entry **timer_pprev; /* NULL while not on a timer wheel */
 };
 
 typedef struct terminal_probe_request {
@@ -80,6 +111,7 @@ typedef struct terminal_event_record {
     uint32_t ifindex; /* 0 when unknown; logical port identifier */
     uint32_t prev_ifindex; /* 0 when unavailable; previous logical port for MOD events */
     terminal_event_tag_t tag;
+    uint64_t seq; /* manager-wide event sequence, starting at 1; 0 in snapshot records */
 } terminal_event_record_t;
 
 typedef void (*terminal_event_callback_fn)(const terminal_event_record_t *records,
@@ -88,6 +120,37 @@ typedef void (*terminal_event_callback_fn)(const terminal_event_record_t *record
 
 typedef bool (*terminal_query_callback_fn)(const terminal_event_record_t *record, void *user_ctx);
 
+/* Server-side filter for query_filtered; unset criteria match everything. */
+typedef struct terminal_query_filter {
+    bool filter_by_vlan;
+    int vlan_id;
+    bool filter_by_ifindex;
+    uint32_t ifindex;
+    bool filter_by_state;
+    terminal_state_t state;
+    bool filter_by_mac_prefix;
+    uint8_t mac_prefix[ETH_ALEN];
+    size_t mac_prefix_len;
+} terminal_query_filter_t;
+
+/* Keyset paging: results are ordered by (mac, ip) and a page starts after
+ * cursor, so pages stay consistent while terminals come and go. */
+typedef struct terminal_query_page {
+    size_t limit;               /* in: records per page, 0 = no limit */
+    bool has_cursor;            /* in: false for the first page */
+    struct terminal_key cursor; /* in/out: last key delivered */
+    bool more;                  /* out: further matches follow cursor */
+    size_t total;               /* out: matches in the whole result, ignoring the cursor */
+    uint64_t version;           /* out: the page reflects every event up to this seq */
+} terminal_query_page_t;
+
+/* What a producer does when the event ring is full. */
+typedef enum {
+    TERMINAL_EVENT_OVERFLOW_COALESCE = 0, /* spill into a per-key net-effect table */
+    TERMINAL_EVENT_OVERFLOW_DROP_OLDEST,  /* discard the oldest queued record */
+    TERMINAL_EVENT_OVERFLOW_BACKPRESSURE, /* wait briefly for the dispatcher, then drop */
+} terminal_event_overflow_policy_t;
+
 struct terminal_manager_stats {
     uint64_t terminals_discovered;
     uint64_t terminals_removed;
@@ -97,7 +160,18 @@ struct terminal_manager_stats {
     uint64_t address_update_events;
     uint64_t events_dispatched;
     uint64_t event_dispatch_failures;
+    uint64_t events_coalesced;        /* records folded away by the dispatch window */
     uint64_t current_terminals;
+    uint64_t event_ring_capacity;
+    uint64_t event_ring_depth;
+    uint64_t event_ring_high_water;   /* deepest ring occupancy seen */
+    uint64_t event_ring_drops;        /* records discarded on overflow */
+    uint64_t event_ring_coalesced;    /* overflow records folded into a pending one */
+    uint64_t event_ring_backpressure_waits;
+    /* node pool occupancy, sampled by terminal_manager_get_stats */
+    struct td_object_pool_stats entry_pool;
+    struct td_object_pool_stats lookup_task_pool;
+    struct td_object_pool_stats probe_task_pool;
 };
 
 typedef void (*td_debug_writer_t)(void *ctx, const char *line);
@@ -161,6 +235,14 @@ typedef struct terminal_address_update {
 
 typedef int (*terminal_address_sync_fn)(void *ctx);
 
+/* RTM_NEWLINK/RTM_DELLINK as seen by the netlink listener. */
+typedef struct terminal_link_update {
+    int kernel_ifindex;
+    char ifname[IFNAMSIZ];
+    bool is_add;        /* true = new/changed link, false = removed */
+    bool from_dump;     /* reply to the RTM_GETLINK resync, not a live event */
+} terminal_link_update_t;
+
 struct terminal_manager_config {
     unsigned int keepalive_interval_sec;
     unsigned int keepalive_miss_threshold;
@@ -170,6 +252,10 @@ struct terminal_manager_config {
     size_t max_terminals;
     uint16_t ignored_vlans[TD_MAX_IGNORED_VLANS];
     size_t ignored_vlan_count;
+    size_t event_ring_size;        /* records; 0 selects the default, rounded up to a power of two */
+    terminal_event_overflow_policy_t event_overflow_policy;
+    unsigned int event_window_ms;  /* 0 dispatches at once; else per-key churn is coalesced over the window */
+    size_t event_journal_size;     /* newest events kept for query_since; 0 selects the default */
 };
 
 struct terminal_manager *terminal_manager_create(const struct terminal_manager_config *cfg,
@@ -183,6 +269,12 @@ void terminal_manager_destroy(struct terminal_manager *mgr);
 void terminal_manager_on_packet(struct terminal_manager *mgr,
                                 const struct td_adapter_packet_view *packet);
 
+/* Same as on_packet for every view, but takes the manager lock once and
+ * runs a single merged MAC lookup/dispatch pass for the whole batch. */
+void terminal_manager_on_packet_batch(struct terminal_manager *mgr,
+                                      const struct td_adapter_packet_view *packets,
+                                      size_t count);
+
 void terminal_manager_on_timer(struct terminal_manager *mgr);
 
 void terminal_manager_on_address_update(struct terminal_manager *mgr,
@@ -194,6 +286,17 @@ void terminal_manager_set_address_sync_handler(struct terminal_manager *mgr,
 
 void terminal_manager_request_address_sync(struct terminal_manager *mgr);
 
+/* VLAN interface cache used by the per-packet binding path. Link updates keep
+ * it current; reset discards it (lookups fall back to if_nametoindex) and
+ * mark_ready declares it complete after a full link dump. Dump replies for an
+ * ifindex deleted by a live event since the reset are ignored; mark_ready
+ * returns -EAGAIN and leaves the cache unready if too many such deletions
+ * were seen to track. */
+void terminal_manager_on_link_update(struct terminal_manager *mgr,
+                                     const terminal_link_update_t *update);
+void terminal_manager_reset_link_cache(struct terminal_manager *mgr);
+int terminal_manager_mark_link_cache_ready(struct terminal_manager *mgr);
+
 int terminal_manager_set_event_sink(struct terminal_manager *mgr,
                                     terminal_event_callback_fn callback,
                                     void *callback_ctx);
@@ -202,6 +305,58 @@ int terminal_manager_query_all(struct terminal_manager *mgr,
                                terminal_query_callback_fn callback,
                                void *callback_ctx);
 
+/* Full query served from an immutable, versioned snapshot of the table. While
+ * nothing has changed since the last query no manager or shard lock is taken;
+ * otherwise the snapshot is rebuilt once and shared by later callers. The
+ * version (optional) is the seq of the last event the snapshot reflects, so
+ * equal versions mean identical results. Callbacks may re-enter the manager. */
+int terminal_manager_query_snapshot(struct terminal_manager *mgr,
+                                    terminal_query_callback_fn callback,
+                                    void *callback_ctx,
+                                    uint64_t *version);
+
+/* Filtered, paged query. Filters on VLAN or ifindex walk a secondary index
+ * under every lock; other queries scan the table one shard lock at a time.
+ * Only page->limit records are kept while scanning. filter and page may be
+ * NULL (match all, one page).
+ * Records are delivered after the locks drop, tagged ADD with seq 0; on
+ * return page->cursor names the last record handed to the callback. */
+int terminal_manager_query_filtered(struct terminal_manager *mgr,
+                                    const terminal_query_filter_t *filter,
+                                    terminal_query_page_t *page,
+                                    terminal_query_callback_fn callback,
+                                    void *callback_ctx);
+
+/* Point lookups over the MAC and IPv4 secondary indexes: every terminal
+ * whose key has this MAC (any IP) or this IPv4 address (any MAC), in no
+ * particular order. Only the manager lock is taken and the cost is
+ * proportional to the number of matches. Records are delivered after the
+ * lock drops, tagged ADD with seq 0. */
+int terminal_manager_lookup_by_mac(struct terminal_manager *mgr,
+                                   const uint8_t mac[ETH_ALEN],
+                                   terminal_query_callback_fn callback,
+                                   void *callback_ctx);
+
+int terminal_manager_lookup_by_ip(struct terminal_manager *mgr,
+                                  struct in_addr ip,
+                                  terminal_query_callback_fn callback,
+                                  void *callback_ctx);
+
+/* Replays journaled events with seq > since_seq in order. A snapshot version
+ * is a valid cursor, so a full query followed by query_since(version) misses
+ * nothing. Returns -ESTALE when the journal no longer reaches back to
+ * since_seq (or since_seq is ahead of the manager); the caller must resync
+ * with a full query. *latest_seq (optional) receives the newest sequence
+ * number, which is the cursor for the next call. */
+int terminal_manager_query_since(struct terminal_manager *mgr,
+                                 uint64_t since_seq,
+                                 terminal_query_callback_fn callback,
+                                 void *callback_ctx,
+                                 uint64_t *latest_seq);
+
+/* Events are delivered on a dedicated dispatcher thread. flush_events blocks
+ * until every event queued before the call has been handed to the sink; it is
+ * a no-op when called from inside the sink itself. */
 void terminal_manager_flush_events(struct terminal_manager *mgr);
 
 struct terminal_manager *terminal_manager_get_active(void);
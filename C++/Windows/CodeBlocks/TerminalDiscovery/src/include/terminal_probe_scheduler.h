@@ -0,0 +1,68 @@
+#ifndef TERMINAL_PROBE_SCHEDULER_H
+#define TERMINAL_PROBE_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "terminal_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TERMINAL_PROBE_QUEUE_DEFAULT_SIZE 4096U
+#define TERMINAL_PROBE_SEND_BATCH_MAX 32U
+
+struct terminal_probe_scheduler;
+
+/* Token bucket: one token every interval_ms, at most burst banked. */
+struct terminal_probe_scheduler_config {
+    unsigned int interval_ms; /* 0 disables pacing */
+    unsigned int burst;       /* 0 selects 1 */
+    unsigned int queue_size;  /* 0 selects TERMINAL_PROBE_QUEUE_DEFAULT_SIZE */
+};
+
+struct terminal_probe_scheduler_stats {
+    uint64_t enqueued;
+    uint64_t sent;
+    uint64_t send_batches;      /* send_fn calls; sent / send_batches is the mean batch */
+    uint64_t dropped;           /* rejected because the queue was full */
+    uint64_t pacing_waits;      /* sleeps spent waiting for a token */
+    uint64_t pacing_wait_ms;    /* total time spent in those sleeps */
+    uint64_t queue_delay_ms;    /* total submit-to-send delay of sent probes */
+    uint64_t max_queue_delay_ms;
+    size_t queue_depth;
+    size_t queue_high_water;
+    size_t queue_capacity;
+};
+
+/* Runs on the scheduler thread with every queued probe that currently has a
+ * token, at most TERMINAL_PROBE_SEND_BATCH_MAX at a time. */
+typedef void (*terminal_probe_send_fn)(const terminal_probe_request_t *requests, size_t count, void *ctx);
+
+/* Starts the scheduler thread; returns 0, -EINVAL, -ENOMEM or -errno. */
+int terminal_probe_scheduler_create(const struct terminal_probe_scheduler_config *cfg,
+                                    terminal_probe_send_fn send_fn,
+                                    void *send_ctx,
+                                    struct terminal_probe_scheduler **out);
+
+/* Copies request into the queue and returns without waiting for a token.
+ * Returns -EAGAIN when the queue is full and -ESHUTDOWN once stopped. */
+int terminal_probe_scheduler_submit(struct terminal_probe_scheduler *scheduler,
+                                    const terminal_probe_request_t *request);
+
+/* Joins the scheduler thread and discards queued probes; later submits fail.
+ * Must not be called from send_fn. */
+void terminal_probe_scheduler_stop(struct terminal_probe_scheduler *scheduler);
+
+/* Stops the scheduler if needed and frees it. */
+void terminal_probe_scheduler_destroy(struct terminal_probe_scheduler *scheduler);
+
+void terminal_probe_scheduler_get_stats(struct terminal_probe_scheduler *scheduler,
+                                        struct terminal_probe_scheduler_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TERMINAL_PROBE_SCHEDULER_H */
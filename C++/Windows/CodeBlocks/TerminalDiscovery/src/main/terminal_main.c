@@ -19,6 +19,7 @@
 #include "terminal_discovery_embed.h"
 #include "terminal_manager.h"
 #include "terminal_netlink.h"
+#include "terminal_probe_scheduler.h"
 
 int terminal_northbound_attach_default_sink(struct terminal_manager *manager);
 
@@ -42,6 +43,7 @@ struct app_context {
     td_adapter_t *adapter;
     const struct td_adapter_ops *ops;
     struct terminal_netlink_listener *netlink_listener;
+    struct terminal_probe_scheduler *probe_scheduler;
     bool adapter_started;
     bool packet_rx_registered;
 };
@@ -93,6 +95,64 @@ static void print_prompt(void) {
     fflush(stdout);
 }
 
+static void log_adapter_rx_stats(const struct app_context *ctx) {
+    if (!ctx->ops || !ctx->ops->get_rx_stats || !ctx->adapter) {
+        return;
+    }
+
+    struct td_adapter_rx_stats rx_stats;
+    memset(&rx_stats, 0, sizeof(rx_stats));
+    if (ctx->ops->get_rx_stats(ctx->adapter, &rx_stats) != TD_ADAPTER_OK) {
+        return;
+    }
+
+    uint64_t avg_x10 = rx_stats.wakeups > 0 ? (rx_stats.frames * 10U) / rx_stats.wakeups : 0U;
+    td_log_writef(TD_LOG_INFO,
+                  "adapter_stats",
+                  "rx_wakeups=%" PRIu64 " rx_frames=%" PRIu64 " frames_per_wakeup=%" PRIu64 ".%" PRIu64
+                  " max_frames_per_wakeup=%" PRIu32,
+                  rx_stats.wakeups,
+                  rx_stats.frames,
+                  avg_x10 / 10U,
+                  avg_x10 % 10U,
+                  rx_stats.max_frames_per_wakeup);
+}
+
+static void log_probe_tx_stats(const struct app_context *ctx) {
+    if (!ctx->probe_scheduler) {
+        return;
+    }
+
+    struct terminal_probe_scheduler_stats tx_stats;
+    terminal_probe_scheduler_get_stats(ctx->probe_scheduler, &tx_stats);
+    td_log_writef(TD_LOG_INFO,
+                  "probe_tx_stats",
+                  "enqueued=%" PRIu64 " sent=%" PRIu64 " send_batches=%" PRIu64 " dropped=%" PRIu64 " queue_depth=%zu"
+                  " queue_high_water=%zu queue_capacity=%zu pacing_waits=%" PRIu64 " pacing_wait_ms=%" PRIu64
+                  " queue_delay_ms=%" PRIu64 " max_queue_delay_ms=%" PRIu64,
+                  tx_stats.enqueued,
+                  tx_stats.sent,
+                  tx_stats.send_batches,
+                  tx_stats.dropped,
+                  tx_stats.queue_depth,
+                  tx_stats.queue_high_water,
+                  tx_stats.queue_capacity,
+                  tx_stats.pacing_waits,
+                  tx_stats.pacing_wait_ms,
+                  tx_stats.queue_delay_ms,
+                  tx_stats.max_queue_delay_ms);
+}
+
+static void log_runtime_stats(const struct app_context *ctx) {
+    if (!ctx) {
+        return;
+    }
+
+    terminal_manager_log_stats(ctx->manager);
+    log_adapter_rx_stats(ctx);
+    log_probe_tx_stats(ctx);
+}
+
 static bool runtime_config_has_ignored_vlan(const struct td_runtime_config *cfg, unsigned int vlan_id) {
     if (!cfg) {
         return false;
@@ -170,7 +230,7 @@ static void handle_command(const char *command,
     }
 
     if (strcmp(command, "stats") == 0) {
-        terminal_manager_log_stats(ctx->manager);
+        log_runtime_stats(ctx);
         return;
     }
 
@@ -602,28 +662,41 @@ static void adapter_packet_callback(const struct td_adapter_packet_view *packet,
     terminal_manager_on_packet(ctx->manager, packet);
 }
 
-static void terminal_probe_handler(const terminal_probe_request_t *request, void *user_ctx) {
+static void adapter_packet_batch_callback(const struct td_adapter_packet_view *packets,
+                                          size_t count,
+                                          void *user_ctx) {
     struct app_context *ctx = (struct app_context *)user_ctx;
-    if (!ctx || !ctx->ops || !ctx->adapter || !request) {
+    if (!ctx || !ctx->manager || !packets) {
         return;
     }
+    terminal_manager_on_packet_batch(ctx->manager, packets, count);
+}
 
-    struct td_adapter_arp_request arp_req;
-    memset(&arp_req, 0, sizeof(arp_req));
+static bool terminal_probe_build_request(const terminal_probe_request_t *request,
+                                         struct td_adapter_arp_request *arp_req) {
+    memset(arp_req, 0, sizeof(*arp_req));
 
-    arp_req.target_ip = request->key.ip;
-    memcpy(arp_req.target_mac, request->key.mac, ETH_ALEN);
-    arp_req.sender_ip = request->source_ip;
-    arp_req.vlan_id = request->vlan_id;
+    arp_req->target_ip = request->key.ip;
+    memcpy(arp_req->target_mac, request->key.mac, ETH_ALEN);
+    arp_req->sender_ip = request->source_ip;
+    arp_req->vlan_id = request->vlan_id;
     bool fallback_possible = (request->tx_kernel_ifindex > 0 && request->tx_iface[0] != '\0');
-    arp_req.tx_kernel_ifindex = fallback_possible ? request->tx_kernel_ifindex : -1;
+    arp_req->tx_kernel_ifindex = fallback_possible ? request->tx_kernel_ifindex : -1;
     if (fallback_possible) {
-        snprintf(arp_req.tx_iface, sizeof(arp_req.tx_iface), "%s", request->tx_iface);
+        snprintf(arp_req->tx_iface, sizeof(arp_req->tx_iface), "%s", request->tx_iface);
     }
+    return fallback_possible;
+}
 
-    td_adapter_result_t rc = ctx->ops->send_arp(ctx->adapter, &arp_req);
+/* Retries a failed physical-port probe on the VLAN interface when the request
+ * names one, and reports probes that still could not be sent. */
+static void terminal_probe_finish(struct app_context *ctx,
+                                  const terminal_probe_request_t *request,
+                                  const struct td_adapter_arp_request *arp_req,
+                                  bool fallback_possible,
+                                  td_adapter_result_t rc) {
     if (rc != TD_ADAPTER_OK && fallback_possible) {
-        struct td_adapter_arp_request fallback_req = arp_req;
+        struct td_adapter_arp_request fallback_req = *arp_req;
         fallback_req.tx_iface_valid = true;
         rc = ctx->ops->send_arp(ctx->adapter, &fallback_req);
         if (rc == TD_ADAPTER_OK) {
@@ -652,11 +725,54 @@ static void terminal_probe_handler(const terminal_probe_request_t *request, void
     }
 }
 
+/* Runs on the probe scheduler thread with every probe that has a pacing
+ * token; adapters with send_arp_batch get them in one call. */
+static void terminal_probe_transmit(const terminal_probe_request_t *requests, size_t count, void *user_ctx) {
+    struct app_context *ctx = (struct app_context *)user_ctx;
+    if (!ctx || !ctx->ops || !ctx->adapter || !requests || count == 0) {
+        return;
+    }
+    if (count > TERMINAL_PROBE_SEND_BATCH_MAX) {
+        count = TERMINAL_PROBE_SEND_BATCH_MAX;
+    }
+
+    struct td_adapter_arp_request arp_reqs[TERMINAL_PROBE_SEND_BATCH_MAX];
+    td_adapter_result_t results[TERMINAL_PROBE_SEND_BATCH_MAX];
+    bool fallback_possible[TERMINAL_PROBE_SEND_BATCH_MAX];
+    for (size_t i = 0; i < count; ++i) {
+        fallback_possible[i] = terminal_probe_build_request(&requests[i], &arp_reqs[i]);
+    }
+
+    bool batched = ctx->ops->send_arp_batch &&
+                   ctx->ops->send_arp_batch(ctx->adapter, arp_reqs, results, count) == TD_ADAPTER_OK;
+    for (size_t i = 0; i < count; ++i) {
+        if (!batched) {
+            results[i] = ctx->ops->send_arp(ctx->adapter, &arp_reqs[i]);
+        }
+        terminal_probe_finish(ctx, &requests[i], &arp_reqs[i], fallback_possible[i], results[i]);
+    }
+}
+
+/* Called by the manager's worker; only queues the probe so scans never wait
+ * on the transmit pacing. Overflow is counted and logged by the scheduler. */
+static void terminal_probe_handler(const terminal_probe_request_t *request, void *user_ctx) {
+    struct app_context *ctx = (struct app_context *)user_ctx;
+    if (!ctx || !ctx->probe_scheduler || !request) {
+        return;
+    }
+
+    (void)terminal_probe_scheduler_submit(ctx->probe_scheduler, request);
+}
+
 static void terminal_discovery_cleanup(struct app_context *ctx) {
     if (!ctx) {
         return;
     }
 
+    if (ctx->probe_scheduler) {
+        terminal_probe_scheduler_stop(ctx->probe_scheduler);
+    }
+
     if (ctx->ops && ctx->adapter && ctx->adapter_started) {
         ctx->ops->stop(ctx->adapter);
         ctx->adapter_started = false;
@@ -674,6 +790,11 @@ static void terminal_discovery_cleanup(struct app_context *ctx) {
         ctx->manager = NULL;
     }
 
+    if (ctx->probe_scheduler) {
+        terminal_probe_scheduler_destroy(ctx->probe_scheduler);
+        ctx->probe_scheduler = NULL;
+    }
+
     if (ctx->ops && ctx->adapter) {
         ctx->ops->shutdown(ctx->adapter);
         ctx->adapter = NULL;
@@ -701,7 +822,11 @@ static int terminal_discovery_bootstrap(const struct td_runtime_config *runtime_
         .rx_iface = runtime_cfg->rx_iface,
         .tx_iface = runtime_cfg->tx_iface,
         .tx_interval_ms = runtime_cfg->tx_interval_ms,
-        .rx_ring_size = 0,
+        .rx_ring_size = runtime_cfg->rx_ring_size,
+        .rx_mode = runtime_cfg->rx_mode,
+        .rx_batch_size = runtime_cfg->rx_batch_size,
+        .rx_fanout = runtime_cfg->rx_fanout,
+        .rx_cpu_list = runtime_cfg->rx_cpu_list[0] ? runtime_cfg->rx_cpu_list : NULL,
     };
 
     struct td_adapter_env adapter_env = {
@@ -726,6 +851,21 @@ static int terminal_discovery_bootstrap(const struct td_runtime_config *runtime_
         return -1;
     }
 
+    struct terminal_probe_scheduler_config scheduler_cfg = {
+        .interval_ms = runtime_cfg->tx_interval_ms,
+        .burst = runtime_cfg->tx_burst,
+        .queue_size = runtime_cfg->tx_queue_size,
+    };
+    int scheduler_rc = terminal_probe_scheduler_create(&scheduler_cfg,
+                                                       terminal_probe_transmit,
+                                                       ctx,
+                                                       &ctx->probe_scheduler);
+    if (scheduler_rc != 0) {
+        td_log_writef(TD_LOG_ERROR, "terminal_daemon", "failed to start probe scheduler: %d", scheduler_rc);
+        terminal_discovery_cleanup(ctx);
+        return scheduler_rc;
+    }
+
     struct terminal_manager *manager = terminal_manager_create(&manager_cfg,
                                                                adapter_handle,
                                                                adapter_desc->ops,
@@ -752,12 +892,19 @@ static int terminal_discovery_bootstrap(const struct td_runtime_config *runtime_
         return -1;
     }
 
-    struct td_adapter_packet_subscription packet_sub = {
-        .callback = adapter_packet_callback,
-        .user_ctx = ctx,
-    };
-
-    adapter_rc = adapter_desc->ops->register_packet_rx(adapter_handle, &packet_sub);
+    if (adapter_desc->ops->register_packet_rx_batch) {
+        struct td_adapter_packet_batch_subscription batch_sub = {
+            .callback = adapter_packet_batch_callback,
+            .user_ctx = ctx,
+        };
+        adapter_rc = adapter_desc->ops->register_packet_rx_batch(adapter_handle, &batch_sub);
+    } else {
+        struct td_adapter_packet_subscription packet_sub = {
+            .callback = adapter_packet_callback,
+            .user_ctx = ctx,
+        };
+        adapter_rc = adapter_desc->ops->register_packet_rx(adapter_handle, &packet_sub);
+    }
     if (adapter_rc != TD_ADAPTER_OK) {
         td_log_writef(TD_LOG_ERROR, "terminal_daemon", "register_packet_rx failed: %d", adapter_rc);
         terminal_discovery_cleanup(ctx);
@@ -786,12 +933,23 @@ static void print_usage(FILE *stream) {
             "  --rx-iface NAME           Interface to capture ARP (default: eth0)\n"
             "  --tx-iface NAME           Interface to transmit ARP (default: eth0)\n"
             "  --tx-interval MS          Minimum milliseconds between probes (default: 100)\n"
+            "  --tx-burst COUNT          Probes that may be sent back to back after idle (default: 1)\n"
+            "  --tx-queue COUNT          Queued probes awaiting transmit before drops (default: 4096)\n"
+            "  --rx-mode MODE            Receive path recvmsg|mmap|recvmmsg (default: recvmsg)\n"
+            "  --rx-ring-size BYTES      RX ring bytes in mmap mode, else SO_RCVBUF (default: 0)\n"
+            "  --rx-batch COUNT          Frames per recvmmsg() in recvmmsg mode (default: 32)\n"
+            "  --rx-fanout COUNT         RX sockets/threads in a PACKET_FANOUT group (default: 1)\n"
+            "  --rx-cpus LIST            Pin RX threads to CPUs, e.g. 0,2-3 (default: unpinned)\n"
             "  --keepalive-interval SEC  Keepalive interval seconds (default: 120)\n"
             "  --keepalive-miss COUNT    Probe failure threshold (default: 3)\n"
             "  --iface-holdoff SEC       Holdoff after iface invalid (default: 1800)\n"
             "  --max-terminals COUNT     Maximum tracked terminals (default: 1000)\n"
             "  --ignore-vlan VID         Ignore ARP seen on VLAN VID (repeatable)\n"
             "  --stats-interval SEC      Stats log interval seconds, 0 disables (default: 0)\n"
+            "  --event-ring-size COUNT   Event ring records, rounded to a power of two (default: 1024)\n"
+            "  --event-overflow POLICY   Full event ring coalesce|drop-oldest|backpressure (default: coalesce)\n"
+            "  --event-window MS         Coalesce per-terminal event churn over MS, 0 disables (default: 0)\n"
+            "  --event-journal COUNT     Recent events kept for incremental resync (default: 4096)\n"
             "  --log-level LEVEL         Log level trace|debug|info|warn|error|none (default: info)\n"
             "  --help                    Show this help message\n",
             g_program_name);
@@ -843,12 +1001,23 @@ int main(int argc, char **argv) {
         {"rx-iface", required_argument, NULL, 'r'},
         {"tx-iface", required_argument, NULL, 't'},
         {"tx-interval", required_argument, NULL, 'T'},
+        {"tx-burst", required_argument, NULL, 'U'},
+        {"tx-queue", required_argument, NULL, 'Q'},
+        {"rx-mode", required_argument, NULL, 'R'},
+        {"rx-ring-size", required_argument, NULL, 'B'},
+        {"rx-batch", required_argument, NULL, 'b'},
+        {"rx-fanout", required_argument, NULL, 'F'},
+        {"rx-cpus", required_argument, NULL, 'C'},
         {"keepalive-interval", required_argument, NULL, 'k'},
         {"keepalive-miss", required_argument, NULL, 'm'},
         {"iface-holdoff", required_argument, NULL, 'H'},
         {"max-terminals", required_argument, NULL, 'M'},
         {"ignore-vlan", required_argument, NULL, 'I'},
         {"stats-interval", required_argument, NULL, 'S'},
+        {"event-ring-size", required_argument, NULL, 'E'},
+        {"event-overflow", required_argument, NULL, 'O'},
+        {"event-window", required_argument, NULL, 'W'},
+        {"event-journal", required_argument, NULL, 'J'},
         {"log-level", required_argument, NULL, 'l'},
         {"help", no_argument, NULL, 'h'},
         {NULL, 0, NULL, 0},
@@ -871,6 +1040,50 @@ int main(int argc, char **argv) {
                 return EXIT_FAILURE;
             }
             break;
+        case 'U':
+            if (parse_unsigned_option("--tx-burst", optarg, &runtime_cfg.tx_burst) != 0) {
+                return EXIT_FAILURE;
+            }
+            if (runtime_cfg.tx_burst == 0) {
+                fprintf(stderr, "%s: tx-burst must be at least 1\n", g_program_name);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'Q':
+            if (parse_unsigned_option("--tx-queue", optarg, &runtime_cfg.tx_queue_size) != 0) {
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'R':
+            if (strcmp(optarg, "recvmsg") == 0) {
+                runtime_cfg.rx_mode = TD_ADAPTER_RX_MODE_RECVMSG;
+            } else if (strcmp(optarg, "mmap") == 0) {
+                runtime_cfg.rx_mode = TD_ADAPTER_RX_MODE_MMAP;
+            } else if (strcmp(optarg, "recvmmsg") == 0) {
+                runtime_cfg.rx_mode = TD_ADAPTER_RX_MODE_RECVMMSG;
+            } else {
+                fprintf(stderr, "%s: invalid rx mode '%s'\n", g_program_name, optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'B':
+            if (parse_unsigned_option("--rx-ring-size", optarg, &runtime_cfg.rx_ring_size) != 0) {
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'b':
+            if (parse_unsigned_option("--rx-batch", optarg, &runtime_cfg.rx_batch_size) != 0) {
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'F':
+            if (parse_unsigned_option("--rx-fanout", optarg, &runtime_cfg.rx_fanout) != 0) {
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'C':
+            snprintf(runtime_cfg.rx_cpu_list, sizeof(runtime_cfg.rx_cpu_list), "%s", optarg);
+            break;
         case 'k':
             if (parse_unsigned_option("--keepalive-interval", optarg, &runtime_cfg.keepalive_interval_sec) != 0) {
                 return EXIT_FAILURE;
@@ -904,6 +1117,33 @@ int main(int argc, char **argv) {
                 return EXIT_FAILURE;
             }
             break;
+        case 'E':
+            if (parse_unsigned_option("--event-ring-size", optarg, &runtime_cfg.event_ring_size) != 0) {
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'O':
+            if (strcmp(optarg, "coalesce") == 0) {
+                runtime_cfg.event_overflow_policy = TERMINAL_EVENT_OVERFLOW_COALESCE;
+            } else if (strcmp(optarg, "drop-oldest") == 0) {
+                runtime_cfg.event_overflow_policy = TERMINAL_EVENT_OVERFLOW_DROP_OLDEST;
+            } else if (strcmp(optarg, "backpressure") == 0) {
+                runtime_cfg.event_overflow_policy = TERMINAL_EVENT_OVERFLOW_BACKPRESSURE;
+            } else {
+                fprintf(stderr, "%s: invalid event overflow policy '%s'\n", g_program_name, optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'W':
+            if (parse_unsigned_option("--event-window", optarg, &runtime_cfg.event_window_ms) != 0) {
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'J':
+            if (parse_unsigned_option("--event-journal", optarg, &runtime_cfg.event_journal_size) != 0) {
+                return EXIT_FAILURE;
+            }
+            break;
         case 'I':
         {
             unsigned int parsed_vlan = 0;
@@ -1039,24 +1279,24 @@ int main(int argc, char **argv) {
 
         if (g_should_dump_stats) {
             g_should_dump_stats = 0;
-            terminal_manager_log_stats(ctx.manager);
+            log_runtime_stats(&ctx);
         }
 
         if (runtime_cfg.stats_log_interval_sec > 0) {
             if (++stats_elapsed_sec >= runtime_cfg.stats_log_interval_sec) {
                 stats_elapsed_sec = 0;
-                terminal_manager_log_stats(ctx.manager);
+                log_runtime_stats(&ctx);
             }
         }
     }
 
     if (g_should_dump_stats) {
         g_should_dump_stats = 0;
-        terminal_manager_log_stats(ctx.manager);
+        log_runtime_stats(&ctx);
     }
 
     td_log_writef(TD_LOG_INFO, "terminal_daemon", "signal %d received, shutting down", g_should_stop);
-    terminal_manager_log_stats(ctx.manager);
+    log_runtime_stats(&ctx);
 
     terminal_discovery_cleanup(&ctx);
 
@@ -24,6 +24,17 @@ static const SwUcMacEntry kStubEntries[] = {
 
 static uint32_t g_stub_capacity_hint = 1024U;
 
+#define TD_SWITCH_MAC_STUB_SCRIPT_MAX 256U
+
+/* Scripted-delta mode: TD_SWITCH_MAC_STUB_SCRIPT holds ';'-separated steps of
+ * ','-separated ROW=IFINDEX moves applied cumulatively to the sample rows, one
+ * step per snapshot; IFINDEX 0 ages the row out. The last state repeats once
+ * the script is exhausted and a changed script restarts from the samples. */
+static SwUcMacEntry g_script_rows[sizeof(kStubEntries) / sizeof(kStubEntries[0])];
+static char g_script_text[TD_SWITCH_MAC_STUB_SCRIPT_MAX];
+static size_t g_script_cursor;
+static unsigned g_script_step;
+
 static size_t stub_entry_count(void) {
     return sizeof(kStubEntries) / sizeof(kStubEntries[0]);
 }
@@ -157,6 +168,66 @@ static void format_mac(const mac_addr_t mac, char *buffer, size_t len) {
              mac[5]);
 }
 
+static void script_apply_step(void) {
+    const char *cursor = g_script_text + g_script_cursor;
+    if (*cursor == '\0') {
+        return;
+    }
+
+    size_t total = stub_entry_count();
+    while (*cursor && *cursor != ';') {
+        char *endptr = NULL;
+        unsigned long row = strtoul(cursor, &endptr, 10);
+        if (endptr == cursor || *endptr != '=') {
+            fprintf(stdout, "[switch-mac-stub] ignoring malformed script move at '%s'\n", cursor);
+            break;
+        }
+        cursor = endptr + 1;
+        unsigned long ifindex = strtoul(cursor, &endptr, 10);
+        if (endptr == cursor) {
+            fprintf(stdout, "[switch-mac-stub] ignoring malformed script move at '%s'\n", cursor);
+            break;
+        }
+        if (row < total) {
+            g_script_rows[row].ifindex = (uint32)ifindex;
+        }
+        cursor = endptr;
+        if (*cursor == ',') {
+            ++cursor;
+        }
+    }
+
+    while (*cursor && *cursor != ';') {
+        ++cursor;
+    }
+    if (*cursor == ';') {
+        ++cursor;
+    }
+    g_script_cursor = (size_t)(cursor - g_script_text);
+    g_script_step += 1U;
+}
+
+static uint32_t script_snapshot(const char *script, SwUcMacEntry *entries, uint32_t desired) {
+    if (strcmp(script, g_script_text) != 0) {
+        snprintf(g_script_text, sizeof(g_script_text), "%s", script);
+        memcpy(g_script_rows, kStubEntries, sizeof(g_script_rows));
+        g_script_cursor = 0U;
+        g_script_step = 0U;
+    }
+
+    script_apply_step();
+
+    uint32_t count = 0U;
+    for (uint32_t i = 0; i < desired; ++i) {
+        if (g_script_rows[i].ifindex != 0U) {
+            entries[count++] = g_script_rows[i];
+        }
+    }
+
+    fprintf(stdout, "[switch-mac-stub] script step %u returning %u rows\n", g_script_step, count);
+    return count;
+}
+
 TD_SWITCH_MAC_WEAK int td_switch_mac_get_capacity(uint32_t *out_capacity) {
     if (out_capacity == NULL) {
         fprintf(stdout, "[switch-mac-stub] td_switch_mac_get_capacity: out_capacity is NULL\n");
@@ -192,6 +263,15 @@ TD_SWITCH_MAC_WEAK int td_switch_mac_snapshot(SwUcMacEntry *entries, uint32_t *o
         desired = cap;
     }
 
+    const char *script = getenv("TD_SWITCH_MAC_STUB_SCRIPT");
+    if (script && *script) {
+        if (strlen(script) < sizeof(g_script_text)) {
+            *out_count = script_snapshot(script, entries, desired);
+            return 0;
+        }
+        fprintf(stdout, "[switch-mac-stub] TD_SWITCH_MAC_STUB_SCRIPT too long, ignoring\n");
+    }
+
     memcpy(entries, kStubEntries, desired * sizeof(SwUcMacEntry));
     *out_count = desired;
 
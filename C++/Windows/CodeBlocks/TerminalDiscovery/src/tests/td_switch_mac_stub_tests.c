@@ -35,6 +35,47 @@ static void test_snapshot_with_limit(void) {
     unsetenv("TD_SWITCH_MAC_STUB_COUNT");
 }
 
+static const SwUcMacEntry *find_row(const SwUcMacEntry *entries, uint32_t count, uint16_t vlan) {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (entries[i].vlan == vlan) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void test_snapshot_script(void) {
+    setenv("TD_SWITCH_MAC_STUB_SCRIPT", "1=13;1=0;0=9,1=12", 1);
+
+    SwUcMacEntry entries[8];
+    uint32_t count = 0;
+
+    /* step 1: row 1 (vlan 10) moves to port 13 */
+    assert(td_switch_mac_snapshot(entries, &count) == 0);
+    assert(count == 3);
+    assert(find_row(entries, count, 10)->ifindex == 13);
+
+    /* step 2: row 1 ages out */
+    assert(td_switch_mac_snapshot(entries, &count) == 0);
+    assert(count == 2);
+    assert(find_row(entries, count, 10) == NULL);
+
+    /* step 3: row 0 moves and row 1 is relearned */
+    assert(td_switch_mac_snapshot(entries, &count) == 0);
+    assert(count == 3);
+    assert(find_row(entries, count, 1)->ifindex == 9);
+    assert(find_row(entries, count, 10)->ifindex == 12);
+
+    /* exhausted: the last state repeats */
+    assert(td_switch_mac_snapshot(entries, &count) == 0);
+    assert(count == 3);
+    assert(find_row(entries, count, 1)->ifindex == 9);
+
+    unsetenv("TD_SWITCH_MAC_STUB_SCRIPT");
+    assert(td_switch_mac_snapshot(entries, &count) == 0);
+    assert(find_row(entries, count, 1)->ifindex == 7);
+}
+
 static void test_invalid_arguments(void) {
     int rc = td_switch_mac_get_capacity(NULL);
     assert(rc == -EINVAL);
@@ -49,5 +90,6 @@ int main(void) {
     test_get_capacity();
     test_snapshot_defaults();
     test_snapshot_with_limit();
+    test_snapshot_script();
     return 0;
 }
@@ -175,6 +175,14 @@ void terminal_manager_on_packet(struct terminal_manager *mgr,
     (void)packet;
 }
 
+void terminal_manager_on_packet_batch(struct terminal_manager *mgr,
+                                      const struct td_adapter_packet_view *packets,
+                                      size_t count) {
+    (void)mgr;
+    (void)packets;
+    (void)count;
+}
+
 void terminal_manager_set_address_sync_handler(struct terminal_manager *mgr,
                                                terminal_address_sync_fn handler,
                                                void *handler_ctx) {
@@ -140,6 +140,23 @@ static void inc_report_capture(const MAC_IP_INFO &info) {
     g_inc_capture.batches.push_back(info);
 }
 
+struct record_capture {
+    size_t calls = 0;
+    std::vector<TerminalRecord> records;
+
+    void reset() {
+        calls = 0;
+        records.clear();
+    }
+};
+
+static record_capture g_record_capture;
+
+static void inc_record_capture(TerminalRecordSpan span) {
+    g_record_capture.calls += 1;
+    g_record_capture.records.insert(g_record_capture.records.end(), span.begin(), span.end());
+}
+
 static std::string format_mac_string(const uint8_t mac[ETH_ALEN]) {
     char buf[18];
     std::snprintf(buf,
@@ -298,6 +315,7 @@ static bool test_increment_add_and_get_all(terminal_manager *mgr,
                                            int ifindex,
                                            int vlan_id) {
     g_inc_capture.reset();
+    g_record_capture.reset();
 
     apply_address_update(mgr, ifindex, "192.0.2.1", 24, true);
 
@@ -391,6 +409,160 @@ static bool test_increment_add_and_get_all(terminal_manager *mgr,
     return ok;
 }
 
+static bool test_record_api() {
+    const uint8_t mac[ETH_ALEN] = {0x00, 0x21, 0x22, 0x23, 0x24, 0x25};
+    bool ok = true;
+
+    if (setIncrementRecordReport(inc_record_capture) != -EALREADY) {
+        std::printf("[FAIL] duplicate record registration expected -EALREADY\n");
+        ok = false;
+    }
+
+    if (g_record_capture.calls != 1 || g_record_capture.records.size() != 1) {
+        std::printf("[FAIL] expected one record batch, calls=%zu records=%zu\n",
+                    g_record_capture.calls,
+                    g_record_capture.records.size());
+        ok = false;
+    } else {
+        const TerminalRecord &rec = g_record_capture.records.front();
+        if (rec.tag != ModifyTag::ADD || rec.ifindex != 7U ||
+            std::memcmp(rec.mac, mac, ETH_ALEN) != 0) {
+            std::printf("[FAIL] record batch does not match ADD ifindex=7\n");
+            ok = false;
+        }
+    }
+
+    size_t total = 0;
+    int rc = getAllTerminalRecords(nullptr, 0, &total);
+    if (rc != -ENOSPC || total != 1) {
+        std::printf("[FAIL] sizing query expected -ENOSPC/1, got %d/%zu\n", rc, total);
+        ok = false;
+    }
+
+    TerminalRecord buffer[4];
+    rc = getAllTerminalRecords(buffer, 4, &total);
+    if (rc != 0 || total != 1) {
+        std::printf("[FAIL] buffer query expected 0/1, got %d/%zu\n", rc, total);
+        return false;
+    }
+
+    char mac_buf[kTerminalMacStrLen];
+    char ip_buf[kTerminalIpStrLen];
+    if (!formatTerminalMac(buffer[0], mac_buf, sizeof(mac_buf)) ||
+        format_mac_string(mac) != mac_buf) {
+        std::printf("[FAIL] formatTerminalMac mismatch\n");
+        ok = false;
+    }
+    if (!formatTerminalIp(buffer[0], ip_buf, sizeof(ip_buf)) ||
+        std::strcmp(ip_buf, "192.0.2.42") != 0) {
+        std::printf("[FAIL] formatTerminalIp mismatch\n");
+        ok = false;
+    }
+    if (formatTerminalMac(buffer[0], mac_buf, sizeof(mac_buf) - 1)) {
+        std::printf("[FAIL] formatTerminalMac accepted a short buffer\n");
+        ok = false;
+    }
+
+    MAC_IP_INFO snapshot;
+    rc = getAllTerminalInfo(snapshot);
+    if (rc != 0 || snapshot.size() != 1) {
+        std::printf("[FAIL] getAllTerminalInfo alongside records returned %d\n", rc);
+        ok = false;
+    } else {
+        TerminalInfo info = toTerminalInfo(buffer[0]);
+        const TerminalInfo &expected = snapshot.front();
+        if (info.mac != expected.mac || info.ip != expected.ip ||
+            info.ifindex != expected.ifindex || info.tag != expected.tag) {
+            std::printf("[FAIL] toTerminalInfo differs from getAllTerminalInfo\n");
+            ok = false;
+        }
+    }
+
+    TerminalRecordArena arena;
+    rc = getAllTerminalRecordsInto(arena);
+    const TerminalRecord *first_data = arena.records().data;
+    size_t first_capacity = arena.capacity();
+    if (rc != 0 || arena.records().size != 1) {
+        std::printf("[FAIL] arena query expected 0/1, got %d/%zu\n", rc, arena.records().size);
+        ok = false;
+    }
+    uint64_t first_version = arena.version();
+    rc = getAllTerminalRecordsInto(arena);
+    if (rc != 0 || arena.records().size != 1 || arena.version() == 0 ||
+        arena.version() != first_version ||
+        arena.records().data != first_data || arena.capacity() != first_capacity) {
+        std::printf("[FAIL] arena refresh reallocated or changed size\n");
+        ok = false;
+    }
+
+    TerminalRecordArena delta;
+    rc = getTerminalRecordsSince(arena.version(), delta);
+    if (rc != 0 || !delta.records().empty() || delta.version() != arena.version()) {
+        std::printf("[FAIL] getTerminalRecordsSince at the head returned %d/%zu\n",
+                    rc,
+                    delta.records().size);
+        ok = false;
+    }
+    rc = getTerminalRecordsSince(arena.version() - 1U, delta);
+    if (rc != 0 || delta.records().size != 1 ||
+        delta.records().data[0].tag != ModifyTag::ADD || delta.records().data[0].ifindex != 7U) {
+        std::printf("[FAIL] getTerminalRecordsSince did not replay the ADD\n");
+        ok = false;
+    }
+
+    TerminalQueryFilter filter;
+    filter.filterByIfindex = true;
+    filter.ifindex = 7U;
+    TerminalQueryPage page;
+    page.limit = 1;
+    TerminalRecordArena paged;
+    rc = getTerminalRecordsPage(filter, page, paged);
+    if (rc != 0 || paged.records().size != 1 || page.total != 1 || page.more ||
+        !page.hasCursor || paged.version() != arena.version() ||
+        std::memcmp(paged.records().data[0].mac, buffer[0].mac, ETH_ALEN) != 0) {
+        std::printf("[FAIL] getTerminalRecordsPage on ifindex 7 returned %d/%zu\n",
+                    rc,
+                    paged.records().size);
+        ok = false;
+    }
+    rc = getTerminalRecordsPage(filter, page, paged);
+    if (rc != 0 || !paged.records().empty() || page.total != 1 || page.more) {
+        std::printf("[FAIL] getTerminalRecordsPage past the last page returned %zu\n",
+                    paged.records().size);
+        ok = false;
+    }
+    filter.ifindex = 8U;
+    page = TerminalQueryPage();
+    rc = getTerminalRecordsPage(filter, page, paged);
+    if (rc != 0 || !paged.records().empty() || page.total != 0) {
+        std::printf("[FAIL] getTerminalRecordsPage on an unused ifindex returned %zu\n",
+                    paged.records().size);
+        ok = false;
+    }
+
+    TerminalRecordArena point;
+    rc = lookupTerminalRecordsByMac(buffer[0].mac, point);
+    if (rc != 0 || point.records().size != 1 || point.records().data[0].ipv4 != buffer[0].ipv4) {
+        std::printf("[FAIL] lookupTerminalRecordsByMac returned %d/%zu\n", rc, point.records().size);
+        ok = false;
+    }
+    rc = lookupTerminalRecordsByIp(buffer[0].ipv4, point);
+    if (rc != 0 || point.records().size != 1 ||
+        std::memcmp(point.records().data[0].mac, buffer[0].mac, ETH_ALEN) != 0 ||
+        point.records().data[0].ifindex != 7U) {
+        std::printf("[FAIL] lookupTerminalRecordsByIp returned %d/%zu\n", rc, point.records().size);
+        ok = false;
+    }
+    rc = lookupTerminalRecordsByIp(buffer[0].ipv4 ^ htonl(0xffU), point);
+    if (rc != 0 || !point.records().empty()) {
+        std::printf("[FAIL] lookupTerminalRecordsByIp on an unknown address returned %zu\n",
+                    point.records().size);
+        ok = false;
+    }
+
+    return ok;
+}
+
 static bool test_netlink_removal(terminal_manager *mgr,
                                  int ifindex,
                                  const char *address) {
@@ -700,9 +872,17 @@ int main() {
         return 1;
     }
 
+    rc = setIncrementRecordReport(inc_record_capture);
+    if (rc != 0) {
+        std::printf("[FAIL] setIncrementRecordReport returned %d\n", rc);
+        terminal_manager_destroy(mgr);
+        return 1;
+    }
+
     bool all_ok = true;
     all_ok &= test_duplicate_registration();
     all_ok &= test_increment_add_and_get_all(mgr, tx_kernel_ifindex, vlan_id);
+    all_ok &= test_record_api();
     all_ok &= test_netlink_removal(mgr, tx_kernel_ifindex, "192.0.2.1");
     all_ok &= test_cross_vlan_migration(mgr);
     all_ok &= test_ipv4_recovery(mgr);
@@ -1,6 +1,8 @@
 #define _DEFAULT_SOURCE
 
 #include "terminal_manager.h"
+#include "terminal_event_ring.h"
+#include "terminal_probe_scheduler.h"
 #include "td_logging.h"
 
 #include <arpa/inet.h>
@@ -43,6 +45,7 @@ struct mock_mac_locator_state {
     uint32_t lookup_by_vid_ifindex;
     uint64_t version;
     size_t lookup_calls;
+    size_t lookup_batch_calls;
     size_t lookup_by_vid_calls;
     uint16_t last_lookup_vlan;
     uint16_t last_lookup_by_vid_vlan;
@@ -51,6 +54,8 @@ struct mock_mac_locator_state {
     bool subscribed;
     td_adapter_mac_locator_refresh_cb refresh_cb;
     void *refresh_ctx;
+    td_adapter_mac_locator_delta_cb delta_cb;
+    void *delta_ctx;
 };
 
 static struct mock_mac_locator_state g_mock_locator;
@@ -74,6 +79,7 @@ static void mock_locator_set_lookup_by_vid(td_adapter_result_t rc, uint32_t ifin
 
 static void mock_locator_clear_counters(void) {
     g_mock_locator.lookup_calls = 0;
+    g_mock_locator.lookup_batch_calls = 0;
     g_mock_locator.lookup_by_vid_calls = 0;
 }
 
@@ -97,6 +103,20 @@ static td_adapter_result_t mock_locator_lookup(td_adapter_t *handle,
     return g_mock_locator.lookup_rc;
 }
 
+static td_adapter_result_t mock_locator_lookup_batch(td_adapter_t *handle,
+                                                     struct td_adapter_mac_lookup *requests,
+                                                     size_t count) {
+    g_mock_locator.lookup_batch_calls += 1;
+    for (size_t i = 0; i < count; ++i) {
+        requests[i].rc = mock_locator_lookup(handle,
+                                             requests[i].mac,
+                                             requests[i].vlan_id,
+                                             &requests[i].ifindex,
+                                             &requests[i].version);
+    }
+    return TD_ADAPTER_OK;
+}
+
 static td_adapter_result_t mock_locator_lookup_by_vid(td_adapter_t *handle,
                                                       const uint8_t mac[ETH_ALEN],
                                                       uint16_t vlan_id,
@@ -123,6 +143,16 @@ static td_adapter_result_t mock_locator_subscribe(td_adapter_t *handle,
     return TD_ADAPTER_OK;
 }
 
+static td_adapter_result_t mock_locator_subscribe_delta(td_adapter_t *handle,
+                                                        td_adapter_mac_locator_delta_cb cb,
+                                                        void *ctx) {
+    (void)handle;
+    g_mock_locator.subscribed = true;
+    g_mock_locator.delta_cb = cb;
+    g_mock_locator.delta_ctx = ctx;
+    return TD_ADAPTER_OK;
+}
+
 static td_adapter_result_t mock_locator_get_version(td_adapter_t *handle,
                                                     uint64_t *version_out) {
     (void)handle;
@@ -144,11 +174,27 @@ static const struct td_adapter_ops g_mock_adapter_ops = {
     .mac_locator_ops = &g_mock_mac_locator_ops,
 };
 
+static const struct td_adapter_mac_locator_ops g_mock_delta_locator_ops = {
+    .lookup = mock_locator_lookup,
+    .lookup_by_vid = mock_locator_lookup_by_vid,
+    .subscribe = mock_locator_subscribe,
+    .get_version = mock_locator_get_version,
+    .subscribe_delta = mock_locator_subscribe_delta,
+    .lookup_batch = mock_locator_lookup_batch,
+};
+
+static const struct td_adapter_ops g_mock_delta_adapter_ops = {
+    .mac_locator_ops = &g_mock_delta_locator_ops,
+};
+
 static int mock_kernel_ifindex_for_vlan(int vlan_id) {
     return 1000 + vlan_id;
 }
 
+static unsigned int g_if_nametoindex_calls;
+
 unsigned int if_nametoindex(const char *name) {
+    g_if_nametoindex_calls += 1U;
     if (!name) {
         return 0U;
     }
@@ -1071,6 +1117,199 @@ static bool test_mac_refresh_failure_preserves_ifindex(void) {
     return ok;
 }
 
+static void mock_locator_publish(uint64_t version,
+                                 uint64_t base_version,
+                                 const struct td_adapter_mac_delta *deltas,
+                                 size_t count) {
+    struct td_adapter_mac_delta_batch batch = {
+        .version = version,
+        .base_version = base_version,
+        .deltas = deltas,
+        .count = count,
+    };
+    g_mock_locator.version = version;
+    g_mock_locator.delta_cb(&batch, g_mock_locator.delta_ctx);
+}
+
+static bool test_mac_delta_reverifies_changed_keys(void) {
+    const int vlan_id = 160;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 8;
+
+    struct event_capture events;
+    capture_reset(&events);
+
+    mock_locator_reset();
+    g_mock_locator.version = 1;
+    mock_locator_set_lookup_by_vid(TD_ADAPTER_OK, 88);
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            &g_mock_delta_adapter_ops,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for delta test\n");
+        return false;
+    }
+    terminal_manager_set_event_sink(mgr, capture_callback, &events);
+
+    bool ok = true;
+    if (!g_mock_locator.delta_cb || g_mock_locator.refresh_cb) {
+        fprintf(stderr, "expected manager to subscribe through subscribe_delta\n");
+        terminal_manager_destroy(mgr);
+        return false;
+    }
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    const uint8_t moved_mac[ETH_ALEN] = {0x00, 0x56, 0x00, 0x00, 0x00, 0x01};
+    const uint8_t still_mac[ETH_ALEN] = {0x00, 0x56, 0x00, 0x00, 0x00, 0x02};
+    build_arp_packet(&packet, &arp, moved_mac, "192.0.2.120", "192.0.2.120", vlan_id, 0);
+    terminal_manager_on_packet(mgr, &packet);
+    build_arp_packet(&packet, &arp, still_mac, "192.0.2.121", "192.0.2.121", vlan_id, 0);
+    terminal_manager_on_packet(mgr, &packet);
+    terminal_manager_flush_events(mgr);
+    capture_reset(&events);
+    mock_locator_clear_counters();
+
+    /* Only the moved terminal is looked up again. */
+    struct td_adapter_mac_delta delta;
+    memset(&delta, 0, sizeof(delta));
+    memcpy(delta.mac, moved_mac, ETH_ALEN);
+    delta.vlan_id = (uint16_t)vlan_id;
+    delta.old_ifindex = 88U;
+    delta.new_ifindex = 91U;
+    mock_locator_set_lookup(TD_ADAPTER_OK, 91U);
+    mock_locator_publish(2, 1, &delta, 1);
+    terminal_manager_flush_events(mgr);
+
+    if (g_mock_locator.lookup_calls != 1 ||
+        memcmp(g_mock_locator.last_lookup_mac, moved_mac, ETH_ALEN) != 0) {
+        fprintf(stderr, "expected a single lookup for the moved MAC, got %zu\n",
+                g_mock_locator.lookup_calls);
+        ok = false;
+    }
+    if (events.count != 1 || events.records[0].tag != TERMINAL_EVENT_TAG_MOD ||
+        events.records[0].ifindex != 91U || events.records[0].prev_ifindex != 88U) {
+        fprintf(stderr, "expected MOD 88->91 for the moved MAC, got %zu events\n", events.count);
+        ok = false;
+    }
+
+    /* An empty change set advances everyone without lookups. */
+    capture_reset(&events);
+    mock_locator_clear_counters();
+    mock_locator_publish(3, 2, NULL, 0);
+    terminal_manager_flush_events(mgr);
+    if (g_mock_locator.lookup_calls != 0 || events.count != 0) {
+        fprintf(stderr, "expected no lookups for an empty delta, got %zu lookups %zu events\n",
+                g_mock_locator.lookup_calls,
+                events.count);
+        ok = false;
+    }
+
+    /* A diff from a base newer than the last verification vouches for nothing... */
+    mock_locator_clear_counters();
+    mock_locator_publish(5, 4, NULL, 0);
+    if (g_mock_locator.lookup_calls != 2) {
+        fprintf(stderr, "expected both terminals re-verified across a missed batch, got %zu\n",
+                g_mock_locator.lookup_calls);
+        ok = false;
+    }
+
+    /* ...and a batch without a diff re-verifies everything. */
+    mock_locator_clear_counters();
+    mock_locator_publish(6, 0, NULL, 0);
+    if (g_mock_locator.lookup_calls != 2) {
+        fprintf(stderr, "expected full re-verify without a diff, got %zu\n",
+                g_mock_locator.lookup_calls);
+        ok = false;
+    }
+
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_mac_lookup_batch_single_call(void) {
+    const int vlan_id = 170;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 8;
+
+    struct event_capture events;
+    capture_reset(&events);
+
+    mock_locator_reset();
+    mock_locator_set_lookup_by_vid(TD_ADAPTER_OK, 40);
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            &g_mock_delta_adapter_ops,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for batch lookup test\n");
+        return false;
+    }
+    terminal_manager_set_event_sink(mgr, capture_callback, &events);
+
+    const size_t terminals = 3;
+    for (size_t i = 0; i < terminals; ++i) {
+        struct ether_arp arp;
+        struct td_adapter_packet_view packet;
+        uint8_t mac[ETH_ALEN] = {0x00, 0x57, 0x00, 0x00, 0x00, (uint8_t)(i + 1U)};
+        char ip[32];
+        snprintf(ip, sizeof(ip), "192.0.2.%zu", 130 + i);
+        build_arp_packet(&packet, &arp, mac, ip, ip, vlan_id, 0);
+        terminal_manager_on_packet(mgr, &packet);
+    }
+    terminal_manager_flush_events(mgr);
+    capture_reset(&events);
+    mock_locator_clear_counters();
+
+    mock_locator_set_lookup(TD_ADAPTER_OK, 41U);
+    mock_locator_publish(2, 0, NULL, 0);
+    terminal_manager_flush_events(mgr);
+
+    bool ok = true;
+    if (g_mock_locator.lookup_batch_calls != 1 || g_mock_locator.lookup_calls != terminals) {
+        fprintf(stderr, "expected one batch covering %zu lookups, got %zu batches %zu lookups\n",
+                terminals,
+                g_mock_locator.lookup_batch_calls,
+                g_mock_locator.lookup_calls);
+        ok = false;
+    }
+    if (events.count != terminals) {
+        fprintf(stderr, "expected %zu MOD events from batch results, got %zu\n", terminals, events.count);
+        ok = false;
+    }
+    for (size_t i = 0; i < events.count; ++i) {
+        if (events.records[i].tag != TERMINAL_EVENT_TAG_MOD || events.records[i].ifindex != 41U ||
+            events.records[i].prev_ifindex != 40U) {
+            fprintf(stderr, "unexpected batch event %zu: tag=%d ifindex=%u prev=%u\n",
+                    i,
+                    (int)events.records[i].tag,
+                    events.records[i].ifindex,
+                    events.records[i].prev_ifindex);
+            ok = false;
+        }
+    }
+
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
 static bool test_terminal_packet_on_ignored_vlan(void) {
     const int vlan_id = 200;
     const int tx_kernel_ifindex = mock_kernel_ifindex_for_vlan(vlan_id);
@@ -1504,6 +1743,70 @@ done:
     return ok;
 }
 
+static bool test_keepalive_change_reschedules_probe(void) {
+    const int vlan_id = 210;
+    const int tx_kernel_ifindex = mock_kernel_ifindex_for_vlan(vlan_id);
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 120;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 16;
+
+    struct probe_capture probes;
+    probe_reset(&probes);
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            probe_callback,
+                                                            &probes);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager\n");
+        return false;
+    }
+
+    apply_address_update(mgr, tx_kernel_ifindex, "198.51.100.1", 24, true);
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    const uint8_t mac[ETH_ALEN] = {0x00, 0xaa, 0xbb, 0xcc, 0xdd, 0x21};
+    build_arp_packet(&packet, &arp, mac, "198.51.100.43", "198.51.100.43", vlan_id, 11);
+    terminal_manager_on_packet(mgr, &packet);
+
+    /* The entry was scheduled two minutes out; shrinking the interval must
+     * pull its deadline in rather than wait for the old one to fire. */
+    bool ok = true;
+    if (terminal_manager_set_keepalive_interval(mgr, 1) != 0) {
+        fprintf(stderr, "set_keepalive_interval failed\n");
+        ok = false;
+        goto done;
+    }
+
+    sleep_ms(1100);
+    terminal_manager_on_timer(mgr);
+
+    if (probes.count != 1) {
+        fprintf(stderr, "expected one probe after shrinking keepalive, got %zu\n", probes.count);
+        ok = false;
+        goto done;
+    }
+
+    /* A second tick within the new interval must not probe again. */
+    terminal_manager_on_timer(mgr);
+    if (probes.count != 1) {
+        fprintf(stderr, "probe repeated before the interval elapsed (%zu)\n", probes.count);
+        ok = false;
+        goto done;
+    }
+
+done:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
 static bool test_iface_invalid_holdoff(void) {
     const int vlan_id = 300;
     const int tx_kernel_ifindex = mock_kernel_ifindex_for_vlan(vlan_id);
@@ -1908,6 +2211,2113 @@ cleanup:
     return ok;
 }
 
+static bool test_vlan_link_cache_avoids_syscalls(void) {
+    const int vlan_id = 100;
+    const int tx_kernel_ifindex = 7100; /* deliberately not what if_nametoindex would say */
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 16;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for link cache test\n");
+        return false;
+    }
+
+    terminal_manager_reset_link_cache(mgr);
+    terminal_link_update_t link = {
+        .kernel_ifindex = tx_kernel_ifindex,
+        .ifname = "vlan100",
+        .is_add = true,
+    };
+    terminal_manager_on_link_update(mgr, &link);
+    terminal_manager_mark_link_cache_ready(mgr);
+    apply_address_update(mgr, tx_kernel_ifindex, "10.1.0.1", 24, true);
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    const uint8_t mac[ETH_ALEN] = {0x02, 0x10, 0x20, 0x30, 0x40, 0x50};
+    build_arp_packet(&packet, &arp, mac, "10.1.0.20", "10.1.0.20", vlan_id, 5);
+
+    struct debug_capture capture;
+    debug_capture_init(&capture);
+    td_debug_dump_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.verbose_metrics = true;
+    td_debug_dump_context_t ctx;
+    bool ok = true;
+
+    unsigned int calls_before = g_if_nametoindex_calls;
+    for (int i = 0; i < 4; ++i) {
+        terminal_manager_on_packet(mgr, &packet);
+    }
+    if (g_if_nametoindex_calls != calls_before) {
+        fprintf(stderr, "expected no if_nametoindex calls with a ready link cache, saw %u\n",
+                g_if_nametoindex_calls - calls_before);
+        ok = false;
+        goto cleanup;
+    }
+
+    td_debug_context_reset(&ctx, &opts);
+    int rc = td_debug_dump_terminal_table(mgr, &opts, debug_capture_writer, &capture, &ctx);
+    if (rc != 0 || !capture.data || !strstr(capture.data, "tx_iface=vlan100 tx_kernel_ifindex=7100")) {
+        fprintf(stderr, "terminal not bound through the link cache: %s\n",
+                capture.data ? capture.data : "<empty>");
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Renaming the link away from the VLAN naming scheme invalidates it. */
+    snprintf(link.ifname, sizeof(link.ifname), "%s", "uplink0");
+    terminal_manager_on_link_update(mgr, &link);
+    terminal_manager_on_packet(mgr, &packet);
+
+    debug_capture_reset(&capture);
+    td_debug_context_reset(&ctx, &opts);
+    rc = td_debug_dump_terminal_table(mgr, &opts, debug_capture_writer, &capture, &ctx);
+    if (rc != 0 || !capture.data || !strstr(capture.data, "state=IFACE_INVALID") ||
+        !strstr(capture.data, "tx_kernel_ifindex=-1")) {
+        fprintf(stderr, "terminal still bound after link rename: %s\n",
+                capture.data ? capture.data : "<empty>");
+        ok = false;
+        goto cleanup;
+    }
+    if (g_if_nametoindex_calls != calls_before) {
+        fprintf(stderr, "link rename fell back to if_nametoindex\n");
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    debug_capture_free(&capture);
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_link_resync_skips_deleted_links(void) {
+    const int deleted_ifindex = 7300;
+    const int live_ifindex = 7301;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 16;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for link resync test\n");
+        return false;
+    }
+
+    /* vlan130 is deleted while the dump runs; its stale reply arrives after. */
+    terminal_manager_reset_link_cache(mgr);
+    terminal_link_update_t link = {
+        .kernel_ifindex = deleted_ifindex,
+        .is_add = false,
+    };
+    terminal_manager_on_link_update(mgr, &link);
+    link.is_add = true;
+    link.from_dump = true;
+    snprintf(link.ifname, sizeof(link.ifname), "%s", "vlan130");
+    terminal_manager_on_link_update(mgr, &link);
+    link.kernel_ifindex = live_ifindex;
+    snprintf(link.ifname, sizeof(link.ifname), "%s", "vlan131");
+    terminal_manager_on_link_update(mgr, &link);
+
+    struct debug_capture capture;
+    debug_capture_init(&capture);
+    td_debug_dump_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.verbose_metrics = true;
+    td_debug_dump_context_t ctx;
+    bool ok = true;
+
+    int rc = terminal_manager_mark_link_cache_ready(mgr);
+    if (rc != 0) {
+        fprintf(stderr, "mark_link_cache_ready failed: %d\n", rc);
+        ok = false;
+        goto cleanup;
+    }
+    apply_address_update(mgr, deleted_ifindex, "10.130.0.1", 24, true);
+    apply_address_update(mgr, live_ifindex, "10.131.0.1", 24, true);
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    const uint8_t stale_mac[ETH_ALEN] = {0x02, 0x13, 0x00, 0x00, 0x00, 0x30};
+    const uint8_t live_mac[ETH_ALEN] = {0x02, 0x13, 0x00, 0x00, 0x00, 0x31};
+    build_arp_packet(&packet, &arp, stale_mac, "10.130.0.20", "10.130.0.20", 130, 5);
+    terminal_manager_on_packet(mgr, &packet);
+    build_arp_packet(&packet, &arp, live_mac, "10.131.0.20", "10.131.0.20", 131, 5);
+    terminal_manager_on_packet(mgr, &packet);
+
+    td_debug_context_reset(&ctx, &opts);
+    rc = td_debug_dump_terminal_table(mgr, &opts, debug_capture_writer, &capture, &ctx);
+    if (rc != 0 || !capture.data || !strstr(capture.data, "tx_iface=vlan131 tx_kernel_ifindex=7301") ||
+        strstr(capture.data, "tx_kernel_ifindex=7300")) {
+        fprintf(stderr, "dump reply for a deleted link was applied: %s\n",
+                capture.data ? capture.data : "<empty>");
+        ok = false;
+        goto cleanup;
+    }
+
+    /* More deletions than can be tracked: the dump is not trusted. */
+    terminal_manager_reset_link_cache(mgr);
+    link.is_add = false;
+    link.from_dump = false;
+    for (int i = 0; i <= 64; ++i) {
+        link.kernel_ifindex = 8000 + i;
+        terminal_manager_on_link_update(mgr, &link);
+    }
+    rc = terminal_manager_mark_link_cache_ready(mgr);
+    if (rc != -EAGAIN) {
+        fprintf(stderr, "expected -EAGAIN after deletion overflow, got %d\n", rc);
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    debug_capture_free(&capture);
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_known_terminal_fast_path(void) {
+    const int vlan_id = 200;
+    const int tx_kernel_ifindex = mock_kernel_ifindex_for_vlan(vlan_id);
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 16;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for fast path test\n");
+        return false;
+    }
+
+    /* Without a link cache every resolve_tx_interface costs one
+     * if_nametoindex call, which makes re-resolution visible. */
+    apply_address_update(mgr, tx_kernel_ifindex, "10.2.0.1", 24, true);
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    const uint8_t mac[ETH_ALEN] = {0x02, 0x20, 0x30, 0x40, 0x50, 0x60};
+    build_arp_packet(&packet, &arp, mac, "10.2.0.20", "10.2.0.20", vlan_id, 5);
+
+    bool ok = true;
+    terminal_manager_on_packet(mgr, &packet);
+
+    unsigned int calls_before = g_if_nametoindex_calls;
+    for (int i = 0; i < 8; ++i) {
+        terminal_manager_on_packet(mgr, &packet);
+    }
+    if (g_if_nametoindex_calls != calls_before) {
+        fprintf(stderr, "known terminal re-resolved %u times on an unchanged binding\n",
+                g_if_nametoindex_calls - calls_before);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* A prefix change on the bound interface forces exactly one re-resolve. */
+    apply_address_update(mgr, tx_kernel_ifindex, "10.2.1.1", 24, true);
+    calls_before = g_if_nametoindex_calls;
+    terminal_manager_on_packet(mgr, &packet);
+    terminal_manager_on_packet(mgr, &packet);
+    if (g_if_nametoindex_calls != calls_before + 1U) {
+        fprintf(stderr, "expected one re-resolve after prefix change, saw %u\n",
+                g_if_nametoindex_calls - calls_before);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Moving VLAN always takes the full path. */
+    struct ether_arp moved_arp;
+    struct td_adapter_packet_view moved_packet;
+    build_arp_packet(&moved_packet, &moved_arp, mac, "10.2.0.20", "10.2.0.20", vlan_id + 1, 5);
+    calls_before = g_if_nametoindex_calls;
+    terminal_manager_on_packet(mgr, &moved_packet);
+    if (g_if_nametoindex_calls == calls_before) {
+        fprintf(stderr, "vlan change did not re-resolve the terminal\n");
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+struct snapshot_reentry_ctx {
+    struct terminal_manager *mgr;
+    const struct td_adapter_packet_view *packet;
+    size_t count;
+};
+
+static bool snapshot_reentry_callback(const terminal_event_record_t *record, void *user_ctx) {
+    struct snapshot_reentry_ctx *ctx = (struct snapshot_reentry_ctx *)user_ctx;
+    if (!ctx || !record) {
+        return false;
+    }
+    if (ctx->count == 0) {
+        terminal_manager_on_packet(ctx->mgr, ctx->packet);
+    }
+    ctx->count += 1;
+    return true;
+}
+
+static bool test_query_snapshot_versioning(void) {
+    const int vlan_id = 200;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 16;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for snapshot test\n");
+        return false;
+    }
+
+    apply_address_update(mgr, mock_kernel_ifindex_for_vlan(vlan_id), "10.3.0.1", 24, true);
+
+    struct ether_arp arp_a;
+    struct ether_arp arp_b;
+    struct td_adapter_packet_view packet_a;
+    struct td_adapter_packet_view packet_b;
+    const uint8_t mac_a[ETH_ALEN] = {0x02, 0x31, 0x00, 0x00, 0x00, 0x01};
+    const uint8_t mac_b[ETH_ALEN] = {0x02, 0x31, 0x00, 0x00, 0x00, 0x02};
+    build_arp_packet(&packet_a, &arp_a, mac_a, "10.3.0.10", "10.3.0.10", vlan_id, 5);
+    build_arp_packet(&packet_b, &arp_b, mac_b, "10.3.0.11", "10.3.0.11", vlan_id, 5);
+
+    bool ok = true;
+    terminal_manager_on_packet(mgr, &packet_a);
+
+    struct query_counter counter;
+    memset(&counter, 0, sizeof(counter));
+    uint64_t first = 0;
+    uint64_t second = 0;
+    if (terminal_manager_query_snapshot(mgr, query_counter_callback, &counter, &first) != 0 ||
+        counter.count != 1 || first == 0) {
+        fprintf(stderr, "initial snapshot query failed count=%zu version=%llu\n",
+                counter.count, (unsigned long long)first);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* A keepalive refresh does not change the view. */
+    terminal_manager_on_packet(mgr, &packet_a);
+    memset(&counter, 0, sizeof(counter));
+    if (terminal_manager_query_snapshot(mgr, query_counter_callback, &counter, &second) != 0 ||
+        counter.count != 1 || second != first) {
+        fprintf(stderr, "unchanged view changed version %llu -> %llu\n",
+                (unsigned long long)first, (unsigned long long)second);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* A terminal learned while a query walks the snapshot is not seen by it. */
+    struct snapshot_reentry_ctx reentry = {mgr, &packet_b, 0};
+    if (terminal_manager_query_snapshot(mgr, snapshot_reentry_callback, &reentry, NULL) != 0 ||
+        reentry.count != 1) {
+        fprintf(stderr, "snapshot walk saw %zu records, expected 1\n", reentry.count);
+        ok = false;
+        goto cleanup;
+    }
+
+    memset(&counter, 0, sizeof(counter));
+    if (terminal_manager_query_snapshot(mgr, query_counter_callback, &counter, &second) != 0 ||
+        counter.count != 2 || second <= first) {
+        fprintf(stderr, "expected 2 records at a newer version, got %zu at %llu\n",
+                counter.count, (unsigned long long)second);
+        ok = false;
+        goto cleanup;
+    }
+
+    first = second;
+    build_arp_packet(&packet_a, &arp_a, mac_a, "10.3.0.10", "10.3.0.10", vlan_id, 9);
+    terminal_manager_on_packet(mgr, &packet_a);
+    memset(&counter, 0, sizeof(counter));
+    if (terminal_manager_query_snapshot(mgr, query_counter_callback, &counter, &second) != 0 ||
+        second <= first) {
+        fprintf(stderr, "ifindex change did not advance the view version\n");
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+struct seq_capture {
+    terminal_event_record_t records[8];
+    size_t count;
+};
+
+static bool seq_capture_callback(const terminal_event_record_t *record, void *user_ctx) {
+    struct seq_capture *capture = (struct seq_capture *)user_ctx;
+    if (!capture || !record) {
+        return false;
+    }
+    if (capture->count < sizeof(capture->records) / sizeof(capture->records[0])) {
+        capture->records[capture->count] = *record;
+    }
+    capture->count += 1;
+    return true;
+}
+
+static bool test_query_since_journal(void) {
+    const int vlan_id = 200;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 16;
+    cfg.event_journal_size = 4;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for journal test\n");
+        return false;
+    }
+
+    apply_address_update(mgr, mock_kernel_ifindex_for_vlan(vlan_id), "10.4.0.1", 24, true);
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    uint8_t mac[ETH_ALEN] = {0x02, 0x41, 0x00, 0x00, 0x00, 0x00};
+    char ip[INET_ADDRSTRLEN];
+
+    bool ok = true;
+    /* No sink is attached: events are still sequenced and journaled. */
+    for (uint8_t i = 1; i <= 2; ++i) {
+        mac[5] = i;
+        snprintf(ip, sizeof(ip), "10.4.0.%u", (unsigned int)(10U + i));
+        build_arp_packet(&packet, &arp, mac, ip, ip, vlan_id, 5);
+        terminal_manager_on_packet(mgr, &packet);
+    }
+
+    struct query_counter counter;
+    memset(&counter, 0, sizeof(counter));
+    uint64_t version = 0;
+    if (terminal_manager_query_snapshot(mgr, query_counter_callback, &counter, &version) != 0 ||
+        counter.count != 2 || version != 2U) {
+        fprintf(stderr, "expected 2 records at version 2, got %zu at %llu\n",
+                counter.count, (unsigned long long)version);
+        ok = false;
+        goto cleanup;
+    }
+
+    struct seq_capture capture;
+    memset(&capture, 0, sizeof(capture));
+    uint64_t latest = 0;
+    if (terminal_manager_query_since(mgr, 0, seq_capture_callback, &capture, &latest) != 0 ||
+        capture.count != 2 || latest != 2U ||
+        capture.records[0].seq != 1U || capture.records[1].seq != 2U ||
+        capture.records[0].tag != TERMINAL_EVENT_TAG_ADD) {
+        fprintf(stderr, "query_since(0) returned %zu records, latest=%llu\n",
+                capture.count, (unsigned long long)latest);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* A port move after the snapshot is exactly the delta from its version. */
+    mac[5] = 1;
+    build_arp_packet(&packet, &arp, mac, "10.4.0.11", "10.4.0.11", vlan_id, 9);
+    terminal_manager_on_packet(mgr, &packet);
+    memset(&capture, 0, sizeof(capture));
+    if (terminal_manager_query_since(mgr, version, seq_capture_callback, &capture, &latest) != 0 ||
+        capture.count != 1 || latest != 3U ||
+        capture.records[0].tag != TERMINAL_EVENT_TAG_MOD ||
+        capture.records[0].ifindex != 9U || capture.records[0].prev_ifindex != 5U ||
+        capture.records[0].seq != 3U) {
+        fprintf(stderr, "expected one MOD 5->9 at seq 3 after the snapshot\n");
+        ok = false;
+        goto cleanup;
+    }
+
+    memset(&capture, 0, sizeof(capture));
+    if (terminal_manager_query_since(mgr, latest, seq_capture_callback, &capture, NULL) != 0 ||
+        capture.count != 0) {
+        fprintf(stderr, "query_since at the head returned %zu records\n", capture.count);
+        ok = false;
+        goto cleanup;
+    }
+    if (terminal_manager_query_since(mgr, latest + 1U, seq_capture_callback, &capture, NULL) != -ESTALE) {
+        fprintf(stderr, "cursor ahead of the manager was not rejected\n");
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Four more events push seq 3 out of a four-record journal. */
+    for (uint8_t i = 3; i <= 6; ++i) {
+        mac[5] = i;
+        snprintf(ip, sizeof(ip), "10.4.0.%u", (unsigned int)(10U + i));
+        build_arp_packet(&packet, &arp, mac, ip, ip, vlan_id, 5);
+        terminal_manager_on_packet(mgr, &packet);
+    }
+    if (terminal_manager_query_since(mgr, 2, seq_capture_callback, &capture, &latest) != -ESTALE ||
+        latest != 7U) {
+        fprintf(stderr, "wrapped journal did not request a resync\n");
+        ok = false;
+        goto cleanup;
+    }
+    memset(&capture, 0, sizeof(capture));
+    if (terminal_manager_query_since(mgr, 3, seq_capture_callback, &capture, NULL) != 0 ||
+        capture.count != 4 || capture.records[0].seq != 4U || capture.records[3].seq != 7U) {
+        fprintf(stderr, "expected seq 4..7 from the journal, got %zu records\n", capture.count);
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool page_matches_macs(const struct seq_capture *capture,
+                              const uint8_t *expected_last_octets,
+                              size_t expected_count) {
+    if (capture->count != expected_count) {
+        return false;
+    }
+    for (size_t i = 0; i < expected_count; ++i) {
+        if (capture->records[i].key.mac[5] != expected_last_octets[i] ||
+            capture->records[i].seq != 0U) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test_query_filtered_paging(void) {
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 1;
+    cfg.keepalive_miss_threshold = 1;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 16;
+
+    struct probe_capture probes;
+    probe_reset(&probes);
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            probe_callback,
+                                                            &probes);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for filtered query test\n");
+        return false;
+    }
+
+    apply_address_update(mgr, mock_kernel_ifindex_for_vlan(200), "10.5.0.1", 24, true);
+    apply_address_update(mgr, mock_kernel_ifindex_for_vlan(300), "10.6.0.1", 24, true);
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    uint8_t mac[ETH_ALEN] = {0x02, 0x51, 0x00, 0x00, 0x00, 0x00};
+    char ip[INET_ADDRSTRLEN];
+
+    /* Inserted out of key order: 1..5 on VLAN 200/ifindex 5, 6..7 on VLAN 300/ifindex 7. */
+    static const uint8_t insert_order[] = {4, 1, 5, 3, 2, 7, 6};
+    for (size_t i = 0; i < sizeof(insert_order); ++i) {
+        uint8_t octet = insert_order[i];
+        bool vlan300 = octet >= 6;
+        mac[5] = octet;
+        snprintf(ip, sizeof(ip), "10.%u.0.%u", vlan300 ? 6U : 5U, (unsigned int)(10U + octet));
+        build_arp_packet(&packet, &arp, mac, ip, ip, vlan300 ? 300 : 200, vlan300 ? 7U : 5U);
+        terminal_manager_on_packet(mgr, &packet);
+    }
+
+    bool ok = true;
+    terminal_query_filter_t filter;
+    terminal_query_page_t page;
+    struct seq_capture capture;
+
+    /* VLAN 200 in pages of two, resumed from the returned cursor. */
+    memset(&filter, 0, sizeof(filter));
+    filter.filter_by_vlan = true;
+    filter.vlan_id = 200;
+    memset(&page, 0, sizeof(page));
+    page.limit = 2;
+    static const uint8_t vlan200_pages[3][2] = {{1, 2}, {3, 4}, {5, 0}};
+    for (size_t n = 0; n < 3; ++n) {
+        memset(&capture, 0, sizeof(capture));
+        size_t expected = n < 2 ? 2U : 1U;
+        if (terminal_manager_query_filtered(mgr, &filter, &page, seq_capture_callback, &capture) != 0 ||
+            !page_matches_macs(&capture, vlan200_pages[n], expected) ||
+            page.total != 5U || page.more != (n < 2) || !page.has_cursor ||
+            page.cursor.mac[5] != vlan200_pages[n][expected - 1U]) {
+            fprintf(stderr, "VLAN 200 page %zu: %zu records, total=%zu more=%d\n",
+                    n, capture.count, page.total, page.more ? 1 : 0);
+            ok = false;
+            goto cleanup;
+        }
+    }
+
+    memset(&filter, 0, sizeof(filter));
+    filter.filter_by_ifindex = true;
+    filter.ifindex = 7;
+    memset(&capture, 0, sizeof(capture));
+    static const uint8_t ifindex7[] = {6, 7};
+    if (terminal_manager_query_filtered(mgr, &filter, NULL, seq_capture_callback, &capture) != 0 ||
+        !page_matches_macs(&capture, ifindex7, 2) || capture.records[0].ifindex != 7U) {
+        fprintf(stderr, "ifindex 7 query returned %zu records\n", capture.count);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Port and VLAN moves must carry the entry between index chains. */
+    mac[5] = 1;
+    build_arp_packet(&packet, &arp, mac, "10.5.0.11", "10.5.0.11", 200, 9);
+    terminal_manager_on_packet(mgr, &packet);
+    mac[5] = 2;
+    build_arp_packet(&packet, &arp, mac, "10.5.0.12", "10.5.0.12", 300, 7);
+    terminal_manager_on_packet(mgr, &packet);
+
+    memset(&page, 0, sizeof(page));
+    filter.ifindex = 5;
+    memset(&capture, 0, sizeof(capture));
+    static const uint8_t ifindex5[] = {3, 4, 5};
+    if (terminal_manager_query_filtered(mgr, &filter, &page, seq_capture_callback, &capture) != 0 ||
+        !page_matches_macs(&capture, ifindex5, 3) || page.more) {
+        fprintf(stderr, "ifindex 5 after the moves returned %zu records\n", capture.count);
+        ok = false;
+        goto cleanup;
+    }
+    filter.ifindex = 9;
+    memset(&capture, 0, sizeof(capture));
+    static const uint8_t ifindex9[] = {1};
+    if (terminal_manager_query_filtered(mgr, &filter, NULL, seq_capture_callback, &capture) != 0 ||
+        !page_matches_macs(&capture, ifindex9, 1)) {
+        fprintf(stderr, "ifindex 9 after the move returned %zu records\n", capture.count);
+        ok = false;
+        goto cleanup;
+    }
+
+    memset(&filter, 0, sizeof(filter));
+    filter.filter_by_vlan = true;
+    filter.vlan_id = 300;
+    filter.filter_by_mac_prefix = true;
+    memcpy(filter.mac_prefix, mac, 5);
+    filter.mac_prefix_len = 5;
+    memset(&capture, 0, sizeof(capture));
+    static const uint8_t vlan300[] = {2, 6, 7};
+    if (terminal_manager_query_filtered(mgr, &filter, NULL, seq_capture_callback, &capture) != 0 ||
+        !page_matches_macs(&capture, vlan300, 3)) {
+        fprintf(stderr, "VLAN 300 after the move returned %zu records\n", capture.count);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Unfiltered with a cursor past the last key: empty page, full total. */
+    memset(&page, 0, sizeof(page));
+    page.has_cursor = true;
+    memset(page.cursor.mac, 0xff, ETH_ALEN);
+    memset(&capture, 0, sizeof(capture));
+    if (terminal_manager_query_filtered(mgr, NULL, &page, seq_capture_callback, &capture) != 0 ||
+        capture.count != 0 || page.total != 7U || page.more) {
+        fprintf(stderr, "cursor past the end returned %zu records, total=%zu\n",
+                capture.count, page.total);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Expired entries leave both indexes: the per-index counts must add up
+     * to what a full scan still sees. */
+    sleep_ms(1100);
+    terminal_manager_on_timer(mgr);
+    struct terminal_manager_stats stats;
+    terminal_manager_get_stats(mgr, &stats);
+    memset(&page, 0, sizeof(page));
+    memset(&capture, 0, sizeof(capture));
+    terminal_manager_query_filtered(mgr, NULL, &page, seq_capture_callback, &capture);
+    size_t remaining = page.total;
+    size_t by_ifindex = 0;
+    size_t by_vlan = 0;
+    static const uint32_t ifindexes[] = {5, 7, 9};
+    for (size_t i = 0; i < sizeof(ifindexes) / sizeof(ifindexes[0]); ++i) {
+        memset(&filter, 0, sizeof(filter));
+        filter.filter_by_ifindex = true;
+        filter.ifindex = ifindexes[i];
+        memset(&page, 0, sizeof(page));
+        terminal_manager_query_filtered(mgr, &filter, &page, seq_capture_callback, &capture);
+        by_ifindex += page.total;
+    }
+    for (int vlan = 200; vlan <= 300; vlan += 100) {
+        memset(&filter, 0, sizeof(filter));
+        filter.filter_by_vlan = true;
+        filter.vlan_id = vlan;
+        memset(&page, 0, sizeof(page));
+        terminal_manager_query_filtered(mgr, &filter, &page, seq_capture_callback, &capture);
+        by_vlan += page.total;
+    }
+    if (stats.terminals_removed == 0 || remaining != stats.current_terminals ||
+        by_ifindex != remaining || by_vlan != remaining) {
+        fprintf(stderr, "indexes out of step after expiry: removed=%" PRIu64
+                " remaining=%zu by_ifindex=%zu by_vlan=%zu\n",
+                stats.terminals_removed, remaining, by_ifindex, by_vlan);
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_lookup_by_mac_and_ip(void) {
+    const int vlan_id = 200;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 1;
+    cfg.keepalive_miss_threshold = 1;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 64;
+
+    struct probe_capture probes;
+    probe_reset(&probes);
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            probe_callback,
+                                                            &probes);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for point lookup test\n");
+        return false;
+    }
+
+    apply_address_update(mgr, mock_kernel_ifindex_for_vlan(vlan_id), "10.7.0.1", 24, true);
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    uint8_t mac[ETH_ALEN] = {0x02, 0x61, 0x00, 0x00, 0x00, 0x00};
+    char ip[INET_ADDRSTRLEN];
+
+    /* Enough terminals to grow both indexes past their initial buckets. */
+    for (uint8_t i = 1; i <= 40; ++i) {
+        mac[5] = i;
+        snprintf(ip, sizeof(ip), "10.7.0.%u", (unsigned int)(100U + i));
+        build_arp_packet(&packet, &arp, mac, ip, ip, vlan_id, 5);
+        terminal_manager_on_packet(mgr, &packet);
+    }
+    /* MAC 1 re-addressed to .200 (a new key), and MAC 0x50 claiming .101. */
+    mac[5] = 1;
+    build_arp_packet(&packet, &arp, mac, "10.7.0.200", "10.7.0.200", vlan_id, 5);
+    terminal_manager_on_packet(mgr, &packet);
+    mac[5] = 0x50;
+    build_arp_packet(&packet, &arp, mac, "10.7.0.101", "10.7.0.101", vlan_id, 6);
+    terminal_manager_on_packet(mgr, &packet);
+
+    bool ok = true;
+    struct seq_capture capture;
+    struct in_addr addr;
+
+    mac[5] = 1;
+    memset(&capture, 0, sizeof(capture));
+    if (terminal_manager_lookup_by_mac(mgr, mac, seq_capture_callback, &capture) != 0 ||
+        capture.count != 2 ||
+        memcmp(capture.records[0].key.mac, mac, ETH_ALEN) != 0 ||
+        memcmp(capture.records[1].key.mac, mac, ETH_ALEN) != 0 ||
+        capture.records[0].key.ip.s_addr == capture.records[1].key.ip.s_addr) {
+        fprintf(stderr, "lookup_by_mac expected both addresses of MAC 1, got %zu\n", capture.count);
+        ok = false;
+        goto cleanup;
+    }
+
+    inet_pton(AF_INET, "10.7.0.101", &addr);
+    memset(&capture, 0, sizeof(capture));
+    if (terminal_manager_lookup_by_ip(mgr, addr, seq_capture_callback, &capture) != 0 ||
+        capture.count != 2 ||
+        capture.records[0].key.ip.s_addr != addr.s_addr ||
+        capture.records[1].key.ip.s_addr != addr.s_addr ||
+        capture.records[0].key.mac[5] + capture.records[1].key.mac[5] != 0x51 ||
+        capture.records[0].ifindex + capture.records[1].ifindex != 11U) {
+        fprintf(stderr, "lookup_by_ip expected MAC 1 and MAC 0x50 on .101, got %zu\n", capture.count);
+        ok = false;
+        goto cleanup;
+    }
+
+    inet_pton(AF_INET, "10.7.0.250", &addr);
+    mac[5] = 0x7f;
+    memset(&capture, 0, sizeof(capture));
+    if (terminal_manager_lookup_by_ip(mgr, addr, seq_capture_callback, &capture) != 0 ||
+        terminal_manager_lookup_by_mac(mgr, mac, seq_capture_callback, &capture) != 0 ||
+        capture.count != 0) {
+        fprintf(stderr, "lookups for unknown keys returned %zu records\n", capture.count);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Expired entries must leave both indexes. */
+    sleep_ms(1100);
+    terminal_manager_on_timer(mgr);
+    struct terminal_manager_stats stats;
+    terminal_manager_get_stats(mgr, &stats);
+    size_t by_mac = 0;
+    size_t by_ip = 0;
+    for (unsigned int i = 1; i <= 41; ++i) {
+        mac[5] = (uint8_t)(i <= 40 ? i : 0x50);
+        memset(&capture, 0, sizeof(capture));
+        terminal_manager_lookup_by_mac(mgr, mac, seq_capture_callback, &capture);
+        by_mac += capture.count;
+        snprintf(ip, sizeof(ip), "10.7.0.%u", i <= 40 ? 100U + i : 200U);
+        inet_pton(AF_INET, ip, &addr);
+        memset(&capture, 0, sizeof(capture));
+        terminal_manager_lookup_by_ip(mgr, addr, seq_capture_callback, &capture);
+        by_ip += capture.count;
+    }
+    if (stats.terminals_removed == 0 || by_mac != stats.current_terminals ||
+        by_ip != stats.current_terminals) {
+        fprintf(stderr, "point indexes out of step after expiry: removed=%" PRIu64
+                " current=%" PRIu64 " by_mac=%zu by_ip=%zu\n",
+                stats.terminals_removed, stats.current_terminals, by_mac, by_ip);
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_source_ip_longest_prefix(void) {
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 16;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for prefix test\n");
+        return false;
+    }
+
+    /* Enough interfaces to grow the ifindex index several times, then drop
+     * every other one to exercise deletion from it. */
+    for (int vid = 1; vid <= 250; ++vid) {
+        char address[INET_ADDRSTRLEN];
+        snprintf(address, sizeof(address), "172.20.%d.1", vid);
+        apply_address_update(mgr, mock_kernel_ifindex_for_vlan(vid), address, 24, true);
+    }
+    for (int vid = 2; vid <= 250; vid += 2) {
+        char address[INET_ADDRSTRLEN];
+        snprintf(address, sizeof(address), "172.20.%d.1", vid);
+        apply_address_update(mgr, mock_kernel_ifindex_for_vlan(vid), address, 24, false);
+    }
+
+    /* The covering /16 arrives after the /24, as a secondary address would;
+     * the /24 must still be chosen for hosts inside it. */
+    const int vlan_id = 201;
+    apply_address_update(mgr, mock_kernel_ifindex_for_vlan(vlan_id), "172.16.0.1", 12, true);
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    const uint8_t mac[ETH_ALEN] = {0x02, 0x30, 0x40, 0x50, 0x60, 0x70};
+    build_arp_packet(&packet, &arp, mac, "172.20.201.20", "172.20.201.20", vlan_id, 5);
+    terminal_manager_on_packet(mgr, &packet);
+
+    struct ether_arp outside_arp;
+    struct td_adapter_packet_view outside_packet;
+    const uint8_t outside_mac[ETH_ALEN] = {0x02, 0x30, 0x40, 0x50, 0x60, 0x71};
+    build_arp_packet(&outside_packet, &outside_arp, outside_mac, "172.21.0.20", "172.21.0.20", vlan_id, 5);
+    terminal_manager_on_packet(mgr, &outside_packet);
+
+    struct ether_arp removed_arp;
+    struct td_adapter_packet_view removed_packet;
+    const uint8_t removed_mac[ETH_ALEN] = {0x02, 0x30, 0x40, 0x50, 0x60, 0x72};
+    build_arp_packet(&removed_packet, &removed_arp, removed_mac, "172.20.200.20", "172.20.200.20", 200, 5);
+    terminal_manager_on_packet(mgr, &removed_packet);
+
+    struct debug_capture capture;
+    debug_capture_init(&capture);
+    td_debug_dump_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.verbose_metrics = true;
+    td_debug_dump_context_t ctx;
+    td_debug_context_reset(&ctx, &opts);
+
+    bool ok = true;
+    int rc = td_debug_dump_terminal_table(mgr, &opts, debug_capture_writer, &capture, &ctx);
+    if (rc != 0 || !capture.data) {
+        fprintf(stderr, "terminal dump failed rc=%d\n", rc);
+        ok = false;
+        goto cleanup;
+    }
+    if (!strstr(capture.data, "ip=172.20.201.20 state=ACTIVE vlan=201") ||
+        !strstr(capture.data, "tx_src=172.20.201.1")) {
+        fprintf(stderr, "expected the /24 source address:\n%s", capture.data);
+        ok = false;
+        goto cleanup;
+    }
+    if (!strstr(capture.data, "tx_src=172.16.0.1")) {
+        fprintf(stderr, "expected the /12 source address outside the /24:\n%s", capture.data);
+        ok = false;
+        goto cleanup;
+    }
+    if (!strstr(capture.data, "ip=172.20.200.20 state=IFACE_INVALID")) {
+        fprintf(stderr, "terminal on a removed interface was bound:\n%s", capture.data);
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    debug_capture_free(&capture);
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_mass_iface_down_moves_bindings(void) {
+    const int vlan_id = 120;
+    const int tx_kernel_ifindex = mock_kernel_ifindex_for_vlan(vlan_id);
+    const size_t terminal_total = 2000;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = terminal_total;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for iface down test\n");
+        return false;
+    }
+
+    /* The link cache lets the pending retry map the ifindex back to its VLAN. */
+    terminal_link_update_t link = {
+        .kernel_ifindex = tx_kernel_ifindex,
+        .ifname = "vlan120",
+        .is_add = true,
+    };
+    terminal_manager_on_link_update(mgr, &link);
+    terminal_manager_mark_link_cache_ready(mgr);
+    apply_address_update(mgr, tx_kernel_ifindex, "10.120.0.1", 16, true);
+    for (size_t i = 0; i < terminal_total; ++i) {
+        struct ether_arp arp;
+        struct td_adapter_packet_view packet;
+        uint8_t mac[ETH_ALEN] = {0x02, 0x12, 0x00, 0x00, (uint8_t)(i >> 8), (uint8_t)i};
+        char ip[INET_ADDRSTRLEN];
+        snprintf(ip, sizeof(ip), "10.120.%zu.%zu", (i / 200U) + 1U, (i % 200U) + 1U);
+        build_arp_packet(&packet, &arp, mac, ip, ip, vlan_id, 5);
+        terminal_manager_on_packet(mgr, &packet);
+    }
+
+    struct debug_capture capture;
+    debug_capture_init(&capture);
+    td_debug_dump_context_t ctx;
+    char expected[96];
+    bool ok = true;
+
+    td_debug_context_reset(&ctx, NULL);
+    int rc = td_debug_dump_iface_binding_table(mgr, NULL, debug_capture_writer, &capture, &ctx);
+    snprintf(expected, sizeof(expected), "binding kernel_ifindex=%d name=", tx_kernel_ifindex);
+    if (rc != 0 || !capture.data || !strstr(capture.data, expected) ||
+        !strstr(capture.data, "terminals=2000 ")) {
+        fprintf(stderr, "expected every terminal bound before the prefix goes away:\n%s",
+                capture.data ? capture.data : "<empty>");
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Interface down: every binding moves to the VLAN's pending bucket. */
+    apply_address_update(mgr, tx_kernel_ifindex, "10.120.0.1", 16, false);
+
+    debug_capture_reset(&capture);
+    td_debug_context_reset(&ctx, NULL);
+    rc = td_debug_dump_pending_vlan_table(mgr, NULL, debug_capture_writer, &capture, &ctx);
+    if (rc != 0 || !capture.data ||
+        !strstr(capture.data, "pending_vlans buckets=1 terminals=2000") ||
+        !strstr(capture.data, "pending vlan=120 entries=2000 total=2000")) {
+        fprintf(stderr, "expected all terminals pending after the prefix went away:\n%s",
+                capture.data ? capture.data : "<empty>");
+        ok = false;
+        goto cleanup;
+    }
+
+    debug_capture_reset(&capture);
+    td_debug_context_reset(&ctx, NULL);
+    rc = td_debug_dump_iface_binding_table(mgr, NULL, debug_capture_writer, &capture, &ctx);
+    if (rc != 0 || (capture.data && strstr(capture.data, "binding kernel_ifindex="))) {
+        fprintf(stderr, "iface record kept bindings after the prefix went away\n");
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Interface back up: the pending bucket drains into the binding list. */
+    apply_address_update(mgr, tx_kernel_ifindex, "10.120.0.1", 16, true);
+
+    debug_capture_reset(&capture);
+    td_debug_context_reset(&ctx, NULL);
+    rc = td_debug_dump_pending_vlan_table(mgr, NULL, debug_capture_writer, &capture, &ctx);
+    if (rc != 0 || !capture.data || !strstr(capture.data, "pending_vlans buckets=0 terminals=0")) {
+        fprintf(stderr, "pending bucket not drained after the prefix returned:\n%s",
+                capture.data ? capture.data : "<empty>");
+        ok = false;
+        goto cleanup;
+    }
+
+    debug_capture_reset(&capture);
+    td_debug_context_reset(&ctx, NULL);
+    rc = td_debug_dump_iface_binding_table(mgr, NULL, debug_capture_writer, &capture, &ctx);
+    if (rc != 0 || !capture.data || !strstr(capture.data, "terminals=2000 ")) {
+        fprintf(stderr, "terminals not rebound after the prefix returned:\n%s",
+                capture.data ? capture.data : "<empty>");
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    debug_capture_free(&capture);
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_packet_batch_merges_lookups(void) {
+    const int vlan_id = 140;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 5;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 8;
+
+    struct event_capture events;
+    capture_reset(&events);
+
+    mock_locator_reset();
+    g_mock_locator.version = 12;
+    mock_locator_set_lookup_by_vid(TD_ADAPTER_ERR_NOT_FOUND, 0);
+    mock_locator_set_lookup(TD_ADAPTER_OK, 55);
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            &g_mock_adapter_ops,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for batch test\n");
+        return false;
+    }
+
+    terminal_manager_set_event_sink(mgr, capture_callback, &events);
+
+    const uint8_t mac_a[ETH_ALEN] = {0x00, 0x31, 0x32, 0x33, 0x34, 0x35};
+    const uint8_t mac_b[ETH_ALEN] = {0x00, 0x41, 0x42, 0x43, 0x44, 0x45};
+    struct ether_arp arps[4];
+    struct td_adapter_packet_view packets[4];
+    build_arp_packet(&packets[0], &arps[0], mac_a, "198.51.100.90", "198.51.100.1", vlan_id, 0);
+    build_arp_packet(&packets[1], &arps[1], mac_b, "198.51.100.91", "198.51.100.1", vlan_id, 0);
+    build_arp_packet(&packets[2], &arps[2], mac_a, "198.51.100.90", "198.51.100.1", vlan_id, 0);
+    build_arp_packet(&packets[3], &arps[3], mac_b, NULL, NULL, vlan_id, 0);
+
+    terminal_manager_on_packet_batch(mgr, packets, 4);
+    terminal_manager_flush_events(mgr);
+
+    bool ok = true;
+
+    if (g_mock_locator.lookup_calls != 2) {
+        fprintf(stderr, "expected one merged lookup per terminal, got %zu\n", g_mock_locator.lookup_calls);
+        ok = false;
+    }
+
+    size_t adds = 0;
+    size_t mods = 0;
+    for (size_t i = 0; i < events.count; ++i) {
+        if (events.records[i].tag == TERMINAL_EVENT_TAG_ADD) {
+            adds += 1;
+        } else if (events.records[i].tag == TERMINAL_EVENT_TAG_MOD && events.records[i].ifindex == 55U) {
+            mods += 1;
+        }
+    }
+    if (events.count != 4 || adds != 2 || mods != 2) {
+        fprintf(stderr, "expected 2 ADD + 2 MOD events, got count=%zu add=%zu mod=%zu\n",
+                events.count,
+                adds,
+                mods);
+        ok = false;
+    }
+
+    struct terminal_manager_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    terminal_manager_get_stats(mgr, &stats);
+    if (stats.terminals_discovered != 2 || stats.current_terminals != 2) {
+        fprintf(stderr, "unexpected batch stats: discovered=%" PRIu64 " current=%" PRIu64 "\n",
+                stats.terminals_discovered,
+                stats.current_terminals);
+        ok = false;
+    }
+
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+struct timer_scan_ctx {
+    struct terminal_manager *mgr;
+    size_t rounds;
+};
+
+static void *timer_scan_thread(void *arg) {
+    struct timer_scan_ctx *ctx = (struct timer_scan_ctx *)arg;
+    for (size_t i = 0; i < ctx->rounds; ++i) {
+        terminal_manager_on_timer(ctx->mgr);
+    }
+    return NULL;
+}
+
+static bool count_query_callback(const terminal_event_record_t *record, void *user_ctx) {
+    (void)record;
+    size_t *count = (size_t *)user_ctx;
+    *count += 1U;
+    return true;
+}
+
+static bool test_sharded_ingest_during_timer_scan(void) {
+    const size_t terminal_total = 1024;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 120;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 1800;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = terminal_total;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for shard test\n");
+        return false;
+    }
+
+    struct timer_scan_ctx scan_ctx = {
+        .mgr = mgr,
+        .rounds = 200,
+    };
+    pthread_t scanner;
+    if (pthread_create(&scanner, NULL, timer_scan_thread, &scan_ctx) != 0) {
+        fprintf(stderr, "failed to start timer scan thread\n");
+        terminal_manager_destroy(mgr);
+        return false;
+    }
+
+    for (size_t i = 0; i < terminal_total; ++i) {
+        uint8_t mac[ETH_ALEN] = {0x02, 0x5a, 0x00, 0x00, (uint8_t)(i >> 8), (uint8_t)i};
+        char ip_buf[INET_ADDRSTRLEN];
+        snprintf(ip_buf, sizeof(ip_buf), "10.%u.%u.1", (unsigned int)(i >> 8), (unsigned int)(i & 0xFFU));
+        struct ether_arp arp;
+        struct td_adapter_packet_view packet;
+        build_arp_packet(&packet, &arp, mac, ip_buf, "10.255.255.254", 150, 0);
+        terminal_manager_on_packet(mgr, &packet);
+    }
+
+    pthread_join(scanner, NULL);
+    terminal_manager_on_timer(mgr);
+
+    bool ok = true;
+    struct terminal_manager_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    terminal_manager_get_stats(mgr, &stats);
+    if (stats.terminals_discovered != terminal_total ||
+        stats.current_terminals != terminal_total ||
+        stats.capacity_drops != 0) {
+        fprintf(stderr, "unexpected shard stats: discovered=%" PRIu64 " current=%" PRIu64 " drops=%" PRIu64 "\n",
+                stats.terminals_discovered,
+                stats.current_terminals,
+                stats.capacity_drops);
+        ok = false;
+    }
+
+    size_t queried = 0;
+    if (terminal_manager_query_all(mgr, count_query_callback, &queried) != 0 || queried != terminal_total) {
+        fprintf(stderr, "query_all returned %zu terminals, expected %zu\n", queried, terminal_total);
+        ok = false;
+    }
+
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static void ingest_numbered_terminal(struct terminal_manager *mgr, size_t i) {
+    uint8_t mac[ETH_ALEN] = {0x02, 0x6b, 0x00, 0x00, (uint8_t)(i >> 8), (uint8_t)i};
+    char ip_buf[INET_ADDRSTRLEN];
+    snprintf(ip_buf, sizeof(ip_buf), "10.%u.%u.2", (unsigned int)(i >> 8), (unsigned int)(i & 0xFFU));
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    build_arp_packet(&packet, &arp, mac, ip_buf, "10.255.255.254", 160, 0);
+    terminal_manager_on_packet(mgr, &packet);
+}
+
+struct page_walk_ctx {
+    struct terminal_key last;
+    bool have_last;
+    size_t seen;
+    size_t stop_after; /* 0 = never stop early */
+    bool out_of_order;
+};
+
+static bool page_walk_callback(const terminal_event_record_t *record, void *user_ctx) {
+    struct page_walk_ctx *ctx = (struct page_walk_ctx *)user_ctx;
+    if (ctx->have_last) {
+        int rc = memcmp(ctx->last.mac, record->key.mac, ETH_ALEN);
+        if (rc > 0 || (rc == 0 && ntohl(ctx->last.ip.s_addr) >= ntohl(record->key.ip.s_addr))) {
+            ctx->out_of_order = true;
+        }
+    }
+    ctx->last = record->key;
+    ctx->have_last = true;
+    ctx->seen += 1U;
+    return ctx->stop_after == 0U || ctx->seen % ctx->stop_after != 0U;
+}
+
+static bool test_query_filtered_paged_walk(void) {
+    const size_t terminal_total = 300;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 120;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 1800;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = terminal_total;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for paged walk test\n");
+        return false;
+    }
+
+    /* Inserted in reverse so the table order is not the key order. */
+    for (size_t i = terminal_total; i > 0; --i) {
+        ingest_numbered_terminal(mgr, i - 1U);
+    }
+
+    bool ok = true;
+    struct page_walk_ctx walk;
+    memset(&walk, 0, sizeof(walk));
+    terminal_query_page_t page;
+    memset(&page, 0, sizeof(page));
+    page.limit = 7;
+    size_t pages = 0;
+    do {
+        size_t before = walk.seen;
+        if (terminal_manager_query_filtered(mgr, NULL, &page, page_walk_callback, &walk) != 0 ||
+            page.total != terminal_total || walk.seen - before > page.limit) {
+            fprintf(stderr, "paged walk page %zu: delivered %zu total=%zu\n",
+                    pages, walk.seen - before, page.total);
+            ok = false;
+            goto cleanup;
+        }
+        pages += 1U;
+    } while (page.more && pages <= terminal_total);
+    if (walk.seen != terminal_total || walk.out_of_order || pages != (terminal_total + 6U) / 7U) {
+        fprintf(stderr, "paged walk saw %zu terminals over %zu pages (out of order=%d)\n",
+                walk.seen, pages, walk.out_of_order ? 1 : 0);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* A callback that stops early leaves more set and the cursor on the
+     * last record it accepted. */
+    memset(&walk, 0, sizeof(walk));
+    walk.stop_after = 3;
+    memset(&page, 0, sizeof(page));
+    page.limit = 10;
+    if (terminal_manager_query_filtered(mgr, NULL, &page, page_walk_callback, &walk) != 0 ||
+        walk.seen != 3U || !page.more ||
+        memcmp(page.cursor.mac, walk.last.mac, ETH_ALEN) != 0 ||
+        page.cursor.ip.s_addr != walk.last.ip.s_addr) {
+        fprintf(stderr, "early stop delivered %zu records, more=%d\n", walk.seen, page.more ? 1 : 0);
+        ok = false;
+        goto cleanup;
+    }
+
+cleanup:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_table_growth_and_expiry(void) {
+    const size_t terminal_total = 3000;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 120;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 1;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = terminal_total;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for growth test\n");
+        return false;
+    }
+
+    /* Revisit earlier keys while shard tables are growing so lookups hit
+     * entries that have not been migrated yet. */
+    for (size_t i = 0; i < terminal_total; ++i) {
+        ingest_numbered_terminal(mgr, i);
+        ingest_numbered_terminal(mgr, i / 2U);
+    }
+
+    bool ok = true;
+    struct terminal_manager_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    terminal_manager_get_stats(mgr, &stats);
+    if (stats.terminals_discovered != terminal_total || stats.current_terminals != terminal_total) {
+        fprintf(stderr, "unexpected growth stats: discovered=%" PRIu64 " current=%" PRIu64 "\n",
+                stats.terminals_discovered,
+                stats.current_terminals);
+        ok = false;
+        goto done;
+    }
+
+    size_t queried = 0;
+    if (terminal_manager_query_all(mgr, count_query_callback, &queried) != 0 || queried != terminal_total) {
+        fprintf(stderr, "query_all returned %zu terminals after growth, expected %zu\n", queried, terminal_total);
+        ok = false;
+        goto done;
+    }
+
+    /* Every terminal is IFACE_INVALID without an address, so one scan past
+     * the holdoff removes all of them. */
+    sleep_ms(1100);
+    terminal_manager_on_timer(mgr);
+
+    memset(&stats, 0, sizeof(stats));
+    terminal_manager_get_stats(mgr, &stats);
+    if (stats.terminals_removed != terminal_total || stats.current_terminals != 0) {
+        fprintf(stderr, "unexpected expiry stats: removed=%" PRIu64 " current=%" PRIu64 "\n",
+                stats.terminals_removed,
+                stats.current_terminals);
+        ok = false;
+        goto done;
+    }
+
+    for (size_t i = 0; i < 64; ++i) {
+        ingest_numbered_terminal(mgr, i);
+    }
+    queried = 0;
+    if (terminal_manager_query_all(mgr, count_query_callback, &queried) != 0 || queried != 64U) {
+        fprintf(stderr, "query_all returned %zu terminals after re-adding, expected 64\n", queried);
+        ok = false;
+        goto done;
+    }
+
+done:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_table_remove_during_migration(void) {
+    /* Totals that leave some shard part way through draining its old slot
+     * array after the last insert, so the expired entries are removed while
+     * old_slots still covers them and the re-adds probe it afterwards. */
+    static const size_t totals[] = {1100, 2200, 3000, 3900};
+    const size_t manager_count = sizeof(totals) / sizeof(totals[0]);
+    struct terminal_manager *mgrs[sizeof(totals) / sizeof(totals[0])];
+    memset(mgrs, 0, sizeof(mgrs));
+
+    bool ok = true;
+    for (size_t m = 0; m < manager_count; ++m) {
+        struct terminal_manager_config cfg;
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.keepalive_interval_sec = 120;
+        cfg.keepalive_miss_threshold = 3;
+        cfg.iface_invalid_holdoff_sec = 1;
+        cfg.scan_interval_ms = 60000;
+        cfg.vlan_iface_format = "vlan%u";
+        cfg.max_terminals = totals[m];
+        mgrs[m] = terminal_manager_create(&cfg, &g_stub_adapter, NULL, NULL, NULL);
+        if (!mgrs[m]) {
+            fprintf(stderr, "failed to create terminal manager %zu for migration test\n", m);
+            ok = false;
+            goto done;
+        }
+        for (size_t i = 0; i < totals[m]; ++i) {
+            ingest_numbered_terminal(mgrs[m], i);
+        }
+    }
+
+    sleep_ms(1100);
+    for (size_t m = 0; m < manager_count; ++m) {
+        terminal_manager_on_timer(mgrs[m]);
+        for (size_t i = 0; i < totals[m]; ++i) {
+            ingest_numbered_terminal(mgrs[m], i);
+        }
+
+        struct terminal_manager_stats stats;
+        memset(&stats, 0, sizeof(stats));
+        terminal_manager_get_stats(mgrs[m], &stats);
+        if (stats.terminals_removed != totals[m] || stats.current_terminals != totals[m] ||
+            stats.terminals_discovered != 2U * totals[m]) {
+            fprintf(stderr, "migration test %zu: removed=%" PRIu64 " current=%" PRIu64
+                    " discovered=%" PRIu64 "\n",
+                    totals[m],
+                    stats.terminals_removed,
+                    stats.current_terminals,
+                    stats.terminals_discovered);
+            ok = false;
+        }
+    }
+
+done:
+    for (size_t m = 0; m < manager_count; ++m) {
+        if (mgrs[m]) {
+            terminal_manager_destroy(mgrs[m]);
+        }
+    }
+    return ok;
+}
+
+static void dispatch_counter_callback(const terminal_event_record_t *records,
+                                      size_t count,
+                                      void *user_ctx) {
+    (void)records;
+    size_t *total = (size_t *)user_ctx;
+    *total += count;
+}
+
+static bool test_pool_stats_track_occupancy(void) {
+    const size_t terminal_total = 200;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 120;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 1;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = terminal_total;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for pool test\n");
+        return false;
+    }
+
+    size_t dispatched = 0;
+    terminal_manager_set_event_sink(mgr, dispatch_counter_callback, &dispatched);
+
+    for (size_t i = 0; i < terminal_total; ++i) {
+        ingest_numbered_terminal(mgr, i);
+    }
+    terminal_manager_flush_events(mgr);
+
+    bool ok = true;
+    struct terminal_manager_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    terminal_manager_get_stats(mgr, &stats);
+    if (stats.entry_pool.in_use != terminal_total ||
+        stats.entry_pool.capacity < terminal_total ||
+        stats.entry_pool.slabs == 0) {
+        fprintf(stderr, "unexpected entry pool stats: in_use=%" PRIu64 " capacity=%" PRIu64 " slabs=%" PRIu64 "\n",
+                stats.entry_pool.in_use,
+                stats.entry_pool.capacity,
+                stats.entry_pool.slabs);
+        ok = false;
+        goto done;
+    }
+    if (dispatched != terminal_total || stats.event_ring_depth != 0 || stats.event_ring_high_water == 0) {
+        fprintf(stderr, "unexpected event ring stats: dispatched=%zu depth=%" PRIu64 " high_water=%" PRIu64 "\n",
+                dispatched,
+                stats.event_ring_depth,
+                stats.event_ring_high_water);
+        ok = false;
+        goto done;
+    }
+
+    uint64_t entry_capacity = stats.entry_pool.capacity;
+    sleep_ms(1100);
+    terminal_manager_on_timer(mgr);
+    terminal_manager_flush_events(mgr);
+
+    memset(&stats, 0, sizeof(stats));
+    terminal_manager_get_stats(mgr, &stats);
+    if (stats.entry_pool.in_use != 0 ||
+        stats.entry_pool.capacity != entry_capacity ||
+        stats.entry_pool.peak_in_use != terminal_total ||
+        stats.probe_task_pool.in_use != 0 ||
+        stats.lookup_task_pool.in_use != 0) {
+        fprintf(stderr, "pool stats after expiry: entry in_use=%" PRIu64 " capacity=%" PRIu64 " peak=%" PRIu64 "\n",
+                stats.entry_pool.in_use,
+                stats.entry_pool.capacity,
+                stats.entry_pool.peak_in_use);
+        ok = false;
+        goto done;
+    }
+
+    /* Recycled entries come back from the freelist without growing the pool. */
+    for (size_t i = 0; i < terminal_total; ++i) {
+        ingest_numbered_terminal(mgr, i);
+    }
+    memset(&stats, 0, sizeof(stats));
+    terminal_manager_get_stats(mgr, &stats);
+    if (stats.entry_pool.in_use != terminal_total || stats.entry_pool.capacity != entry_capacity) {
+        fprintf(stderr, "pool grew on reuse: in_use=%" PRIu64 " capacity=%" PRIu64 "\n",
+                stats.entry_pool.in_use,
+                stats.entry_pool.capacity);
+        ok = false;
+        goto done;
+    }
+
+done:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+struct gated_sink {
+    bool hold;    /* atomic; the sink parks while set */
+    bool entered; /* atomic; first batch reached the sink */
+    size_t delivered;
+};
+
+static void gated_sink_callback(const terminal_event_record_t *records,
+                                size_t count,
+                                void *user_ctx) {
+    (void)records;
+    struct gated_sink *gate = (struct gated_sink *)user_ctx;
+    __atomic_store_n(&gate->entered, true, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&gate->hold, __ATOMIC_SEQ_CST)) {
+        sleep_ms(1);
+    }
+    gate->delivered += count;
+}
+
+/* Parks the dispatcher inside the sink, then overruns a four-record ring. */
+static bool run_event_overflow(terminal_event_overflow_policy_t policy,
+                               size_t *delivered,
+                               struct terminal_manager_stats *stats) {
+    const size_t burst = 10;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 120;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 1;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 64;
+    cfg.event_ring_size = 4;
+    cfg.event_overflow_policy = policy;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for overflow test\n");
+        return false;
+    }
+
+    struct gated_sink gate = {true, false, 0};
+    terminal_manager_set_event_sink(mgr, gated_sink_callback, &gate);
+
+    ingest_numbered_terminal(mgr, 0);
+    for (int i = 0; i < 2000 && !__atomic_load_n(&gate.entered, __ATOMIC_SEQ_CST); ++i) {
+        sleep_ms(1);
+    }
+    bool ok = __atomic_load_n(&gate.entered, __ATOMIC_SEQ_CST);
+    if (!ok) {
+        fprintf(stderr, "dispatcher never reached the sink\n");
+    }
+
+    for (size_t i = 1; i <= burst; ++i) {
+        ingest_numbered_terminal(mgr, i);
+    }
+
+    __atomic_store_n(&gate.hold, false, __ATOMIC_SEQ_CST);
+    terminal_manager_flush_events(mgr);
+    memset(stats, 0, sizeof(*stats));
+    terminal_manager_get_stats(mgr, stats);
+    *delivered = gate.delivered;
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_mac_lookup_batch_groups_by_shard(void) {
+    const int vlan_id = 171;
+    const size_t terminals = 100;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 120;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 1800;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 256;
+
+    mock_locator_reset();
+    mock_locator_set_lookup_by_vid(TD_ADAPTER_OK, 40);
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            &g_mock_delta_adapter_ops,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for sharded lookup batch test\n");
+        return false;
+    }
+    size_t dispatched = 0;
+    terminal_manager_set_event_sink(mgr, dispatch_counter_callback, &dispatched);
+
+    for (size_t i = 0; i < terminals; ++i) {
+        struct ether_arp arp;
+        struct td_adapter_packet_view packet;
+        uint8_t mac[ETH_ALEN] = {0x00, 0x58, 0x00, 0x00, 0x00, (uint8_t)(i + 1U)};
+        char ip[32];
+        snprintf(ip, sizeof(ip), "192.0.3.%zu", i + 1U);
+        build_arp_packet(&packet, &arp, mac, ip, ip, vlan_id, 0);
+        terminal_manager_on_packet(mgr, &packet);
+    }
+    terminal_manager_flush_events(mgr);
+
+    /* Two full reverifies: the first grows the manager's scratch arrays past
+     * the stack batch, the second reuses them. */
+    bool ok = true;
+    for (uint32_t round = 0; round < 2U && ok; ++round) {
+        dispatched = 0;
+        mock_locator_clear_counters();
+        mock_locator_set_lookup(TD_ADAPTER_OK, 41U + round);
+        mock_locator_publish(2U + round, 0, NULL, 0);
+        terminal_manager_flush_events(mgr);
+
+        if (g_mock_locator.lookup_batch_calls != 1 || g_mock_locator.lookup_calls != terminals) {
+            fprintf(stderr, "round %u: expected one batch of %zu lookups, got %zu batches %zu lookups\n",
+                    round,
+                    terminals,
+                    g_mock_locator.lookup_batch_calls,
+                    g_mock_locator.lookup_calls);
+            ok = false;
+        }
+        if (dispatched != terminals) {
+            fprintf(stderr, "round %u: expected %zu MOD events, got %zu\n", round, terminals, dispatched);
+            ok = false;
+        }
+    }
+
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+struct ignored_vlan_toggle_ctx {
+    struct terminal_manager *mgr;
+    uint16_t vlan_id;
+    bool stop; /* atomic */
+};
+
+static void *ignored_vlan_toggle_thread(void *arg) {
+    struct ignored_vlan_toggle_ctx *ctx = (struct ignored_vlan_toggle_ctx *)arg;
+    while (!__atomic_load_n(&ctx->stop, __ATOMIC_ACQUIRE)) {
+        terminal_manager_add_ignored_vlan(ctx->mgr, ctx->vlan_id);
+        terminal_manager_remove_ignored_vlan(ctx->mgr, ctx->vlan_id);
+    }
+    return NULL;
+}
+
+static bool test_packet_batch_groups_by_shard(void) {
+    const int vlan_id = 210;
+    const int ignored_vlan_id = 211;
+    const size_t terminal_total = 150;
+    const size_t ignored_total = 30;
+    const int tx_kernel_ifindex = mock_kernel_ifindex_for_vlan(vlan_id);
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 120;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 1800;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 256;
+    cfg.ignored_vlan_count = 1;
+    cfg.ignored_vlans[0] = (uint16_t)ignored_vlan_id;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for shard batch test\n");
+        return false;
+    }
+
+    size_t dispatched = 0;
+    terminal_manager_set_event_sink(mgr, dispatch_counter_callback, &dispatched);
+    apply_address_update(mgr, tx_kernel_ifindex, "10.21.0.1", 24, true);
+
+    /* Spans several chunks and every shard, with ignored-VLAN packets mixed
+     * in and each terminal seen twice so later packets hit the fast path. */
+    enum { BATCH_TOTAL = 2 * 150 + 30 };
+    struct ether_arp arps[BATCH_TOTAL];
+    struct td_adapter_packet_view packets[BATCH_TOTAL];
+    size_t n = 0;
+    for (size_t round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < terminal_total; ++i) {
+            uint8_t mac[ETH_ALEN] = {0x02, 0x7c, 0x00, 0x00, 0x00, (uint8_t)i};
+            char ip_buf[INET_ADDRSTRLEN];
+            snprintf(ip_buf, sizeof(ip_buf), "10.21.0.%u", (unsigned int)(i + 10U));
+            build_arp_packet(&packets[n], &arps[n], mac, ip_buf, "10.21.0.1", vlan_id, 5);
+            n += 1U;
+            if (round == 0 && i % 5U == 0U) {
+                uint8_t ignored_mac[ETH_ALEN] = {0x02, 0x7d, 0x00, 0x00, 0x00, (uint8_t)i};
+                build_arp_packet(&packets[n], &arps[n], ignored_mac, ip_buf, "10.21.0.1", ignored_vlan_id, 5);
+                n += 1U;
+            }
+        }
+    }
+
+    bool ok = true;
+    if (n != BATCH_TOTAL || ignored_total != BATCH_TOTAL - 2U * terminal_total) {
+        fprintf(stderr, "shard batch test built %zu packets\n", n);
+        ok = false;
+        goto cleanup;
+    }
+
+    terminal_manager_on_packet_batch(mgr, packets, n);
+    terminal_manager_flush_events(mgr);
+
+    struct terminal_manager_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    terminal_manager_get_stats(mgr, &stats);
+    if (stats.terminals_discovered != terminal_total || stats.current_terminals != terminal_total) {
+        fprintf(stderr, "unexpected shard batch stats: discovered=%" PRIu64 " current=%" PRIu64 "\n",
+                stats.terminals_discovered,
+                stats.current_terminals);
+        ok = false;
+        goto cleanup;
+    }
+    if (dispatched != terminal_total) {
+        fprintf(stderr, "expected %zu ADD events, got %zu\n", terminal_total, dispatched);
+        ok = false;
+        goto cleanup;
+    }
+
+    /* Known terminals refresh under their shard lock alone, while another
+     * thread rewrites the ignored VLAN set. */
+    struct ignored_vlan_toggle_ctx toggle_ctx = {
+        .mgr = mgr,
+        .vlan_id = (uint16_t)(ignored_vlan_id + 1),
+        .stop = false,
+    };
+    pthread_t toggler;
+    if (pthread_create(&toggler, NULL, ignored_vlan_toggle_thread, &toggle_ctx) != 0) {
+        fprintf(stderr, "failed to start ignored vlan toggle thread\n");
+        ok = false;
+        goto cleanup;
+    }
+    unsigned int calls_before = g_if_nametoindex_calls;
+    for (int pass = 0; pass < 20; ++pass) {
+        terminal_manager_on_packet_batch(mgr, packets, n);
+    }
+    __atomic_store_n(&toggle_ctx.stop, true, __ATOMIC_RELEASE);
+    pthread_join(toggler, NULL);
+    terminal_manager_flush_events(mgr);
+
+    if (g_if_nametoindex_calls != calls_before) {
+        fprintf(stderr, "known terminals re-resolved %u times in batch\n",
+                g_if_nametoindex_calls - calls_before);
+        ok = false;
+    }
+    if (dispatched != terminal_total) {
+        fprintf(stderr, "refresh batches emitted %zu extra events\n", dispatched - terminal_total);
+        ok = false;
+    }
+
+cleanup:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+static bool test_event_ring_overflow_policies(void) {
+    size_t delivered = 0;
+    struct terminal_manager_stats stats;
+
+    if (!run_event_overflow(TERMINAL_EVENT_OVERFLOW_DROP_OLDEST, &delivered, &stats)) {
+        return false;
+    }
+    if (stats.event_ring_capacity != 4 || stats.event_ring_high_water != 4 ||
+        stats.event_ring_drops != 6 || delivered != 5) {
+        fprintf(stderr, "drop-oldest: capacity=%" PRIu64 " high_water=%" PRIu64 " drops=%" PRIu64 " delivered=%zu\n",
+                stats.event_ring_capacity,
+                stats.event_ring_high_water,
+                stats.event_ring_drops,
+                delivered);
+        return false;
+    }
+
+    if (!run_event_overflow(TERMINAL_EVENT_OVERFLOW_COALESCE, &delivered, &stats)) {
+        return false;
+    }
+    if (stats.event_ring_drops != 0 || delivered != 11 || stats.events_dispatched != 11) {
+        fprintf(stderr, "coalesce: drops=%" PRIu64 " delivered=%zu dispatched=%" PRIu64 "\n",
+                stats.event_ring_drops,
+                delivered,
+                stats.events_dispatched);
+        return false;
+    }
+
+    if (!run_event_overflow(TERMINAL_EVENT_OVERFLOW_BACKPRESSURE, &delivered, &stats)) {
+        return false;
+    }
+    /* The wedged sink costs one bounded wait, not one per event, and the
+     * records that did not fit are spilled rather than dropped. */
+    if (stats.event_ring_backpressure_waits != 1 || stats.event_ring_drops != 0 || delivered != 11) {
+        fprintf(stderr, "backpressure: waits=%" PRIu64 " drops=%" PRIu64 " delivered=%zu\n",
+                stats.event_ring_backpressure_waits,
+                stats.event_ring_drops,
+                delivered);
+        return false;
+    }
+
+    return true;
+}
+
+static terminal_event_record_t make_event(uint8_t id,
+                                          terminal_event_tag_t tag,
+                                          uint32_t prev_ifindex,
+                                          uint32_t ifindex) {
+    terminal_event_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.key.mac[0] = 0x02;
+    record.key.mac[5] = id;
+    record.key.ip.s_addr = htonl(0x0a000000U | id);
+    record.tag = tag;
+    record.prev_ifindex = prev_ifindex;
+    record.ifindex = ifindex;
+    return record;
+}
+
+static bool test_event_coalescer_net_effect(void) {
+    const terminal_event_record_t input[] = {
+        make_event(1, TERMINAL_EVENT_TAG_ADD, 0, 1),
+        make_event(2, TERMINAL_EVENT_TAG_ADD, 0, 1),
+        make_event(3, TERMINAL_EVENT_TAG_MOD, 1, 2),
+        make_event(1, TERMINAL_EVENT_TAG_MOD, 1, 2),
+        make_event(4, TERMINAL_EVENT_TAG_DEL, 0, 4),
+        make_event(2, TERMINAL_EVENT_TAG_DEL, 0, 1),
+        make_event(5, TERMINAL_EVENT_TAG_MOD, 1, 2),
+        make_event(3, TERMINAL_EVENT_TAG_MOD, 2, 5),
+        make_event(1, TERMINAL_EVENT_TAG_MOD, 2, 3),
+        make_event(4, TERMINAL_EVENT_TAG_ADD, 0, 6),
+        make_event(5, TERMINAL_EVENT_TAG_MOD, 2, 1),
+    };
+    /* 1: ADD chain keeps the last port; 2: ADD+DEL cancels; 3: MOD chain keeps
+     * the first prev; 4: DEL+ADD on a new port is a move; 5: moved back. */
+    const terminal_event_record_t expected[] = {
+        make_event(1, TERMINAL_EVENT_TAG_ADD, 0, 3),
+        make_event(3, TERMINAL_EVENT_TAG_MOD, 1, 5),
+        make_event(4, TERMINAL_EVENT_TAG_MOD, 4, 6),
+    };
+
+    struct terminal_event_coalescer coalescer;
+    terminal_event_coalescer_init(&coalescer);
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(input) / sizeof(input[0]); ++i) {
+        if (terminal_event_coalescer_add(&coalescer, &input[i], NULL) != 0) {
+            fprintf(stderr, "coalescer add failed at %zu\n", i);
+            ok = false;
+            goto done;
+        }
+    }
+
+    size_t count = terminal_event_coalescer_compact(&coalescer);
+    if (count != sizeof(expected) / sizeof(expected[0])) {
+        fprintf(stderr, "expected %zu coalesced records, got %zu\n",
+                sizeof(expected) / sizeof(expected[0]), count);
+        ok = false;
+        goto done;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const terminal_event_record_t *got = &coalescer.records[i];
+        if (memcmp(&got->key, &expected[i].key, sizeof(got->key)) != 0 ||
+            got->tag != expected[i].tag ||
+            got->prev_ifindex != expected[i].prev_ifindex ||
+            got->ifindex != expected[i].ifindex) {
+            fprintf(stderr, "record %zu: tag=%d prev=%u ifindex=%u\n",
+                    i, (int)got->tag, got->prev_ifindex, got->ifindex);
+            ok = false;
+            goto done;
+        }
+    }
+
+    terminal_event_coalescer_reset(&coalescer);
+    if (terminal_event_coalescer_add(&coalescer, &input[1], NULL) != 0 ||
+        terminal_event_coalescer_compact(&coalescer) != 1 ||
+        coalescer.records[0].tag != TERMINAL_EVENT_TAG_ADD) {
+        fprintf(stderr, "coalescer did not start clean after reset\n");
+        ok = false;
+    }
+
+done:
+    terminal_event_coalescer_destroy(&coalescer);
+    return ok;
+}
+
+static bool test_event_window_coalesces_churn(void) {
+    const int vlan_id = 400;
+    struct terminal_manager_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.keepalive_interval_sec = 120;
+    cfg.keepalive_miss_threshold = 3;
+    cfg.iface_invalid_holdoff_sec = 30;
+    cfg.scan_interval_ms = 60000;
+    cfg.vlan_iface_format = "vlan%u";
+    cfg.max_terminals = 16;
+    cfg.event_window_ms = 500;
+
+    struct terminal_manager *mgr = terminal_manager_create(&cfg,
+                                                            &g_stub_adapter,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL);
+    if (!mgr) {
+        fprintf(stderr, "failed to create terminal manager for window test\n");
+        return false;
+    }
+
+    struct event_capture events;
+    capture_reset(&events);
+    terminal_manager_set_event_sink(mgr, capture_callback, &events);
+
+    struct ether_arp arp;
+    struct td_adapter_packet_view packet;
+    const uint8_t settled_mac[ETH_ALEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x21};
+    const uint8_t flapping_mac[ETH_ALEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x22};
+
+    build_arp_packet(&packet, &arp, settled_mac, "10.10.10.21", "10.10.10.21", vlan_id, 1);
+    terminal_manager_on_packet(mgr, &packet);
+    terminal_manager_flush_events(mgr);
+    capture_reset(&events);
+
+    for (uint32_t ifindex = 1; ifindex <= 3; ++ifindex) {
+        build_arp_packet(&packet, &arp, flapping_mac, "10.10.10.22", "10.10.10.22", vlan_id, ifindex);
+        terminal_manager_on_packet(mgr, &packet);
+        build_arp_packet(&packet, &arp, settled_mac, "10.10.10.21", "10.10.10.21", vlan_id, ifindex);
+        terminal_manager_on_packet(mgr, &packet);
+    }
+    terminal_manager_flush_events(mgr);
+
+    bool ok = true;
+    if (events.count != 2 ||
+        events.records[0].tag != TERMINAL_EVENT_TAG_ADD ||
+        events.records[0].ifindex != 3U ||
+        events.records[1].tag != TERMINAL_EVENT_TAG_MOD ||
+        events.records[1].prev_ifindex != 1U ||
+        events.records[1].ifindex != 3U) {
+        fprintf(stderr, "expected ADD(3) and MOD(1->3), got %zu records\n", events.count);
+        ok = false;
+        goto done;
+    }
+
+    struct terminal_manager_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    terminal_manager_get_stats(mgr, &stats);
+    if (stats.events_coalesced != 3) {
+        fprintf(stderr, "expected 3 coalesced records, got %" PRIu64 "\n", stats.events_coalesced);
+        ok = false;
+    }
+
+done:
+    terminal_manager_destroy(mgr);
+    return ok;
+}
+
+/* success_after doubles as the largest batch seen. */
+static void probe_scheduler_count_send(const terminal_probe_request_t *requests, size_t count, void *ctx) {
+    (void)requests;
+    struct sync_handler_state *state = (struct sync_handler_state *)ctx;
+    pthread_mutex_lock(&state->lock);
+    state->call_count += count;
+    if (count > state->success_after) {
+        state->success_after = count;
+    }
+    pthread_mutex_unlock(&state->lock);
+}
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000U + (uint64_t)ts.tv_nsec / 1000000U;
+}
+
+static bool test_probe_scheduler_paces_bursts(void) {
+    struct sync_handler_state sent;
+    sync_handler_state_init(&sent, 0U);
+
+    terminal_probe_request_t request;
+    memset(&request, 0, sizeof(request));
+
+    bool ok = true;
+    struct terminal_probe_scheduler *scheduler = NULL;
+    struct terminal_probe_scheduler_config cfg = {
+        .interval_ms = 30U,
+        .burst = 2U,
+        .queue_size = 8U,
+    };
+    if (terminal_probe_scheduler_create(&cfg, probe_scheduler_count_send, &sent, &scheduler) != 0) {
+        fprintf(stderr, "failed to create probe scheduler\n");
+        sync_handler_state_destroy(&sent);
+        return false;
+    }
+
+    /* Two probes leave on the banked burst, the other two wait a token each. */
+    uint64_t start_ms = monotonic_ms();
+    for (int i = 0; i < 4; ++i) {
+        if (terminal_probe_scheduler_submit(scheduler, &request) != 0) {
+            fprintf(stderr, "submit %d unexpectedly rejected\n", i);
+            ok = false;
+        }
+    }
+    if (!wait_for_call_count(&sent, 4U, 2000U)) {
+        fprintf(stderr, "expected 4 paced sends, got %zu\n", sync_handler_state_get(&sent));
+        ok = false;
+    }
+    uint64_t elapsed_ms = monotonic_ms() - start_ms;
+    if (elapsed_ms < 50U) {
+        fprintf(stderr, "4 probes at burst 2 / 30ms finished in %" PRIu64 "ms\n", elapsed_ms);
+        ok = false;
+    }
+
+    pthread_mutex_lock(&sent.lock);
+    size_t largest_batch = sent.success_after;
+    pthread_mutex_unlock(&sent.lock);
+    if (largest_batch == 0U || largest_batch > 2U) {
+        fprintf(stderr, "send batches must hold 1..burst probes, saw %zu\n", largest_batch);
+        ok = false;
+    }
+
+    struct terminal_probe_scheduler_stats stats;
+    terminal_probe_scheduler_get_stats(scheduler, &stats);
+    if (stats.enqueued != 4U || stats.sent != 4U || stats.dropped != 0U ||
+        stats.send_batches == 0U || stats.send_batches > 4U ||
+        stats.pacing_waits == 0U || stats.queue_depth != 0U || stats.queue_capacity != 8U) {
+        fprintf(stderr,
+                "unexpected paced stats enqueued=%" PRIu64 " sent=%" PRIu64 " dropped=%" PRIu64
+                " waits=%" PRIu64 " depth=%zu\n",
+                stats.enqueued,
+                stats.sent,
+                stats.dropped,
+                stats.pacing_waits,
+                stats.queue_depth);
+        ok = false;
+    }
+    terminal_probe_scheduler_destroy(scheduler);
+    scheduler = NULL;
+
+    /* A slow token and a tiny queue: the overflow is dropped, not blocked on. */
+    cfg.interval_ms = 10000U;
+    cfg.burst = 1U;
+    cfg.queue_size = 2U;
+    if (terminal_probe_scheduler_create(&cfg, probe_scheduler_count_send, &sent, &scheduler) != 0) {
+        fprintf(stderr, "failed to create overflow probe scheduler\n");
+        sync_handler_state_destroy(&sent);
+        return false;
+    }
+    int rejected = 0;
+    for (int i = 0; i < 5; ++i) {
+        if (terminal_probe_scheduler_submit(scheduler, &request) == -EAGAIN) {
+            rejected += 1;
+        }
+    }
+    terminal_probe_scheduler_get_stats(scheduler, &stats);
+    if (rejected < 2 || stats.dropped != (uint64_t)rejected || stats.enqueued + stats.dropped != 5U ||
+        stats.queue_high_water != 2U) {
+        fprintf(stderr,
+                "unexpected overflow stats rejected=%d dropped=%" PRIu64 " enqueued=%" PRIu64 " high=%zu\n",
+                rejected,
+                stats.dropped,
+                stats.enqueued,
+                stats.queue_high_water);
+        ok = false;
+    }
+
+    terminal_probe_scheduler_stop(scheduler);
+    if (terminal_probe_scheduler_submit(scheduler, &request) != -ESHUTDOWN) {
+        fprintf(stderr, "submit after stop should fail with -ESHUTDOWN\n");
+        ok = false;
+    }
+
+    terminal_probe_scheduler_destroy(scheduler);
+    sync_handler_state_destroy(&sent);
+    return ok;
+}
+
 int main(void) {
     td_log_set_level(TD_LOG_ERROR);
 
@@ -1921,6 +4331,9 @@ int main(void) {
         {"point_lookup_miss_triggers_refresh", test_point_lookup_miss_triggers_refresh},
         {"point_lookup_retries_on_vlan_change", test_point_lookup_retries_on_vlan_change},
         {"mac_refresh_failure_preserves_ifindex", test_mac_refresh_failure_preserves_ifindex},
+        {"mac_delta_reverifies_changed_keys", test_mac_delta_reverifies_changed_keys},
+        {"mac_lookup_batch_single_call", test_mac_lookup_batch_single_call},
+        {"mac_lookup_batch_groups_by_shard", test_mac_lookup_batch_groups_by_shard},
         {"vlan_change_without_ingress_ifindex_retains_previous",
          test_vlan_change_without_ingress_ifindex_retains_previous},
         {"terminal_packet_on_ignored_vlan", test_terminal_packet_on_ignored_vlan},
@@ -1928,10 +4341,31 @@ int main(void) {
         {"gratuitous_arp_uses_target_ip", test_gratuitous_arp_uses_target_ip},
         {"zero_ip_arp_is_ignored", test_zero_ip_arp_is_ignored},
         {"probe_failure_removes_terminal", test_probe_failure_removes_terminal},
+        {"keepalive_change_reschedules_probe", test_keepalive_change_reschedules_probe},
         {"iface_invalid_holdoff", test_iface_invalid_holdoff},
         {"ifindex_change_emits_mod", test_ifindex_change_emits_mod},
         {"address_sync_retry", test_address_sync_retry},
         {"debug_dump_interfaces", test_debug_dump_interfaces},
+        {"vlan_link_cache_avoids_syscalls", test_vlan_link_cache_avoids_syscalls},
+        {"link_resync_skips_deleted_links", test_link_resync_skips_deleted_links},
+        {"known_terminal_fast_path", test_known_terminal_fast_path},
+        {"query_snapshot_versioning", test_query_snapshot_versioning},
+        {"query_since_journal", test_query_since_journal},
+        {"query_filtered_paging", test_query_filtered_paging},
+        {"query_filtered_paged_walk", test_query_filtered_paged_walk},
+        {"lookup_by_mac_and_ip", test_lookup_by_mac_and_ip},
+        {"source_ip_longest_prefix", test_source_ip_longest_prefix},
+        {"mass_iface_down_moves_bindings", test_mass_iface_down_moves_bindings},
+        {"packet_batch_merges_lookups", test_packet_batch_merges_lookups},
+        {"sharded_ingest_during_timer_scan", test_sharded_ingest_during_timer_scan},
+        {"table_growth_and_expiry", test_table_growth_and_expiry},
+        {"table_remove_during_migration", test_table_remove_during_migration},
+        {"pool_stats_track_occupancy", test_pool_stats_track_occupancy},
+        {"packet_batch_groups_by_shard", test_packet_batch_groups_by_shard},
+        {"event_ring_overflow_policies", test_event_ring_overflow_policies},
+        {"event_coalescer_net_effect", test_event_coalescer_net_effect},
+        {"event_window_coalesces_churn", test_event_window_coalesces_churn},
+        {"probe_scheduler_paces_bursts", test_probe_scheduler_paces_bursts},
     };
 
     size_t total = sizeof(tests) / sizeof(tests[0]);